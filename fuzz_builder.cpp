@@ -0,0 +1,1086 @@
+#include "sqlquerybuilder.hpp"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <random>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#ifdef SQLQUERYBUILDER_FUZZ_SQLITE
+#include <sqlite3.h>
+#endif
+
+// Differential fuzzing of the rendering fast paths. Each input decodes to a
+// script of builder calls, replayed on builders of several configs and on a
+// reference renderer: plain std::string concatenation with printf number
+// formatting, written from the SQL the builder documents rather than from
+// its code. Every path has to produce the reference text byte for byte:
+//   build()                 to_chars values, the clause arena, sinks
+//   measure()               the counting pass
+//   buildInto()             appending to a caller's buffer
+//   cacheClauses()          incremental rebuilds, checked after every call
+//   copies                  arena and subquery ownership
+//   compile()               the bind-slot table
+//   compileParameterized()  every literal a slot; bindCount(); spliced back
+//                           with bindValues() through render()
+//   QueryCache::render()    fingerprint(), with one cache across all inputs
+//   buildInterned()         the statement pool
+// With SQLite (SQLQUERYBUILDER_FUZZ_SQLITE) a text that differs from the
+// reference still passes if SQLite compiles both to the same EXPLAIN
+// program, and a parameterized statement must take as many parameters as
+// it has slots.
+//
+// Built with SQLQUERYBUILDER_LIBFUZZER this is a libFuzzer target.
+// Otherwise main() runs random inputs, or replays the files it is given.
+// Both accept -runs=N and -seed=N, and print the throughput of each path
+// on exit.
+
+using namespace sql;
+
+namespace {
+
+// Limits small enough that scripts run into them
+struct TinyConfig {
+    static constexpr size_t MaxColumns = 4;
+    static constexpr size_t MaxConditions = 3;
+    static constexpr size_t MaxJoins = 1;
+    static constexpr size_t MaxOrderBy = 2;
+    static constexpr size_t MaxGroupBy = 2;
+    static constexpr size_t MaxInValues = 4;
+    static constexpr bool ThrowOnError = false;
+};
+
+struct LargeConfig {
+    static constexpr size_t MaxColumns = 100;
+    static constexpr size_t MaxConditions = 50;
+    static constexpr size_t MaxJoins = 10;
+    static constexpr size_t MaxOrderBy = 20;
+    static constexpr size_t MaxGroupBy = 20;
+    static constexpr size_t MaxInValues = 50;
+    static constexpr bool ThrowOnError = false;
+};
+
+struct PostgresConfig : DefaultConfig {
+    using Dialect = PostgresDialect;
+};
+
+//=====================
+// Scripts
+//=====================
+
+// Names the builders keep views of; static, so they outlive every builder
+constexpr std::string_view Columns[] = {"users.id", "users.name", "users.email", "users.age", "users.score"};
+constexpr std::string_view Texts[] = {"alice", "O'Brien", "", "''", "100%", "a_b", "line\nbreak", "\xC3\xBCn\xC3\xAF"};
+constexpr std::string_view Aliases[] = {"t", "recent"};
+constexpr std::string_view Having[] = {"COUNT(*) > 1", "SUM(users.score) < 100"};
+constexpr std::string_view Raw[] = {"users.age > 18", "users.name IS NOT NULL OR users.score = 0"};
+
+struct JoinTarget {
+    std::string_view table;
+    std::string_view on;
+};
+constexpr JoinTarget Joins[] = {{"orders", "orders.user_id = users.id"}, {"teams", "teams.id = users.team_id"}};
+
+using Op = ConditionBase<DefaultConfig>::Op;
+constexpr Op Comparisons[] = {Op::Eq, Op::Ne, Op::Lt, Op::Le, Op::Gt, Op::Ge};
+
+struct Value {
+    enum class Kind : uint8_t { Null, Integer, Real, Boolean, Text };
+
+    Kind kind{Kind::Null};
+    int64_t integer{0};
+    double real{0};
+    bool boolean{false};
+    std::string_view text;
+};
+
+struct Script;
+
+struct Cond {
+    enum class Kind : uint8_t {
+        Compare, IsNull, IsNotNull, Between, Like, NotLike, In, NotIn, RowCompare, Raw,
+        InSubquery, NotInSubquery, Exists,  // Leaves up to here
+        And, Or, Not
+    };
+
+    Kind kind{Kind::Raw};
+    Op op{Op::Eq};
+    std::string_view column;
+    std::string_view second;  // Second column of a row comparison
+    std::vector<Value> values;
+    bool bound{false};  // IN list rendered with InStrategy::Bind
+    std::shared_ptr<const Script> subquery;
+    std::vector<Cond> operands;
+};
+
+struct Step {
+    enum class Kind : uint8_t {
+        Select, Distinct, From, FromDerived, With, Join, JoinOn, Where, ReplaceWhere,
+        GroupBy, Having, OrderBy, Limit, Offset
+    };
+
+    Kind kind{Kind::Select};
+    std::string_view name;
+    std::string_view text;
+    uint8_t join{0};  // Inner, left, right, full
+    bool ascending{true};
+    int32_t number{0};
+    size_t index{0};
+    Cond condition;
+    std::shared_ptr<const Script> subquery;
+};
+
+struct Script {
+    std::vector<Step> steps;
+};
+
+// Reads the fuzzer's bytes, yielding zeros once they run out
+class Input {
+private:
+    std::span<const uint8_t> data_;
+    size_t pos_{0};
+
+public:
+    explicit Input(std::span<const uint8_t> data) : data_(data) {}
+
+    [[nodiscard]] bool done() const { return pos_ >= data_.size(); }
+
+    uint8_t byte() { return done() ? 0 : data_[pos_++]; }
+
+    size_t pick(size_t count) { return byte() % count; }
+
+    template<typename T, size_t N>
+    const T& pick(const T (&items)[N]) { return items[pick(N)]; }
+
+    int64_t integer() {
+        switch (pick(4)) {
+        case 0: return static_cast<int8_t>(byte());
+        case 1: return pick(2) ? std::numeric_limits<int64_t>::min() : std::numeric_limits<int64_t>::max();
+        default: {
+            uint64_t value = 0;
+            for (int i = 0; i < 8; ++i) value = (value << 8) | byte();
+            return static_cast<int64_t>(value);
+        }
+        }
+    }
+};
+
+Value decodeValue(Input& in) {
+    Value value;
+    value.kind = static_cast<Value::Kind>(in.pick(5));
+    switch (value.kind) {
+    case Value::Kind::Integer: value.integer = in.integer(); break;
+    // Eighths below 1000, see formatReal()
+    case Value::Kind::Real: value.real = static_cast<double>(static_cast<int16_t>(in.byte() << 8 | in.byte()) % 8000) / 8; break;
+    case Value::Kind::Boolean: value.boolean = in.pick(2); break;
+    case Value::Kind::Text: value.text = in.pick(Texts); break;
+    case Value::Kind::Null: break;
+    }
+    return value;
+}
+
+std::shared_ptr<const Script> decodeScript(Input& in, int depth);
+
+// `depth` bounds the nesting of compounds and subqueries
+Cond decodeCondition(Input& in, int depth) {
+    constexpr size_t Leaves = static_cast<size_t>(Cond::Kind::Exists) + 1;
+    constexpr size_t Plain = static_cast<size_t>(Cond::Kind::Raw) + 1;
+    const size_t kinds = depth >= 3 ? Plain : depth >= 2 ? Leaves : static_cast<size_t>(Cond::Kind::Not) + 1;
+
+    Cond cond;
+    cond.kind = static_cast<Cond::Kind>(in.pick(kinds));
+    cond.column = in.pick(Columns);
+    switch (cond.kind) {
+    case Cond::Kind::Compare:
+        cond.op = in.pick(Comparisons);
+        cond.values.push_back(decodeValue(in));
+        break;
+    case Cond::Kind::Between:
+        cond.values.push_back(decodeValue(in));
+        cond.values.push_back(decodeValue(in));
+        break;
+    case Cond::Kind::Like:
+    case Cond::Kind::NotLike:
+        cond.values.push_back(Value{Value::Kind::Text, 0, 0, false, in.pick(Texts)});
+        break;
+    case Cond::Kind::In:
+    case Cond::Kind::NotIn:
+        // Bound lists are read from a span of one type; integers here
+        cond.bound = in.pick(2);
+        for (size_t i = 0, count = in.pick(8) + 1; i < count; ++i) {
+            cond.values.push_back(cond.bound ? Value{Value::Kind::Integer, in.integer(), 0, false, {}} : decodeValue(in));
+        }
+        break;
+    case Cond::Kind::RowCompare:
+        cond.op = in.pick(Comparisons);
+        cond.second = in.pick(Columns);
+        cond.values.push_back(decodeValue(in));
+        cond.values.push_back(decodeValue(in));
+        break;
+    case Cond::Kind::Raw:
+        cond.column = in.pick(Raw);
+        break;
+    case Cond::Kind::InSubquery:
+    case Cond::Kind::NotInSubquery:
+    case Cond::Kind::Exists:
+        cond.subquery = decodeScript(in, depth + 1);
+        break;
+    case Cond::Kind::And:
+    case Cond::Kind::Or:
+        cond.operands.push_back(decodeCondition(in, depth + 1));
+        cond.operands.push_back(decodeCondition(in, depth + 1));
+        break;
+    case Cond::Kind::Not:
+        cond.operands.push_back(decodeCondition(in, depth + 1));
+        break;
+    default:
+        break;
+    }
+    return cond;
+}
+
+int32_t decodeCount(Input& in) {
+    switch (in.pick(4)) {
+    case 0: return -1;
+    case 1: return std::numeric_limits<int32_t>::max();
+    default: return in.byte();
+    }
+}
+
+std::shared_ptr<const Script> decodeScript(Input& in, int depth) {
+    constexpr size_t Kinds = static_cast<size_t>(Step::Kind::Offset) + 1;
+
+    // Every script reads from a table unless it goes on to replace it
+    auto script = std::make_shared<Script>();
+    Step from;
+    from.kind = Step::Kind::From;
+    from.name = "users";
+    script->steps.push_back(std::move(from));
+    for (size_t i = 0, count = in.pick(depth > 0 ? 6 : 32) + 1; i < count && !in.done(); ++i) {
+        Step step;
+        step.kind = static_cast<Step::Kind>(in.pick(Kinds));
+        step.name = in.pick(Columns);
+        switch (step.kind) {
+        case Step::Kind::From:
+            step.name = "users";
+            break;
+        case Step::Kind::FromDerived:
+        case Step::Kind::With:
+            if (depth >= 2) {
+                step.kind = Step::Kind::Select;
+                break;
+            }
+            step.name = in.pick(Aliases);
+            step.subquery = decodeScript(in, depth + 1);
+            break;
+        case Step::Kind::Join:
+        case Step::Kind::JoinOn: {
+            const auto& target = in.pick(Joins);
+            step.join = static_cast<uint8_t>(in.pick(4));
+            step.name = target.table;
+            step.text = target.on;
+            if (step.kind == Step::Kind::JoinOn) {
+                step.condition = decodeCondition(in, 2 + (depth > 0));
+            }
+            break;
+        }
+        case Step::Kind::Where:
+            step.condition = decodeCondition(in, depth);
+            break;
+        case Step::Kind::ReplaceWhere:
+            step.index = in.pick(4);
+            step.condition = decodeCondition(in, depth);
+            break;
+        case Step::Kind::Having:
+            step.text = in.pick(Having);
+            break;
+        case Step::Kind::OrderBy:
+            step.ascending = in.pick(2);
+            break;
+        case Step::Kind::Limit:
+        case Step::Kind::Offset:
+            step.number = decodeCount(in);
+            break;
+        default:
+            break;
+        }
+        script->steps.push_back(std::move(step));
+    }
+    return script;
+}
+
+//=====================
+// Reference renderer
+//=====================
+
+enum class Mode : uint8_t {
+    Inline,         // build(): literals inline, InStrategy::Bind lists as markers
+    Parameterized,  // compileParameterized(): every value a marker
+    Spliced         // CompiledQuery::render() with bindValues(): every value inline
+};
+
+// Config::Max* are hard limits only under FixedStorage
+template<typename Config>
+constexpr size_t limitOf(size_t max) {
+    return std::is_same_v<typename config_storage<Config>::type, FixedStorage> ? max : std::numeric_limits<size_t>::max();
+}
+
+// Exact for the eighths that scripts use, which are also where the shortest
+// round-trip form is the fixed one
+std::string formatReal(double value) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.3f", value);
+    std::string text(buffer);
+    text.erase(text.find_last_not_of('0') + 1);
+    if (text.back() == '.') text += '0';
+    return text;
+}
+
+template<typename Config>
+class Reference {
+private:
+    using Dialect = DialectOf<Config>;
+
+    struct Joined {
+        const char* type;
+        std::string_view table;
+        std::string_view on;
+        const Cond* condition;
+    };
+
+    std::vector<std::string_view> columns_;
+    bool distinct_{false};
+    std::string_view table_;
+    std::shared_ptr<const Script> from_;
+    std::vector<std::pair<std::string_view, std::shared_ptr<const Script>>> ctes_;
+    std::vector<Joined> joins_;
+    std::vector<const Cond*> where_;
+    std::vector<std::string_view> group_;
+    std::string_view having_;
+    std::vector<std::pair<std::string_view, bool>> order_;
+    int32_t limit_{-1};
+    int32_t offset_{-1};
+
+    // Output of one rendering, with the markers numbered across the statement
+    struct Output {
+        Mode mode;
+        std::string text;
+        size_t markers{0};
+
+        void marker() {
+            ++markers;
+            if constexpr(Dialect::positional == PlaceholderStyle::Dollar) {
+                text += "$" + std::to_string(markers);
+            } else {
+                text += "?";
+            }
+        }
+
+        void value(const Value& value, bool bound = false) {
+            if (mode == Mode::Parameterized || (bound && mode == Mode::Inline)) {
+                marker();
+                return;
+            }
+            switch (value.kind) {
+            case Value::Kind::Null: text += "NULL"; break;
+            case Value::Kind::Integer: text += std::to_string(value.integer); break;
+            case Value::Kind::Real: text += formatReal(value.real); break;
+            case Value::Kind::Boolean: text += value.boolean ? Dialect::true_value : Dialect::false_value; break;
+            case Value::Kind::Text:
+                text += "'";
+                for (char c : value.text) {
+                    text += c;
+                    if (c == '\'') text += '\'';
+                }
+                text += "'";
+                break;
+            }
+        }
+    };
+
+    static const char* opText(Op op) {
+        switch (op) {
+        case Op::Eq: return "=";
+        case Op::Ne: return "!=";
+        case Op::Lt: return "<";
+        case Op::Le: return "<=";
+        case Op::Gt: return ">";
+        default: return ">=";
+        }
+    }
+
+    // Whether the condition is an OR once its negations cancel out
+    static bool isDisjunction(const Cond& cond) {
+        bool negated = false;
+        const Cond* c = &cond;
+        while (c->kind == Cond::Kind::Not) {
+            negated = !negated;
+            c = &c->operands[0];
+        }
+        return !negated && c->kind == Cond::Kind::Or;
+    }
+
+    static void condition(Output& out, const Cond& cond, bool negated = false) {
+        if (cond.kind == Cond::Kind::Not) {
+            condition(out, cond.operands[0], !negated);
+            return;
+        }
+        if (negated) out.text += "NOT (";
+        switch (cond.kind) {
+        case Cond::Kind::Compare:
+            out.text += std::string(cond.column) + " " + opText(cond.op) + " ";
+            out.value(cond.values[0]);
+            break;
+        case Cond::Kind::IsNull:
+            out.text += std::string(cond.column) + " IS NULL";
+            break;
+        case Cond::Kind::IsNotNull:
+            out.text += std::string(cond.column) + " IS NOT NULL";
+            break;
+        case Cond::Kind::Between:
+            out.text += std::string(cond.column) + " BETWEEN ";
+            out.value(cond.values[0]);
+            out.text += " AND ";
+            out.value(cond.values[1]);
+            break;
+        case Cond::Kind::Like:
+        case Cond::Kind::NotLike:
+            out.text += std::string(cond.column) + (cond.kind == Cond::Kind::Like ? " LIKE " : " NOT LIKE ");
+            out.value(cond.values[0]);
+            break;
+        case Cond::Kind::In:
+        case Cond::Kind::NotIn:
+            out.text += std::string(cond.column) + (cond.kind == Cond::Kind::In ? " IN (" : " NOT IN (");
+            for (size_t i = 0; i < cond.values.size(); ++i) {
+                if (i > 0) out.text += ", ";
+                out.value(cond.values[i], cond.bound);
+            }
+            out.text += ")";
+            break;
+        case Cond::Kind::RowCompare:
+            out.text += "(" + std::string(cond.column) + ", " + std::string(cond.second) + ") " + opText(cond.op) + " (";
+            out.value(cond.values[0]);
+            out.text += ", ";
+            out.value(cond.values[1]);
+            out.text += ")";
+            break;
+        case Cond::Kind::Raw:
+            out.text += cond.column;
+            break;
+        case Cond::Kind::InSubquery:
+        case Cond::Kind::NotInSubquery:
+        case Cond::Kind::Exists:
+            if (cond.kind == Cond::Kind::Exists) {
+                out.text += "EXISTS (";
+            } else {
+                out.text += std::string(cond.column) + (cond.kind == Cond::Kind::InSubquery ? " IN (" : " NOT IN (");
+            }
+            replay(*cond.subquery).statement(out);
+            out.text += ")";
+            break;
+        case Cond::Kind::And:
+        case Cond::Kind::Or:
+            out.text += "(";
+            condition(out, cond.operands[0]);
+            out.text += cond.kind == Cond::Kind::And ? ") AND (" : ") OR (";
+            condition(out, cond.operands[1]);
+            out.text += ")";
+            break;
+        case Cond::Kind::Not:
+            break;
+        }
+        if (negated) out.text += ")";
+    }
+
+    void statement(Output& out) const {
+        if (!ctes_.empty()) {
+            out.text += "WITH ";
+            for (size_t i = 0; i < ctes_.size(); ++i) {
+                if (i > 0) out.text += ", ";
+                out.text += std::string(ctes_[i].first) + " AS (";
+                replay(*ctes_[i].second).statement(out);
+                out.text += ")";
+            }
+            out.text += " ";
+        }
+
+        out.text += distinct_ ? "SELECT DISTINCT " : "SELECT ";
+        for (size_t i = 0; i < columns_.size(); ++i) {
+            if (i > 0) out.text += ", ";
+            out.text += columns_[i];
+        }
+        if (columns_.empty()) out.text += "*";
+        out.text += " FROM ";
+        if (from_) {
+            out.text += "(";
+            replay(*from_).statement(out);
+            out.text += ") ";
+        }
+        out.text += table_;
+
+        for (const auto& join : joins_) {
+            out.text += " " + std::string(join.type) + " " + std::string(join.table) + " ON ";
+            if (join.condition) {
+                condition(out, *join.condition);
+            } else {
+                out.text += join.on;
+            }
+        }
+
+        for (size_t i = 0; i < where_.size(); ++i) {
+            out.text += i == 0 ? " WHERE " : " AND ";
+            const bool group = where_.size() > 1 && isDisjunction(*where_[i]);
+            if (group) out.text += "(";
+            condition(out, *where_[i]);
+            if (group) out.text += ")";
+        }
+
+        if (!group_.empty()) {
+            out.text += " GROUP BY ";
+            for (size_t i = 0; i < group_.size(); ++i) {
+                if (i > 0) out.text += ", ";
+                out.text += group_[i];
+            }
+            if (!having_.empty()) out.text += " HAVING " + std::string(having_);
+        }
+
+        for (size_t i = 0; i < order_.size(); ++i) {
+            out.text += i == 0 ? " ORDER BY " : ", ";
+            out.text += std::string(order_[i].first) + (order_[i].second ? " ASC" : " DESC");
+        }
+
+        if (limit_ >= 0) out.text += " LIMIT " + std::to_string(limit_);
+        if (offset_ >= 0) {
+            if (limit_ < 0 && !Dialect::offset_without_limit.empty()) {
+                out.text += " " + std::string(Dialect::offset_without_limit);
+            }
+            out.text += " OFFSET " + std::to_string(offset_);
+        }
+    }
+
+public:
+    static Reference replay(const Script& script) {
+        Reference reference;
+        for (const auto& step : script.steps) {
+            reference.apply(step);
+        }
+        return reference;
+    }
+
+    void apply(const Step& step) {
+        static constexpr const char* JoinTypes[] = {"INNER JOIN", "LEFT JOIN", "RIGHT JOIN", "FULL JOIN"};
+
+        switch (step.kind) {
+        case Step::Kind::Select:
+            if (columns_.size() < limitOf<Config>(Config::MaxColumns)) columns_.push_back(step.name);
+            break;
+        case Step::Kind::Distinct:
+            distinct_ = true;
+            break;
+        case Step::Kind::From:
+            table_ = step.name;
+            from_ = nullptr;
+            break;
+        case Step::Kind::FromDerived:
+            table_ = step.name;
+            from_ = step.subquery;
+            break;
+        case Step::Kind::With:
+            ctes_.emplace_back(step.name, step.subquery);
+            break;
+        case Step::Kind::Join:
+        case Step::Kind::JoinOn:
+            if (joins_.size() < limitOf<Config>(Config::MaxJoins)) {
+                joins_.push_back({JoinTypes[step.join], step.name, step.text,
+                                  step.kind == Step::Kind::JoinOn ? &step.condition : nullptr});
+            }
+            break;
+        case Step::Kind::Where:
+            if (where_.size() < limitOf<Config>(Config::MaxConditions)) where_.push_back(&step.condition);
+            break;
+        case Step::Kind::ReplaceWhere:
+            if (step.index < where_.size()) where_[step.index] = &step.condition;
+            break;
+        case Step::Kind::GroupBy:
+            if (group_.size() < limitOf<Config>(Config::MaxGroupBy)) group_.push_back(step.name);
+            break;
+        case Step::Kind::Having:
+            having_ = step.text;
+            break;
+        case Step::Kind::OrderBy:
+            if (order_.size() < limitOf<Config>(Config::MaxOrderBy)) order_.emplace_back(step.name, step.ascending);
+            break;
+        case Step::Kind::Limit:
+            limit_ = step.number;
+            break;
+        case Step::Kind::Offset:
+            offset_ = step.number;
+            break;
+        }
+    }
+
+    // The text in `mode`, and the number of markers in it
+    [[nodiscard]] std::pair<std::string, size_t> render(Mode mode) const {
+        Output out{mode, {}, 0};
+        statement(out);
+        return {std::move(out.text), out.markers};
+    }
+};
+
+//=====================
+// Builders
+//=====================
+
+// Replays scripts on builders of `Config`. Owns what the builders reference:
+// bound IN lists, row values and subqueries.
+template<typename Config>
+class Replay {
+private:
+    std::deque<std::vector<SqlValue<Config>>> lists_;
+    std::deque<std::vector<int64_t>> boundLists_;
+    std::deque<std::vector<std::string_view>> rowColumns_;
+    std::deque<QueryBuilder<Config>> subqueries_;
+
+    static typename ConditionBase<Config>::Op op(Op op) {
+        return static_cast<typename ConditionBase<Config>::Op>(op);
+    }
+
+    static SqlValue<Config> value(const Value& value) {
+        switch (value.kind) {
+        case Value::Kind::Integer: return SqlValue<Config>(value.integer);
+        case Value::Kind::Real: return SqlValue<Config>(value.real);
+        case Value::Kind::Boolean: return SqlValue<Config>(value.boolean);
+        case Value::Kind::Text: return SqlValue<Config>(value.text);
+        case Value::Kind::Null: break;
+        }
+        return SqlValue<Config>();
+    }
+
+    std::span<const SqlValue<Config>> values(const Cond& cond) {
+        auto& list = lists_.emplace_back();
+        for (const auto& item : cond.values) {
+            list.push_back(value(item));
+        }
+        return list;
+    }
+
+    std::span<const int64_t> integers(const Cond& cond) {
+        auto& list = boundLists_.emplace_back();
+        for (const auto& item : cond.values) {
+            list.push_back(item.integer);
+        }
+        return list;
+    }
+
+public:
+    Condition<Config> condition(const Cond& cond) {
+        switch (cond.kind) {
+        case Cond::Kind::Compare:
+            return Condition<Config>(cond.column, op(cond.op), value(cond.values[0]));
+        case Cond::Kind::IsNull:
+            return Column<Config>(cond.column).isNull();
+        case Cond::Kind::IsNotNull:
+            return Column<Config>(cond.column).isNotNull();
+        case Cond::Kind::Between:
+            return Condition<Config>(cond.column, op(Op::Between), value(cond.values[0]), value(cond.values[1]));
+        case Cond::Kind::Like:
+            return Column<Config>(cond.column).like(cond.values[0].text);
+        case Cond::Kind::NotLike:
+            return Column<Config>(cond.column).notLike(cond.values[0].text);
+        case Cond::Kind::In:
+            return cond.bound ? Condition<Config>::inList(cond.column, integers(cond), InStrategy::Bind)
+                              : Condition<Config>::in(cond.column, values(cond));
+        case Cond::Kind::NotIn:
+            return cond.bound ? Condition<Config>::notInList(cond.column, integers(cond), InStrategy::Bind)
+                              : Condition<Config>::notIn(cond.column, values(cond));
+        case Cond::Kind::RowCompare: {
+            const auto& columns = rowColumns_.emplace_back(std::vector<std::string_view>{cond.column, cond.second});
+            return Condition<Config>::rowCompare(columns, op(cond.op), values(cond));
+        }
+        case Cond::Kind::Raw:
+            return Condition<Config>::rawView(cond.column);
+        case Cond::Kind::InSubquery:
+            return Condition<Config>::inSubquery(cond.column, subqueries_.emplace_back(builder(*cond.subquery)));
+        case Cond::Kind::NotInSubquery:
+            return Condition<Config>::notInSubquery(cond.column, subqueries_.emplace_back(builder(*cond.subquery)));
+        case Cond::Kind::Exists:
+            return Condition<Config>::exists(subqueries_.emplace_back(builder(*cond.subquery)));
+        case Cond::Kind::And:
+            return condition(cond.operands[0]) && condition(cond.operands[1]);
+        case Cond::Kind::Or:
+            return condition(cond.operands[0]) || condition(cond.operands[1]);
+        case Cond::Kind::Not:
+            return !condition(cond.operands[0]);
+        }
+        return Condition<Config>();
+    }
+
+    void apply(QueryBuilder<Config>& query, const Step& step) {
+        switch (step.kind) {
+        case Step::Kind::Select:
+            query.select(step.name);
+            break;
+        case Step::Kind::Distinct:
+            query.distinct();
+            break;
+        case Step::Kind::From:
+            query.from(step.name);
+            break;
+        case Step::Kind::FromDerived:
+            query.from(builder(*step.subquery).as(step.name));
+            break;
+        case Step::Kind::With:
+            query.with(step.name, builder(*step.subquery));
+            break;
+        case Step::Kind::Join:
+            switch (step.join) {
+            case 0: query.innerJoin(step.name, step.text); break;
+            case 1: query.leftJoin(step.name, step.text); break;
+            case 2: query.rightJoin(step.name, step.text); break;
+            default: query.fullJoin(step.name, step.text); break;
+            }
+            break;
+        case Step::Kind::JoinOn:
+            switch (step.join) {
+            case 0: query.innerJoin(step.name, condition(step.condition)); break;
+            case 1: query.leftJoin(step.name, condition(step.condition)); break;
+            case 2: query.rightJoin(step.name, condition(step.condition)); break;
+            default: query.fullJoin(step.name, condition(step.condition)); break;
+            }
+            break;
+        case Step::Kind::Where:
+            query.where(condition(step.condition));
+            break;
+        case Step::Kind::ReplaceWhere:
+            query.replaceWhere(step.index, condition(step.condition));
+            break;
+        case Step::Kind::GroupBy:
+            query.groupBy(step.name);
+            break;
+        case Step::Kind::Having:
+            query.having(step.text);
+            break;
+        case Step::Kind::OrderBy:
+            query.orderBy(step.name, step.ascending);
+            break;
+        case Step::Kind::Limit:
+            query.limit(step.number);
+            break;
+        case Step::Kind::Offset:
+            query.offset(step.number);
+            break;
+        }
+    }
+
+    QueryBuilder<Config> builder(const Script& script) {
+        QueryBuilder<Config> query;
+        for (const auto& step : script.steps) {
+            apply(query, step);
+        }
+        return query;
+    }
+};
+
+//=====================
+// Checks
+//=====================
+
+enum class Path : uint8_t {
+    Reference, Build, Measure, BuildInto, Cached, Copy, Compile, Parameterized, Render, Cache, Interned, Count
+};
+
+constexpr const char* PathNames[] = {
+    "reference", "build()", "measure()", "buildInto()", "cacheClauses()", "copy", "compile()",
+    "compileParameterized()", "render()", "QueryCache::render()", "buildInterned()"
+};
+
+struct PathStats {
+    uint64_t calls{0};
+    uint64_t bytes{0};
+    std::chrono::nanoseconds time{0};
+};
+
+PathStats stats[static_cast<size_t>(Path::Count)];
+uint64_t inputs = 0;
+uint64_t semanticMatches = 0;
+uint64_t preparedStatements = 0;  // Parameterized statements SQLite accepted
+std::span<const uint8_t> currentInput;
+
+template<typename Fn>
+auto timed(Path path, Fn&& fn) {
+    const auto began = std::chrono::steady_clock::now();
+    auto result = fn();
+    auto& entry = stats[static_cast<size_t>(path)];
+    entry.time += std::chrono::steady_clock::now() - began;
+    ++entry.calls;
+    if constexpr(requires { result.size(); }) {
+        entry.bytes += result.size();
+    } else if constexpr(requires { result.value().size(); }) {
+        if (!result.hasError()) entry.bytes += result.value().size();
+    } else if constexpr(std::is_same_v<decltype(result), Result<size_t>>) {
+        if (!result.hasError()) entry.bytes += result.value();
+    } else if constexpr(requires { result.value().sql(); }) {
+        if (!result.hasError()) entry.bytes += result.value().sql().size();
+    }
+    return result;
+}
+
+void printReport() {
+    std::printf("%llu inputs", static_cast<unsigned long long>(inputs));
+    if (preparedStatements > 0) {
+        std::printf(", %llu statements prepared by SQLite", static_cast<unsigned long long>(preparedStatements));
+    }
+    if (semanticMatches > 0) {
+        std::printf(", %llu matched by EXPLAIN only", static_cast<unsigned long long>(semanticMatches));
+    }
+    std::printf("\n%-24s %12s %12s %10s\n", "path", "calls", "calls/s", "MB/s");
+    for (size_t i = 0; i < static_cast<size_t>(Path::Count); ++i) {
+        const auto& entry = stats[i];
+        const double seconds = std::chrono::duration<double>(entry.time).count();
+        if (entry.calls == 0 || seconds <= 0) continue;
+        std::printf("%-24s %12llu %12.0f %10.1f\n", PathNames[i], static_cast<unsigned long long>(entry.calls),
+                    static_cast<double>(entry.calls) / seconds, static_cast<double>(entry.bytes) / seconds / 1e6);
+    }
+}
+
+[[noreturn]] void report(const char* config, const char* path, std::string_view got, std::string_view expected) {
+    std::fprintf(stderr, "%s: %s differs from the reference\n  got:      %.*s\n  expected: %.*s\n", config, path,
+                 static_cast<int>(got.size()), got.data(), static_cast<int>(expected.size()), expected.data());
+    std::ofstream("fuzz_builder-crash.bin", std::ios::binary)
+        .write(reinterpret_cast<const char*>(currentInput.data()), static_cast<std::streamsize>(currentInput.size()));
+    std::fprintf(stderr, "Input written to fuzz_builder-crash.bin\n");
+    std::abort();
+}
+
+#ifdef SQLQUERYBUILDER_FUZZ_SQLITE
+// In-memory database with the tables the scripts use
+sqlite3* database() {
+    static sqlite3* db = [] {
+        sqlite3* handle = nullptr;
+        sqlite3_open(":memory:", &handle);
+        sqlite3_exec(handle,
+                     "CREATE TABLE users (id INTEGER PRIMARY KEY, name TEXT, email TEXT, age INTEGER, score REAL, team_id INTEGER);"
+                     "CREATE TABLE orders (id INTEGER PRIMARY KEY, user_id INTEGER, total REAL);"
+                     "CREATE TABLE teams (id INTEGER PRIMARY KEY, name TEXT);",
+                     nullptr, nullptr, nullptr);
+        return handle;
+    }();
+    return db;
+}
+
+// The EXPLAIN program of `sql`, or the error preparing it
+std::string program(std::string_view sql) {
+    const std::string explain = "EXPLAIN " + std::string(sql);
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(database(), explain.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+        return std::string("error: ") + sqlite3_errmsg(database());
+    }
+    std::string result;
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        for (int column = 1; column < sqlite3_column_count(stmt); ++column) {
+            if (const auto* text = sqlite3_column_text(stmt, column)) result += reinterpret_cast<const char*>(text);
+            result += '|';
+        }
+        result += '\n';
+    }
+    sqlite3_finalize(stmt);
+    return result;
+}
+
+// Parameters SQLite counts in `sql`, if it prepares
+std::optional<int> parameterCount(std::string_view sql) {
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(database(), sql.data(), static_cast<int>(sql.size()), &stmt, nullptr) != SQLITE_OK) {
+        return std::nullopt;
+    }
+    const int count = sqlite3_bind_parameter_count(stmt);
+    ++preparedStatements;
+    sqlite3_finalize(stmt);
+    return count;
+}
+#endif
+
+template<typename Config>
+void expectSame(const char* config, Path path, std::string_view got, std::string_view expected) {
+    if (got == expected) {
+        return;
+    }
+#ifdef SQLQUERYBUILDER_FUZZ_SQLITE
+    if constexpr(std::is_same_v<DialectOf<Config>, SqliteDialect>) {
+        if (program(got) == program(expected)) {
+            ++semanticMatches;
+            return;
+        }
+    }
+#endif
+    report(config, PathNames[static_cast<size_t>(path)], got, expected);
+}
+
+template<typename Config>
+std::string_view textOf(const char* config, Path path, const Result<std::string>& result) {
+    if (result.hasError()) {
+        report(config, PathNames[static_cast<size_t>(path)], result.error().message, "no error");
+    }
+    return result.value();
+}
+
+template<typename Config>
+void check(const char* config, const Script& script) {
+    Replay<Config> replay;
+    Reference<Config> reference;
+    QueryBuilder<Config> plain;
+    QueryBuilder<Config> cached;
+    cached.cacheClauses();
+
+    // The clause cache is checked after every call, so that each clause is
+    // both rendered and reused across the script
+    for (const auto& step : script.steps) {
+        replay.apply(plain, step);
+        replay.apply(cached, step);
+        reference.apply(step);
+        const auto expected = timed(Path::Reference, [&] { return reference.render(Mode::Inline).first; });
+        expectSame<Config>(config, Path::Cached, timed(Path::Cached, [&] { return cached.build(); }), expected);
+    }
+
+    const auto [expected, literals] = reference.render(Mode::Inline);
+    const auto [parameterized, markers] = reference.render(Mode::Parameterized);
+    const auto spliced = reference.render(Mode::Spliced).first;
+
+    auto built = timed(Path::Build, [&] { return plain.buildResult(); });
+    expectSame<Config>(config, Path::Build, textOf<Config>(config, Path::Build, built), expected);
+
+    auto size = timed(Path::Measure, [&] { return plain.measure(); });
+    if (size.hasError() || size.value() != expected.size()) {
+        report(config, "measure()", std::to_string(size.hasError() ? 0 : size.value()), std::to_string(expected.size()));
+    }
+
+    std::string buffer = "-- ";
+    timed(Path::BuildInto, [&] { return plain.buildInto(buffer); });
+    expectSame<Config>(config, Path::BuildInto, buffer, "-- " + expected);
+
+    QueryBuilder<Config> copy(plain);
+    expectSame<Config>(config, Path::Copy, timed(Path::Copy, [&] { return copy.build(); }), expected);
+    QueryBuilder<Config> moved(std::move(copy));
+    expectSame<Config>(config, Path::Copy, moved.build(), expected);
+
+    auto compiled = timed(Path::Compile, [&] { return plain.compileResult(); });
+    if (compiled.hasError()) {
+        report(config, "compile()", compiled.error().message, "no error");
+    }
+    expectSame<Config>(config, Path::Compile, compiled.value().sql(), expected);
+    if (compiled.value().slotCount() != literals) {
+        report(config, "compile() slots", std::to_string(compiled.value().slotCount()), std::to_string(literals));
+    }
+
+    auto lifted = timed(Path::Parameterized, [&] { return plain.compileParameterizedResult(); });
+    if (lifted.hasError()) {
+        report(config, "compileParameterized()", lifted.error().message, "no error");
+    }
+    const auto& statement = lifted.value();
+    expectSame<Config>(config, Path::Parameterized, statement.sql(), parameterized);
+    auto count = plain.bindCount();
+    if (statement.slotCount() != markers || count.hasError() || count.value() != markers) {
+        report(config, "bindCount()", std::to_string(count.hasError() ? 0 : count.value()), std::to_string(markers));
+    }
+#ifdef SQLQUERYBUILDER_FUZZ_SQLITE
+    if constexpr(std::is_same_v<DialectOf<Config>, SqliteDialect>) {
+        if (auto parameters = parameterCount(statement.sql()); parameters && static_cast<size_t>(*parameters) != markers) {
+            report(config, "SQLite parameter count", std::to_string(*parameters), std::to_string(markers));
+        }
+    }
+#endif
+
+    std::vector<SqlValue<Config>> values;
+    plain.bindValues(values);
+    auto rendered = timed(Path::Render, [&] { return statement.render(values); });
+    expectSame<Config>(config, Path::Render, textOf<Config>(config, Path::Render, rendered), spliced);
+
+    // One cache for every input: a fingerprint that misses part of the
+    // shape returns another input's statement
+    static QueryCache<Config> cache(256);
+    auto fromCache = timed(Path::Cache, [&] { return cache.render(plain); });
+    expectSame<Config>(config, Path::Cache, textOf<Config>(config, Path::Cache, fromCache), spliced);
+
+    SqlPool pool;
+    auto interned = timed(Path::Interned, [&] { return plain.buildInterned(pool); });
+    if (interned.hasError()) {
+        report(config, "buildInterned()", interned.error().message, "no error");
+    }
+    expectSame<Config>(config, Path::Interned, interned.value().view(), expected);
+}
+
+void run(std::span<const uint8_t> data) {
+    currentInput = data;
+    Input in(data);
+    const auto script = decodeScript(in, 0);
+    ++inputs;
+
+    check<TinyConfig>("TinyConfig", *script);
+    check<DefaultConfig>("DefaultConfig", *script);
+    check<LargeConfig>("LargeConfig", *script);
+    check<CompactConfig>("CompactConfig", *script);
+    check<PostgresConfig>("PostgresConfig", *script);
+}
+
+} // namespace
+
+#ifdef SQLQUERYBUILDER_LIBFUZZER
+extern "C" int LLVMFuzzerInitialize(int*, char***) {
+    std::atexit(printReport);
+    return 0;
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    run(std::span<const uint8_t>(data, size));
+    return 0;
+}
+#else
+int main(int argc, char** argv) {
+    uint64_t runs = 100000;
+    uint64_t seed = 1;
+    size_t maxLength = 512;
+    std::vector<std::string> files;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg(argv[i]);
+        if (arg.starts_with("-runs=")) {
+            runs = std::strtoull(argv[i] + 6, nullptr, 10);
+        } else if (arg.starts_with("-seed=")) {
+            seed = std::strtoull(argv[i] + 6, nullptr, 10);
+        } else if (arg.starts_with("-max_len=")) {
+            maxLength = std::max<size_t>(std::strtoull(argv[i] + 9, nullptr, 10), 1);
+        } else {
+            files.emplace_back(arg);
+        }
+    }
+
+    if (!files.empty()) {
+        for (const auto& file : files) {
+            std::ifstream stream(file, std::ios::binary);
+            const std::vector<uint8_t> data((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+            run(data);
+        }
+    } else {
+        std::mt19937_64 random(seed);
+        std::vector<uint8_t> data;
+        for (uint64_t i = 0; i < runs; ++i) {
+            data.resize(random() % maxLength);
+            for (auto& byte : data) {
+                byte = static_cast<uint8_t>(random());
+            }
+            run(data);
+        }
+    }
+
+    printReport();
+    return 0;
+}
+#endif
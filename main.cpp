@@ -15,6 +15,20 @@ struct MyConfig {
     static constexpr bool ThrowOnError = true;
 };
 
+// Optional: Render for another database
+struct PostgresConfig : sql::DefaultConfig {
+    using Dialect = sql::PostgresDialect;
+};
+
+struct MySqlConfig : sql::DefaultConfig {
+    using Dialect = sql::MySqlDialect;
+};
+
+// Optional: Aggregate build metrics for every builder of a config
+struct MeteredConfig : sql::DefaultConfig {
+    using Observer = sql::BuildMetrics<MeteredConfig>;
+};
+
 // Example enum types
 enum class UserStatus : int {
     Active = 1,
@@ -106,9 +120,9 @@ int main() {
     using namespace std::string_view_literals;
 
     // Create tables
-    const users_table users;
+    constexpr users_table users;
     const tasks_table tasks;
-    const orders_table orders;
+    constexpr orders_table orders;
     const user_profiles_table profiles;
     const order_items_table order_items;
     const products_table products;
@@ -686,5 +700,557 @@ int main() {
         std::cout << query2 << std::endl;
     }
 
+    // Batched multi-row insert
+    {
+        printSection("Batched Insert");
+
+        std::array<std::tuple<std::string_view, std::string_view>, 3> rows = {{
+            {"Alice", "alice@example.com"},
+            {"Bob", "bob@example.com"},
+            {"Carol", "carol@example.com"},
+        }};
+
+        auto batch = QueryBuilder<>::insertBatch(users.table, {users.name, users.email});
+        batch.maxRows(2).write(std::span<const std::tuple<std::string_view, std::string_view>>(rows),
+                               [](std::string_view statement) { std::cout << statement << "\n"; });
+
+        // With the values passed to the sink, rows are bound instead of inlined
+        auto bound = QueryBuilder<PostgresConfig>::insertBatch(users.table, {users.name, users.email});
+        bound.write(std::span<const std::tuple<std::string_view, std::string_view>>(rows),
+                    [](std::string_view statement, std::span<const SqlValue<PostgresConfig>> values) {
+                        std::cout << statement << " -- " << values.size() << " values\n";
+                    });
+    }
+
+    // Upserts and set-based updates
+    {
+        printSection("Upserts and Bulk Updates");
+
+        // Update the existing row on a key conflict instead of replacing it
+        auto upsert = QueryBuilder()
+                          .insert(users.table)
+                          .value(users.id, 1)
+                          .value(users.email, "alice@example.com")
+                          .value(users.last_login, "2024-03-01")
+                          .onConflict(users.id)
+                          .doUpdate(users.last_login, excluded(users.last_login))
+                          .build();
+        std::cout << upsert << "\n";
+
+        // Many rows in one UPDATE, matched on their key
+        std::array<std::tuple<int64_t, std::string_view>, 3> roles = {{
+            {1, "admin"},
+            {2, "member"},
+            {3, "member"},
+        }};
+        auto rows = std::span<const std::tuple<int64_t, std::string_view>>(roles);
+        auto print = [](std::string_view statement) { std::cout << statement << "\n"; };
+
+        QueryBuilder<PostgresConfig>::updateBatch(users.table, {users.id}, {users.role}).write(rows, print);
+        QueryBuilder<MySqlConfig>::updateBatch(users.table, {users.id}, {users.role}).write(rows, print);
+    }
+
+    // Compiled statements
+    {
+        printSection("Compiled Statements");
+
+        auto compiled = QueryBuilder()
+                            .select(users.id, users.name)
+                            .from(users.table)
+                            .where(users.email == ph(":email"))
+                            .where(users.active == ph())
+                            .limit(1)
+                            .compile();
+
+        std::cout << compiled.sql() << "\n";
+        std::cout << "Bind slots: " << compiled.slotCount() << "\n";
+
+        std::array values = {val("john@example.com"sv), val(true)};
+        std::cout << compiled.render(values).value() << "\n";
+    }
+
+    // Caller-owned output
+    {
+        printSection("Build Into Buffer");
+
+        auto query = QueryBuilder()
+                         .select(users.id, users.name)
+                         .from(users.table)
+                         .where(users.email == "john@example.com"sv);
+
+        FixedBuffer<256> buffer;
+        auto written = query.buildInto(buffer);
+        std::cout << buffer.c_str() << " (" << written.value() << " bytes)\n";
+
+        FixedBuffer<16> tooSmall;
+        if (auto result = query.buildInto(tooSmall); result.hasError()) {
+            std::cout << "Error: " << result.error().message << "\n";
+        }
+    }
+
+    // Small inline storage that grows past the fixed limits
+    {
+        printSection("Compact Storage");
+
+        std::array<int64_t, 24> ids{};
+        for (size_t i = 0; i < ids.size(); ++i) {
+            ids[i] = static_cast<int64_t>(i + 1);
+        }
+
+        auto query = QueryBuilder<CompactConfig>()
+                         .select("id"sv, "name"sv)
+                         .from("users"sv)
+                         .whereIn("id"sv, std::span<const int64_t>(ids))
+                         .build();
+
+        std::cout << query << "\n";
+        std::cout << "Builder size: " << sizeof(QueryBuilder<CompactConfig>) << " bytes (default "
+                  << sizeof(QueryBuilder<>) << ")\n";
+    }
+
+    // Large IN lists
+    {
+        printSection("Large IN Lists");
+
+        std::array<int64_t, 6> ids = {3, 5, 8, 13, 21, 34};
+        std::span<const int64_t> idSpan(ids);
+
+        for (auto strategy : {InStrategy::Bind, InStrategy::JsonEach, InStrategy::AnyArray}) {
+            auto query = QueryBuilder()
+                             .select(users.id, users.name)
+                             .from(users.table)
+                             .whereIn(users.id, idSpan, strategy);
+
+            auto compiled = query.compileParameterized();
+            std::vector<SqlValue<>> values;
+            query.bindValues(values);
+            std::cout << compiled.sql() << "\n  " << compiled.render(values).value() << "\n";
+        }
+
+        auto base = QueryBuilder().select(users.id).from(users.table);
+        base.forEachInChunk(users.id, idSpan, 4, [](const QueryBuilder<>& chunk) {
+            std::cout << chunk.compileParameterized().sql() << "\n";
+        });
+
+        // Chunks sized by the dialect's parameter limit
+        auto sized = base.forEachInChunk(users.id, idSpan, [](const QueryBuilder<>& chunk) {
+            std::cout << "Chunk of " << chunk.bindCount().value() << " parameters\n";
+        });
+        std::cout << "Chunks: " << sized.value() << "\n";
+    }
+
+    // Shape cache
+    {
+        printSection("Query Cache");
+
+        QueryCache<> cache;
+        for (int64_t lastId : {100, 200, 300}) {
+            QueryBuilder query;
+            query.select(users.id, users.name)
+                .from(users.table)
+                .where(users.id > lastId)
+                .where(users.active == true);
+
+            // The statement is compiled on the first call only
+            std::cout << cache.render(query).value() << "\n";
+        }
+
+        auto stats = cache.stats();
+        std::cout << "Hits: " << stats.hits << ", misses: " << stats.misses << "\n";
+    }
+
+    {
+        printSection("Interned Statements");
+
+        // One copy of each statement text; handles compare by pointer
+        SqlPool pool;
+        QueryBuilder lookup;
+        lookup.select(users.id, users.name).from(users.table).where(users.email == ph(":email"));
+        auto first = lookup.buildInterned(pool);
+        auto second = lookup.buildInterned(pool);
+        std::cout << first.value().view() << "\n";
+        std::cout << "Same handle: " << (first.value() == second.value() ? "yes" : "no") << "\n";
+
+        // Cached statements keep their text in the pool
+        QueryCache<> cache;
+        cache.internStatements(&pool);
+        auto entry = cache.get(lookup);
+        std::cout << "Cached text interned: " << (entry.value()->interned() == first.value() ? "yes" : "no") << "\n";
+
+        auto stats = pool.stats();
+        std::cout << "Entries: " << stats.entries << ", hits: " << stats.hits << "\n";
+    }
+
+    {
+        printSection("String Ownership");
+
+        // Values are views; strings built at runtime are kept in an arena
+        StringArena arena;
+        QueryBuilder query;
+        query.select(users.id).from(users.table);
+        for (int i = 1; i <= 2; ++i) {
+            query.where(users.role != arena.keep("guest_" + std::to_string(i)));
+        }
+        std::cout << query.build() << "\n";
+    }
+
+    {
+        printSection("Batch Building");
+
+        // One UPDATE per record, rendered across worker threads and joined in order
+        std::string script;
+        auto count = buildBatch(3, [&](size_t i) {
+            QueryBuilder update;
+            update.update(users.table)
+                .set(users.role, "member")
+                .where(users.id == static_cast<int64_t>(i + 1));
+            return update;
+        }, script);
+
+        std::cout << script << "\n";
+        std::cout << "Statements: " << count.value() << "\n";
+    }
+
+    {
+        printSection("Compile-time Queries");
+
+        // Rendered by the compiler; the tables used here must be constexpr
+        constexpr auto recentOrders = StaticQuery<>()
+            .select(users.name, orders.total)
+            .from(users.table)
+            .innerJoin(orders.table, users.id, orders.user_id)
+            .where(users.status == lit(UserStatus::Active) && orders.total > param(":min_total"))
+            .orderBy(orders.order_date, false)
+            .limit(10)
+            .build();
+        static_assert(recentOrders.view().starts_with("SELECT name, total FROM users INNER JOIN orders"));
+
+        std::cout << recentOrders.view() << "\n";
+
+        // Same slot table as QueryBuilder::compile()
+        auto compiled = recentOrders.compile();
+        std::cout << "Slots: " << compiled.slotCount()
+                  << ", first: " << compiled.slots()[0].name << "\n";
+    }
+
+    {
+        printSection("Schema Registry");
+
+        // Result positions and row types fixed by the schema at compile time
+        using Listing = Columns<&users_table::name, &orders_table::total, &orders_table::order_date>;
+        static_assert(Listing::indexOf<&orders_table::total> == 1);
+        static_assert(Listing::within<users_table, orders_table>);
+        static_assert(Schema<users_table>::size == 10);
+
+        QueryBuilder listing;
+        Listing::select(listing).from(users.table);
+        if (auto error = Listing::check(listing)) {
+            std::cout << "Rejected: " << error->message << "\n";
+        }
+        listing.innerJoin(orders.table, users.id == orders.user_id);
+        std::cout << listing.build() << "\n";
+
+        Listing::Row row{"Alice", 99.5, "2024-03-01"};
+        std::cout << Listing::get<&users_table::name>(row) << " spent "
+                  << Listing::get<&orders_table::total>(row) << "\n";
+    }
+
+    {
+        printSection("Subqueries and CTEs");
+
+        QueryBuilder bigSpenders;
+        bigSpenders.select(orders.user_id)
+            .from(orders.table)
+            .where(orders.total > ph(":min_total"));
+
+        QueryBuilder recent;
+        recent.select(orders.user_id, orders.total)
+            .from(orders.table)
+            .where(orders.order_date >= "2024-01-01");
+
+        // Nested builders render into the outer query in one pass
+        QueryBuilder report;
+        report.with("recent_orders", recent)
+            .select(users.name, users.email)
+            .from(users.table)
+            .whereIn(users.id, bigSpenders)
+            .whereExists(QueryBuilder().select("1").from("recent_orders")
+                             .whereRaw("recent_orders.user_id = users.id"));
+        std::cout << report.build() << "\n";
+
+        // Placeholders of the subqueries become slots of the outer statement
+        auto compiled = report.compileParameterized();
+        std::cout << "Slots: " << compiled.slotCount() << "\n";
+
+        QueryBuilder totals;
+        totals.select("t.user_id", "t.total")
+            .from(recent.as("t"))
+            .orderBy("t.total", false);
+        std::cout << totals.build() << "\n";
+    }
+
+    {
+        printSection("SQL Dialects");
+
+        // Positional placeholders are numbered across the whole statement
+        QueryBuilder<PostgresConfig> pg;
+        pg.select(users.id, users.name)
+            .from(users.table)
+            .where(users.active == true)
+            .where(users.created_at >= ph()).where(users.role == ph())
+            .offset(20);
+        std::cout << pg.build() << "\n";
+
+        QueryBuilder<MySqlConfig> my;
+        my.insertOrReplace(my.quoted("order"))
+            .value("id", 1)
+            .value("status", "open");
+        std::cout << my.build() << "\n";
+    }
+
+    {
+        printSection("Keyset Pagination");
+
+        QueryBuilder feed;
+        feed.select(orders.id, orders.total, orders.order_date)
+            .from(orders.table)
+            .where(orders.user_id == 42)
+            .orderBy(orders.order_date, false)
+            .orderBy(orders.id, false);
+
+        // Last row of the previous page, in ORDER BY order
+        std::array lastRow{SqlValue<>("2024-03-01"), SqlValue<>(int64_t{1042})};
+        std::cout << feed.seekAfter(lastRow, 20).build() << "\n";
+
+        // Opaque token for the client; it comes back with the next request
+        auto cursor = feed.nextCursor(lastRow);
+        std::cout << "Cursor: " << cursor.value() << "\n";
+        std::cout << feed.seekAfter(cursor.value(), 20).build() << "\n";
+
+        // Mixed sort directions expand to an OR chain
+        std::array largest{SqlValue<>(99.5), SqlValue<>(int64_t{1042})};
+        feed.reset();
+        feed.select(orders.id).from(orders.table)
+            .orderBy(orders.total, false).orderBy(orders.id)
+            .seekAfter(largest, 20);
+        std::cout << feed.build() << "\n";
+    }
+
+    {
+        printSection("Build Metrics");
+
+        for (int32_t page = 0; page < 3; ++page) {
+            QueryBuilder<MeteredConfig> listing;
+            listing.select("id", "name").from("users").limit(20).offset(page * 20);
+            std::cout << listing.build() << "\n";
+        }
+        QueryBuilder<MeteredConfig> failing;
+        failing.update("");
+        std::cout << "Error: " << failing.buildResult().error().message << "\n";
+
+        auto metrics = BuildMetrics<MeteredConfig>::snapshot();
+        std::cout << "Builds: " << metrics.builds << ", failed: " << metrics.failures
+                  << ", bytes: " << metrics.bytes << " of " << metrics.reserved << " reserved\n";
+        std::cout << "EmptyTable errors: " << metrics.errors[static_cast<size_t>(QueryError::Code::EmptyTable)] << "\n";
+    }
+
+    {
+        printSection("Index Hints and Query Plans");
+
+        // useIndex() hints the FROM table, or the join before it
+        QueryBuilder history;
+        history.select(orders.id, orders.total)
+            .from(orders.table).useIndex("idx_orders_user")
+            .where(orders.user_id == 42);
+        std::cout << history.build() << "\n";
+
+        QueryBuilder<MySqlConfig> myHistory;
+        myHistory.select("id", "total").from("orders").useIndex("idx_orders_user").where(col("user_id") == 42);
+        std::cout << myHistory.build() << "\n";
+
+        QueryBuilder<PostgresConfig> pgHistory;
+        pgHistory.select("o.id", "u.name")
+            .from("orders o")
+            .innerJoin("users u", "u.id = o.user_id").useIndex("users_pkey")
+            .where(col("o.total") > 100);
+        std::cout << pgHistory.build() << "\n";
+
+        // The EXPLAIN form of a query, and its output parsed back
+        std::cout << history.explain().value() << "\n";
+        std::cout << pgHistory.explain(ExplainMode::Analyze).value() << "\n";
+
+        auto plan = parsePlan<PostgresConfig>(
+            "Hash Join  (cost=1.09..2.22 rows=3 width=36)\n"
+            "  Hash Cond: (o.user_id = u.id)\n"
+            "  ->  Seq Scan on orders o  (cost=0.00..1.05 rows=5 width=8)\n"
+            "        Filter: (total > 100)\n"
+            "  ->  Index Scan using users_pkey on users u  (cost=0.00..1.04 rows=4 width=36)\n");
+        for (const auto& step : plan.steps) {
+            std::cout << step.detail << (step.full_scan ? " [full scan]" : "") << "\n";
+        }
+    }
+
+    {
+        printSection("Read/Write Routing and Sharding");
+
+        // Orders are spread over 4 shards by user_id
+        ShardRouter router(orders.user_id, 4);
+        const auto describe = [](const Result<Route>& routed) {
+            if (routed.hasError()) {
+                std::cout << "Error: " << routed.error().message << "\n";
+                return;
+            }
+            const Route& route = routed.value();
+            std::cout << (route.target == RouteTarget::Replica ? "replica" : "primary") << ", shards";
+            for (size_t shard : route.shards) std::cout << " " << shard;
+            std::cout << (route.keyed ? "" : " (all)") << "\n";
+        };
+
+        QueryBuilder recent;
+        recent.select(orders.id, orders.total).from(orders.table).where(orders.user_id == 42);
+        describe(router.route(recent));
+
+        QueryBuilder cancel;
+        cancel.update(orders.table).set(orders.status, "cancelled").where(orders.user_id == ph(":user"));
+        std::pair<std::string_view, SqlValue<>> user[] = {{":user", SqlValue<>(7)}};
+        describe(router.route(cancel, user));
+
+        // An INSERT has to place its row on one shard, so its key must be known
+        QueryBuilder place;
+        place.insert(orders.table).value(orders.user_id, ph(":user")).value(orders.total, 25.0);
+        describe(router.route(place, user));
+        describe(router.route(place));
+
+        // Neither can an INSERT without the key, nor an UPDATE that moves a row to another key
+        QueryBuilder unkeyed;
+        unkeyed.insert(orders.table).value(orders.total, 5.0);
+        describe(router.route(unkeyed));
+        QueryBuilder reassign;
+        reassign.update(orders.table).set(orders.user_id, 7).where(orders.user_id == 42);
+        describe(router.route(reassign));
+
+        // A query over several users runs on each of their shards with only
+        // its share of the ids; the caller merges in order and limits again
+        const std::array<int64_t, 5> users = {3, 4, 8, 11, 42};
+        QueryBuilder largest;
+        largest.select(orders.id, orders.total).from(orders.table)
+            .whereIn(orders.user_id, std::span<const int64_t>(users))
+            .orderBy(orders.total, false).limit(10).offset(10);
+        describe(router.route(largest));
+        auto parts = router.split(largest);
+        for (const auto& part : parts.value()) {
+            std::cout << "shard " << part.shard << ": " << part.query.build() << "\n";
+        }
+
+        // Shards return partial groups, so the top 5 is only cut after combining them
+        QueryBuilder spend;
+        spend.select(orders.payment_method, sum(orders.total)).from(orders.table)
+            .groupBy(orders.payment_method).orderBy("SUM(total)", false).limit(5);
+        auto groups = router.split(spend);
+        for (const auto& part : groups.value()) {
+            std::cout << "shard " << part.shard << ": " << part.query.build() << "\n";
+        }
+    }
+
+#ifdef SQLQUERYBUILDER_USE_QTSQL
+    {
+        printSection("Qt SQL Execution");
+
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE");
+        // Shared-cache in-memory database, so that pooled clones see the same data
+        db.setConnectOptions("QSQLITE_OPEN_URI");
+        db.setDatabaseName("file:sqlquerybuilder_example?mode=memory&cache=shared");
+        if (!db.open()) {
+            std::cout << "SQLite driver not available\n";
+        } else {
+            QSqlQuery(db).exec("CREATE TABLE users (id INTEGER, name TEXT, active INTEGER)");
+
+            // Statements are prepared once per connection and reused
+            PreparedStatements<> statements(db);
+
+            auto insert = QueryBuilder()
+                .insert(users.table)
+                .value(users.id, ph())
+                .value(users.name, ph())
+                .value(users.active, true)
+                .compileParameterized();
+
+            // One list per slot; the active flag was lifted into a slot too
+            std::vector<QVariantList> columns{
+                {qlonglong(1), qlonglong(2), qlonglong(3)},
+                {QString("Alice"), QString("Bob"), QString("Carol")},
+                {true, true, false}
+            };
+            if (statements.execBatch(insert, columns).hasError()) {
+                std::cout << "Batch insert failed\n";
+            }
+
+            auto result = statements.exec(QueryBuilder()
+                .select(users.name)
+                .from(users.table)
+                .where(users.active == true)
+                .orderBy(users.name));
+            if (!result.hasError()) {
+                QSqlQuery* rows = result.value();
+                while (rows->next()) {
+                    std::cout << rows->value(0).toString().toStdString() << "\n";
+                }
+            }
+
+            // Typed rows: each column is decoded into its TypedColumn type
+            QueryCache<> cache;
+            TypedSelect listing(users.id, users.name, users.active);
+            listing.from(users.table).orderBy(users.id);
+            auto typed = listing.fetch(statements, &cache);
+            if (!typed.hasError()) {
+                for (const auto& [id, name, active] : typed.value()) {
+                    std::cout << id << " " << name << (active ? " (active)" : "") << "\n";
+                }
+            }
+
+            // Columnar fetch: one vector per column
+            decltype(listing)::Columns table;
+            auto count = listing.fetchColumns(statements, table, &cache);
+            if (!count.hasError()) {
+                std::cout << count.value() << " rows, first name " << std::get<1>(table).front() << "\n";
+            }
+
+            // Schema column list: row fields read by column, at fixed offsets
+            using Names = Columns<&users_table::id, &users_table::name>;
+            TypedSelect named(Names{});
+            named.from(users.table).where(users.active == true);
+            auto namedRows = named.fetch(statements, &cache);
+            if (!namedRows.hasError()) {
+                for (const auto& row : namedRows.value()) {
+                    std::cout << Names::get<&users_table::name>(row) << "\n";
+                }
+            }
+
+            // Async execution on pooled connections, each a clone of db
+            // opened on its own thread
+            ConnectionPool<> pool(db, 2);
+            auto countActive = [](ConnectionPool<>& pool, QueryCache<>& cache) -> Task<size_t> {
+                auto active = co_await pool.execute(QueryBuilder()
+                    .select("id"sv, "name"sv)
+                    .from("users"sv)
+                    .where(col("active") == true), &cache);
+                co_return active.hasError() ? 0 : active.value().rows.size();
+            };
+            std::cout << syncWait(countActive(pool, cache)) << " active users\n";
+
+            // Plan of a query as the database chose it
+            auto plan = statements.explain(QueryBuilder()
+                .select(users.name)
+                .from(users.table)
+                .where(users.active == true));
+            if (!plan.hasError()) {
+                for (auto table : plan.value().fullScans()) {
+                    std::cout << "Full scan of " << table << "\n";
+                }
+            }
+        }
+    }
+#endif
+
     return 0;
 }
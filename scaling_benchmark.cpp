@@ -0,0 +1,222 @@
+#include "sqlquerybuilder.hpp"
+#include <benchmark/benchmark.h>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+// Scaling benchmarks: how build cost grows with the size of the query, and
+// how many heap allocations a build makes. Every benchmark reports
+//   allocs  heap allocations per build, counted by the operator new below
+//   bytes_per_second  SQL text produced
+//   items_per_second  statements built
+// The replaced operator new is global, so these live in their own binary
+// rather than in usage_benchmark.cpp.
+
+namespace {
+
+// Allocations made by the current thread; per thread so that the threaded
+// benchmarks do not contend on a shared counter
+thread_local uint64_t allocations = 0;
+
+void* countedAllocation(std::size_t size) {
+    ++allocations;
+    if (void* memory = std::malloc(size > 0 ? size : 1)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+} // namespace
+
+void* operator new(std::size_t size) { return countedAllocation(size); }
+void* operator new[](std::size_t size) { return countedAllocation(size); }
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete[](void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, std::size_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, std::size_t) noexcept { std::free(memory); }
+
+namespace {
+
+// Records the allocations and output of one benchmark run on this thread.
+// Counters of all threads are summed, then divided by the total iterations.
+class BuildStats {
+private:
+    benchmark::State& state_;
+    uint64_t start_;
+    int64_t bytes_{0};
+
+public:
+    explicit BuildStats(benchmark::State& state) : state_(state), start_(allocations) {}
+
+    BuildStats(const BuildStats&) = delete;
+    BuildStats& operator=(const BuildStats&) = delete;
+
+    void built(const std::string& sql) {
+        bytes_ += static_cast<int64_t>(sql.size());
+    }
+
+    ~BuildStats() {
+        state_.counters["allocs"] = benchmark::Counter(static_cast<double>(allocations - start_),
+                                                       benchmark::Counter::kAvgIterations);
+        state_.SetBytesProcessed(bytes_);
+        state_.SetItemsProcessed(state_.iterations());
+    }
+};
+
+// Column names that outlive every builder, since builders keep views
+const std::vector<std::string_view>& columnNames() {
+    static const std::vector<std::string> names = [] {
+        std::vector<std::string> result;
+        for (int i = 0; i < 4096; ++i) {
+            result.push_back("column_" + std::to_string(i));
+        }
+        return result;
+    }();
+    static const std::vector<std::string_view> views(names.begin(), names.end());
+    return views;
+}
+
+// SmallStorage has no fixed limits, so one config covers every size
+using Config = sql::CompactConfig;
+using Builder = sql::QueryBuilder<Config>;
+using Condition = sql::Condition<Config>;
+using Value = sql::SqlValue<Config>;
+
+} // namespace
+
+// SELECT list of N columns, rebuilt in a reused builder and string
+static void BM_ScaleColumns(benchmark::State& state) {
+    const auto columns = std::span(columnNames()).first(static_cast<size_t>(state.range(0)));
+    Builder builder;
+    std::string query;
+    BuildStats stats(state);
+
+    for (auto _ : state) {
+        query.clear();
+        auto result = builder.reset().select(columns).from("wide_table").buildInto(query);
+        benchmark::DoNotOptimize(result);
+        stats.built(query);
+    }
+}
+BENCHMARK(BM_ScaleColumns)->RangeMultiplier(4)->Range(1, 256);
+
+// N AND-ed column = value conditions
+static void BM_ScaleConditions(benchmark::State& state) {
+    const auto& names = columnNames();
+    const auto count = static_cast<size_t>(state.range(0));
+    Builder builder;
+    std::string query;
+    BuildStats stats(state);
+
+    for (auto _ : state) {
+        builder.reset().select("id").from("events");
+        for (size_t i = 0; i < count; ++i) {
+            builder.where(Condition(names[i], Condition::Op::Eq, Value(static_cast<int64_t>(i))));
+        }
+        query.clear();
+        auto result = builder.buildInto(query);
+        benchmark::DoNotOptimize(result);
+        stats.built(query);
+    }
+}
+BENCHMARK(BM_ScaleConditions)->RangeMultiplier(4)->Range(1, 256);
+
+// IN list of N ids; the second argument is the InStrategy (Inline, Bind,
+// JsonEach), which decides whether the text grows with N
+static void BM_ScaleInList(benchmark::State& state) {
+    std::vector<int64_t> ids(static_cast<size_t>(state.range(0)));
+    for (size_t i = 0; i < ids.size(); ++i) {
+        ids[i] = static_cast<int64_t>(i * 7 + 1);
+    }
+    const auto strategy = static_cast<sql::InStrategy>(state.range(1));
+    Builder builder;
+    std::string query;
+    BuildStats stats(state);
+
+    for (auto _ : state) {
+        query.clear();
+        auto result = builder.reset()
+                          .select("id", "name")
+                          .from("users")
+                          .whereIn("id", std::span<const int64_t>(ids), strategy)
+                          .buildInto(query);
+        benchmark::DoNotOptimize(result);
+        stats.built(query);
+    }
+}
+BENCHMARK(BM_ScaleInList)->ArgsProduct({
+    benchmark::CreateRange(8, 8192, 8),
+    {static_cast<int64_t>(sql::InStrategy::Inline), static_cast<int64_t>(sql::InStrategy::Bind),
+     static_cast<int64_t>(sql::InStrategy::JsonEach)}
+});
+
+// Chain of N IN subqueries, each level filtering the next one out
+static void BM_ScaleNesting(benchmark::State& state) {
+    const auto depth = static_cast<size_t>(state.range(0));
+    const auto& names = columnNames();
+    std::vector<Builder> levels(depth);
+    std::string query;
+    BuildStats stats(state);
+
+    for (auto _ : state) {
+        for (size_t i = 0; i < depth; ++i) {
+            levels[i].reset().select("parent_id").from(names[i]).where(Condition("depth", Condition::Op::Eq,
+                                                                               Value(static_cast<int64_t>(i))));
+            if (i > 0) {
+                levels[i].whereIn("id", std::cref(levels[i - 1]));
+            }
+        }
+        query.clear();
+        auto result = levels.back().buildInto(query);
+        benchmark::DoNotOptimize(result);
+        stats.built(query);
+    }
+}
+BENCHMARK(BM_ScaleNesting)->DenseRange(1, 8);
+
+// A typical listing query built on N threads at once, each with its own
+// builder: build cost should stay flat as threads are added
+static void BM_ScaleThreads(benchmark::State& state) {
+    const auto& names = columnNames();
+    Builder builder;
+    std::string query;
+    BuildStats stats(state);
+
+    for (auto _ : state) {
+        query.clear();
+        auto result = builder.reset()
+                          .select(names[0], names[1], names[2], names[3])
+                          .from("orders")
+                          .where(Condition(names[4], Condition::Op::Eq, Value(true)))
+                          .where(Condition(names[5], Condition::Op::Ge, Value("2024-01-01")))
+                          .orderBy(names[6], false)
+                          .limit(50)
+                          .buildInto(query);
+        benchmark::DoNotOptimize(result);
+        stats.built(query);
+    }
+}
+BENCHMARK(BM_ScaleThreads)->Threads(1)->Threads(2)->Threads(4)->Threads(8)->UseRealTime();
+
+// Compiled statements shared through one QueryCache by N threads
+static void BM_ScaleCachedThreads(benchmark::State& state) {
+    static sql::QueryCache<Config> cache;
+    const auto& names = columnNames();
+    Builder builder;
+    BuildStats stats(state);
+
+    for (auto _ : state) {
+        builder.reset()
+            .select(names[0], names[1])
+            .from("orders")
+            .where(Condition(names[2], Condition::Op::Eq, sql::ph<Config>(":id")))
+            .limit(1 + state.thread_index() % 4);
+        auto sql = cache.render(builder);
+        benchmark::DoNotOptimize(sql);
+        if (sql) stats.built(sql.value());
+    }
+}
+BENCHMARK(BM_ScaleCachedThreads)->Threads(1)->Threads(2)->Threads(4)->Threads(8)->UseRealTime();
+
+BENCHMARK_MAIN();
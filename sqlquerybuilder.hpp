@@ -1,18 +1,52 @@
 #pragma once
 
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
 #include <span>
 #include <string_view>
 #include <variant>
 #include <format>
 #include <type_traits>
+#include <concepts>
+#include <condition_variable>
+#include <coroutine>
 #include <cassert>
+#include <charconv>
 #include <optional>
 #include <cstdint>
+#include <cstring>
+#include <exception>
 #include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <numeric>
+#include <semaphore>
 #include <string>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+// Optional Qt support; Qt SQL integration implies the Qt types
+#ifdef SQLQUERYBUILDER_USE_QTSQL
+#ifndef SQLQUERYBUILDER_USE_QT
+#define SQLQUERYBUILDER_USE_QT
+#endif
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlRecord>
+#include <QVariant>
+#endif
 
-// Optional Qt support
 #ifdef SQLQUERYBUILDER_USE_QT
 #include <QDateTime>
 #include <QString>
@@ -48,6 +82,14 @@ inline constexpr std::string_view INTO = "INTO";
 inline constexpr std::string_view VALUES = "VALUES";
 inline constexpr std::string_view UPDATE = "UPDATE";
 inline constexpr std::string_view SET = "SET";
+inline constexpr std::string_view ON_CONFLICT = "ON CONFLICT";
+inline constexpr std::string_view DO_UPDATE_SET = "DO UPDATE SET";
+inline constexpr std::string_view DO_NOTHING = "DO NOTHING";
+inline constexpr std::string_view ON_DUPLICATE_KEY_UPDATE = "ON DUPLICATE KEY UPDATE";
+inline constexpr std::string_view CASE = "CASE";
+inline constexpr std::string_view WHEN = "WHEN";
+inline constexpr std::string_view THEN = "THEN";
+inline constexpr std::string_view END = "END";
 inline constexpr std::string_view DELETE = "DELETE";
 inline constexpr std::string_view TRUNCATE = "TRUNCATE TABLE";
 inline constexpr std::string_view COUNT = "COUNT";
@@ -67,6 +109,7 @@ inline constexpr std::string_view ASC = "ASC";
 inline constexpr std::string_view DESC = "DESC";
 inline constexpr std::string_view DISTINCT = "DISTINCT";
 inline constexpr std::string_view EXISTS = "EXISTS";
+inline constexpr std::string_view WITH = "WITH";
 inline constexpr std::string_view NULL_VALUE = "NULL";
 inline constexpr std::string_view TRUE_VALUE = "1";
 inline constexpr std::string_view FALSE_VALUE = "0";
@@ -76,6 +119,231 @@ inline constexpr std::string_view GROUP_CONCAT = "GROUP_CONCAT";
 
 // Configuration
 struct DefaultConfig {
+    static constexpr size_t MaxColumns = 32;
+    static constexpr size_t MaxConditions = 16;
+    static constexpr size_t MaxJoins = 4;
+    static constexpr size_t MaxOrderBy = 8;
+    static constexpr size_t MaxGroupBy = 8;
+    static constexpr size_t MaxInValues = 16;  // No longer a limit: IN lists live out of line
+    static constexpr bool ThrowOnError = false;
+};
+
+//=====================
+// Clause Storage
+//=====================
+
+// Fixed-capacity list stored inline: the default storage, never allocates
+template<typename T, size_t Capacity>
+class FixedVector {
+    std::array<T, Capacity> items_{};
+    size_t size_{0};
+
+public:
+    static constexpr bool bounded = true;
+
+    void push_back(const T& item) { items_[size_++] = item; }
+    void push_back(T&& item) { items_[size_++] = std::move(item); }
+    void clear() { size_ = 0; }
+
+    // Whether `count` more items fit
+    [[nodiscard]] bool hasRoom(size_t count = 1) const { return size_ + count <= Capacity; }
+    [[nodiscard]] static constexpr size_t capacity() { return Capacity; }
+
+    [[nodiscard]] size_t size() const { return size_; }
+    [[nodiscard]] bool empty() const { return size_ == 0; }
+    T& operator[](size_t index) { return items_[index]; }
+    const T& operator[](size_t index) const { return items_[index]; }
+    T& back() { return items_[size_ - 1]; }
+    const T& back() const { return items_[size_ - 1]; }
+
+    T* begin() { return items_.data(); }
+    T* end() { return items_.data() + size_; }
+    const T* begin() const { return items_.data(); }
+    const T* end() const { return items_.data() + size_; }
+};
+
+// Keeps the first `Inline` items in place and moves to the heap past that,
+// with no upper limit on the number of items
+template<typename T, size_t Inline, typename Allocator = std::allocator<T>>
+class SmallVector {
+    static_assert(Inline > 0, "SmallVector needs at least one inline slot");
+    using Traits = std::allocator_traits<Allocator>;
+
+    alignas(T) unsigned char inline_[sizeof(T) * Inline];
+    T* data_;
+    size_t size_{0};
+    size_t capacity_{Inline};
+    [[no_unique_address]] Allocator allocator_;
+
+    [[nodiscard]] T* inlineData() { return std::launder(reinterpret_cast<T*>(inline_)); }
+    [[nodiscard]] bool isInline() const { return capacity_ == Inline; }
+
+    void grow(size_t minimum) {
+        const size_t capacity = std::max(minimum, capacity_ * 2);
+        T* data = Traits::allocate(allocator_, capacity);
+        for (size_t i = 0; i < size_; ++i) {
+            ::new (static_cast<void*>(data + i)) T(std::move_if_noexcept(data_[i]));
+            data_[i].~T();
+        }
+        release();
+        data_ = data;
+        capacity_ = capacity;
+    }
+
+    void release() {
+        if (!isInline()) {
+            Traits::deallocate(allocator_, data_, capacity_);
+            data_ = inlineData();
+            capacity_ = Inline;
+        }
+    }
+
+public:
+    static constexpr bool bounded = false;
+
+    explicit SmallVector(const Allocator& allocator = Allocator())
+        : data_(inlineData()), allocator_(allocator) {}
+
+    SmallVector(const SmallVector& other)
+        : data_(inlineData()), allocator_(Traits::select_on_container_copy_construction(other.allocator_)) {
+        reserve(other.size_);
+        for (const auto& item : other) {
+            push_back(item);
+        }
+    }
+
+    SmallVector(SmallVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>)
+        : data_(inlineData()), allocator_(std::move(other.allocator_)) {
+        takeFrom(other);
+    }
+
+    SmallVector& operator=(const SmallVector& other) {
+        if (this != &other) {
+            clear();
+            reserve(other.size_);
+            for (const auto& item : other) {
+                push_back(item);
+            }
+        }
+        return *this;
+    }
+
+    SmallVector& operator=(SmallVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>) {
+        if (this != &other) {
+            clear();
+            release();
+            takeFrom(other);
+        }
+        return *this;
+    }
+
+    ~SmallVector() {
+        clear();
+        release();
+    }
+
+    void push_back(const T& item) {
+        if (size_ == capacity_) {
+            T copy(item);  // `item` may live in this vector
+            grow(size_ + 1);
+            ::new (static_cast<void*>(data_ + size_)) T(std::move(copy));
+        } else {
+            ::new (static_cast<void*>(data_ + size_)) T(item);
+        }
+        ++size_;
+    }
+
+    void push_back(T&& item) {
+        if (size_ == capacity_) {
+            T moved(std::move(item));
+            grow(size_ + 1);
+            ::new (static_cast<void*>(data_ + size_)) T(std::move(moved));
+        } else {
+            ::new (static_cast<void*>(data_ + size_)) T(std::move(item));
+        }
+        ++size_;
+    }
+
+    void reserve(size_t capacity) {
+        if (capacity > capacity_) {
+            grow(capacity);
+        }
+    }
+
+    // Destroys the items but keeps any heap buffer for reuse
+    void clear() {
+        for (size_t i = 0; i < size_; ++i) {
+            data_[i].~T();
+        }
+        size_ = 0;
+    }
+
+    [[nodiscard]] bool hasRoom(size_t = 1) const { return true; }
+    [[nodiscard]] size_t capacity() const { return capacity_; }
+    [[nodiscard]] bool spilled() const { return !isInline(); }
+
+    [[nodiscard]] size_t size() const { return size_; }
+    [[nodiscard]] bool empty() const { return size_ == 0; }
+    T& operator[](size_t index) { return data_[index]; }
+    const T& operator[](size_t index) const { return data_[index]; }
+    T& back() { return data_[size_ - 1]; }
+    const T& back() const { return data_[size_ - 1]; }
+
+    T* begin() { return data_; }
+    T* end() { return data_ + size_; }
+    const T* begin() const { return data_; }
+    const T* end() const { return data_ + size_; }
+
+private:
+    void takeFrom(SmallVector& other) {
+        if (!other.isInline()) {
+            data_ = other.data_;
+            size_ = other.size_;
+            capacity_ = other.capacity_;
+            other.data_ = other.inlineData();
+            other.size_ = 0;
+            other.capacity_ = Inline;
+            return;
+        }
+        for (size_t i = 0; i < other.size_; ++i) {
+            ::new (static_cast<void*>(data_ + i)) T(std::move(other.data_[i]));
+        }
+        size_ = other.size_;
+        other.clear();
+    }
+};
+
+// Storage policies, selected with `using Storage = ...` in a Config. Config::Max*
+// are hard limits under FixedStorage and are ignored under SmallStorage.
+struct FixedStorage {
+    template<typename T, size_t Max>
+    using type = FixedVector<T, Max>;
+};
+
+template<size_t Inline, template<typename> class Allocator = std::allocator>
+struct SmallStorage {
+    template<typename T, size_t Max>
+    using type = SmallVector<T, Inline, Allocator<T>>;
+};
+
+template<typename Config>
+struct config_storage {
+    using type = FixedStorage;
+};
+
+template<typename Config>
+    requires requires { typename Config::Storage; }
+struct config_storage<Config> {
+    using type = typename Config::Storage;
+};
+
+// Container for one clause list of a builder using `Config`
+template<typename Config, typename T, size_t Max>
+using ClauseList = typename config_storage<Config>::type::template type<T, Max>;
+
+// Small builders for typical queries: a few items of each clause inline,
+// spilling to the heap for large reporting queries instead of failing
+struct CompactConfig {
     static constexpr size_t MaxColumns = 32;
     static constexpr size_t MaxConditions = 16;
     static constexpr size_t MaxJoins = 4;
@@ -83,6 +351,7 @@ struct DefaultConfig {
     static constexpr size_t MaxGroupBy = 8;
     static constexpr size_t MaxInValues = 16;
     static constexpr bool ThrowOnError = false;
+    using Storage = SmallStorage<4>;
 };
 
 // Error handling
@@ -97,18 +366,31 @@ struct QueryError {
         InvalidCondition,
         TooManyOrderBy,
         TooManyGroupBy,
-        InvalidOperation
+        InvalidOperation,
+        BufferOverflow,
+        DatabaseError
     };
 
     Code code{Code::None};
     std::string_view message;
 
     QueryError() = default;
-    QueryError(Code c, std::string_view msg) : code(c), message(msg) {}
+    constexpr QueryError(Code c, std::string_view msg) : code(c), message(msg) {}
 
     explicit operator bool() const { return code != Code::None; }
 };
 
+namespace detail {
+// QueryError only views its message, so formatted messages are kept here
+// for the lifetime of the program. Error paths only, with few distinct texts.
+inline std::string_view keepMessage(std::string message) {
+    static std::mutex mutex;
+    static std::unordered_set<std::string> messages;
+    std::lock_guard lock(mutex);
+    return *messages.insert(std::move(message)).first;
+}
+} // namespace detail
+
 template<typename T>
 class Result {
     std::variant<T, QueryError> value_;
@@ -119,7 +401,9 @@ public:
 
     bool hasError() const { return std::holds_alternative<QueryError>(value_); }
     const QueryError& error() const { return std::get<QueryError>(value_); }
-    const T& value() const { return std::get<T>(value_); }
+    const T& value() const& { return std::get<T>(value_); }
+    T& value() & { return std::get<T>(value_); }
+    T&& value() && { return std::get<T>(std::move(value_)); }
 
     explicit operator bool() const { return !hasError(); }
 };
@@ -171,809 +455,1323 @@ struct is_sql_compatible<QDateTime> : std::true_type {};
 template<typename T>
 concept SqlCompatible = is_sql_compatible<std::remove_cvref_t<T>>::value;
 
-// Forward declarations
-template<typename Config = DefaultConfig>
-class SqlValue;
+// Placeholder styles understood by the builder
+enum class PlaceholderStyle : uint8_t {
+    QuestionMark,  // ?
+    Dollar,        // $1, $2, etc.
+    Colon,         // :name
+    At             // @name
+};
 
-template<typename Config = DefaultConfig>
-class ConditionBase;
+// How an IN list over a span is rendered
+enum class InStrategy : uint8_t {
+    Inline,    // column IN (1, 2, 3)
+    Bind,      // column IN (?, ?, ?), one bind slot per value
+    JsonEach,  // column IN (SELECT value FROM json_each(?)), one JSON array parameter (SQLite)
+    AnyArray   // column = ANY(?), one array literal parameter (PostgreSQL)
+};
 
-template<typename Config = DefaultConfig>
-class Condition;
+// Position of a placeholder inside compiled SQL text
+struct BindSlot {
+    std::string name;   // Placeholder token as written (e.g. ":id"), empty for "?"
+    PlaceholderStyle style{PlaceholderStyle::QuestionMark};
+    size_t offset{0};   // Byte offset of the token in the SQL text
+    size_t length{0};   // Byte length of the token
+};
 
-template<typename Config = DefaultConfig>
-class Column;
+// Collects bind slots while a query is compiled. With `bind_literals` set,
+// literal values are emitted as "?" and get a slot as well.
+struct BindCollector {
+    std::vector<BindSlot> slots;
+    bool bind_literals{false};
+    uint32_t positional{0};  // Positional markers so far, for numbered ($n) dialects
+};
 
-template<typename Config = DefaultConfig>
-class AliasedTable;
+// How INSERT ... with a conflicting key becomes an update
+enum class UpsertSyntax : uint8_t {
+    OnConflict,     // INSERT ... ON CONFLICT (key) DO UPDATE SET ...
+    OnDuplicateKey  // INSERT ... ON DUPLICATE KEY UPDATE ...
+};
 
-template<typename Config = DefaultConfig>
-class Placeholder;
+// How BatchUpdate matches its rows to the table
+enum class BulkUpdateSyntax : uint8_t {
+    FromValues,         // UPDATE t SET a = v.a FROM (VALUES ...) AS v(id, a) WHERE t.id = v.id
+    FromValuesNumbered, // The same with unnamed VALUES columns: v.column1, v.column2, ...
+    Case                // UPDATE t SET a = CASE id WHEN 1 THEN ... END WHERE id IN (...)
+};
 
-// Table class with config awareness
-template<typename Config = DefaultConfig>
-class Table {
-private:
-    std::string_view name_;
+// How useIndex() pins a table to an index
+enum class IndexHintSyntax : uint8_t {
+    IndexedBy,      // FROM t INDEXED BY idx
+    UseIndex,       // FROM t USE INDEX (idx)
+    PlannerComment  // /*+ IndexScan(t idx) */ SELECT ..., read by the pg_hint_plan extension
+};
 
-public:
-    constexpr explicit Table(std::string_view name) : name_(name) {}
+// What the dialect's EXPLAIN returns, for parsePlan()
+enum class PlanFormat : uint8_t {
+    QueryPlanRows,  // (id, parent, notused, detail) rows, one per step
+    IndentedText,   // One line per row; child steps start with "->", details are indented under them
+    Tree            // A single cell of lines, every step starting with "->"
+};
 
-    [[nodiscard]] constexpr std::string_view name() const { return name_; }
+// Plan shows the planner's choice; Analyze also runs the statement and
+// reports the actual row counts
+enum class ExplainMode : uint8_t { Plan, Analyze };
+
+// SQL dialects, selected with `using Dialect = ...` in a Config. Spellings
+// are constants, so the builder picks them at compile time. SqliteDialect is
+// the default and renders what the builder always has.
+struct SqliteDialect {
+    static constexpr std::string_view true_value = "1";
+    static constexpr std::string_view false_value = "0";
+    static constexpr std::string_view insert_or_replace = "INSERT OR REPLACE";
+    static constexpr std::string_view truncate = "TRUNCATE TABLE";
+    static constexpr std::string_view offset_without_limit = "LIMIT -1";  // OFFSET needs a LIMIT
+    static constexpr PlaceholderStyle positional = PlaceholderStyle::QuestionMark;
+    static constexpr char identifier_quote = '"';
+    static constexpr UpsertSyntax upsert = UpsertSyntax::OnConflict;
+    static constexpr BulkUpdateSyntax bulk_update = BulkUpdateSyntax::FromValuesNumbered;  // SQLite 3.33+
+    static constexpr bool row_values = true;  // (a, b) > (x, y); SQLite 3.15+
+    static constexpr IndexHintSyntax index_hint = IndexHintSyntax::IndexedBy;
+    static constexpr std::string_view explain = "EXPLAIN QUERY PLAN";
+    static constexpr std::string_view explain_analyze = "";  // No equivalent
+    static constexpr PlanFormat plan_format = PlanFormat::QueryPlanRows;
+    static constexpr size_t max_parameters = 32766;  // SQLITE_MAX_VARIABLE_NUMBER since 3.32; 999 before
+};
 
-    operator std::string_view() const { return name_; }
+struct PostgresDialect {
+    static constexpr std::string_view true_value = "TRUE";
+    static constexpr std::string_view false_value = "FALSE";
+    static constexpr std::string_view insert_or_replace = "";  // No equivalent; use an upsert
+    static constexpr std::string_view truncate = "TRUNCATE TABLE";
+    static constexpr std::string_view offset_without_limit = "";
+    static constexpr PlaceholderStyle positional = PlaceholderStyle::Dollar;  // $1, $2, ...
+    static constexpr char identifier_quote = '"';
+    static constexpr UpsertSyntax upsert = UpsertSyntax::OnConflict;
+    static constexpr BulkUpdateSyntax bulk_update = BulkUpdateSyntax::FromValues;
+    static constexpr bool row_values = true;
+    static constexpr IndexHintSyntax index_hint = IndexHintSyntax::PlannerComment;
+    static constexpr std::string_view explain = "EXPLAIN";
+    static constexpr std::string_view explain_analyze = "EXPLAIN ANALYZE";
+    static constexpr PlanFormat plan_format = PlanFormat::IndentedText;
+    static constexpr size_t max_parameters = 65535;  // Bind message parameter count is 16-bit
+};
 
-    [[nodiscard]] AliasedTable<Config> as(std::string_view alias) const;
+struct MySqlDialect {
+    static constexpr std::string_view true_value = "TRUE";
+    static constexpr std::string_view false_value = "FALSE";
+    static constexpr std::string_view insert_or_replace = "REPLACE";
+    static constexpr std::string_view truncate = "TRUNCATE TABLE";
+    static constexpr std::string_view offset_without_limit = "LIMIT 18446744073709551615";
+    static constexpr PlaceholderStyle positional = PlaceholderStyle::QuestionMark;
+    static constexpr char identifier_quote = '`';
+    static constexpr UpsertSyntax upsert = UpsertSyntax::OnDuplicateKey;
+    static constexpr BulkUpdateSyntax bulk_update = BulkUpdateSyntax::Case;
+    static constexpr bool row_values = true;
+    static constexpr IndexHintSyntax index_hint = IndexHintSyntax::UseIndex;
+    static constexpr std::string_view explain = "EXPLAIN FORMAT=TREE";  // MySQL 8.0.16+
+    static constexpr std::string_view explain_analyze = "EXPLAIN ANALYZE";
+    static constexpr PlanFormat plan_format = PlanFormat::Tree;
+    static constexpr size_t max_parameters = 65535;  // Prepared statement placeholders
 };
 
-// AliasedTable for better join handling
 template<typename Config>
-class AliasedTable {
-private:
-    std::string_view table_;
-    std::string_view alias_;
-
-public:
-    constexpr AliasedTable(std::string_view table, std::string_view alias)
-        : table_(table), alias_(alias) {}
-
-    [[nodiscard]] constexpr std::string_view tableName() const { return table_; }
-    [[nodiscard]] constexpr std::string_view alias() const { return alias_; }
-
-    [[nodiscard]] std::string toString() const {
-        return std::string(table_) + " " + std::string(alias_);
-    }
+struct config_dialect {
+    using type = SqliteDialect;
+};
 
-    operator std::string() const { return toString(); }
+template<typename Config>
+    requires requires { typename Config::Dialect; }
+struct config_dialect<Config> {
+    using type = typename Config::Dialect;
 };
 
-// Implementation of Table::as
 template<typename Config>
-AliasedTable<Config> Table<Config>::as(std::string_view alias) const {
-    return AliasedTable<Config>(name_, alias);
-}
+using DialectOf = typename config_dialect<Config>::type;
 
-// TypedColumn class with config awareness
-template<typename T, typename Config = DefaultConfig>
-class TypedColumn {
-private:
-    std::string_view table_;
-    std::string_view name_;
-    std::string_view alias_; // Optional column alias
+//=====================
+// Query Plans
+//=====================
 
-public:
-    using value_type = T;
-    using config_type = Config;
+// One step of a query plan, parsed from the dialect's EXPLAIN output
+struct PlanStep {
+    std::string detail;      // The step as reported, without tree markers or costs
+    std::string table;       // Table (or alias) the step reads, if any
+    std::string index;       // Index it reads through, if any
+    int32_t parent{-1};      // Enclosing step in QueryPlan::steps, -1 at the top
+    bool full_scan{false};   // Reads every row of `table`, through `index` if set
+    double cost{-1};         // Estimated total cost; -1 when not reported, as on SQLite
+    double rows{-1};         // Estimated rows
+    double actual_rows{-1};  // Rows produced per loop, from ExplainMode::Analyze
+    std::vector<std::string> properties;  // Lines such as "Filter: (active = 1)"
+};
 
-    constexpr TypedColumn(std::string_view table, std::string_view name)
-        : table_(table), name_(name), alias_() {}
+struct QueryPlan {
+    std::vector<PlanStep> steps;  // In output order, parents before their children
 
-    // Constructor that includes column alias
-    constexpr TypedColumn(std::string_view table, std::string_view name, std::string_view alias)
-        : table_(table), name_(name), alias_(alias) {}
+    [[nodiscard]] bool empty() const { return steps.empty(); }
 
-    [[nodiscard]] constexpr std::string_view tableName() const { return table_; }
-    [[nodiscard]] constexpr std::string_view name() const { return name_; }
-    [[nodiscard]] constexpr std::string_view alias() const { return alias_; }
+    [[nodiscard]] bool hasFullScan() const {
+        return std::ranges::any_of(steps, [](const PlanStep& step) { return step.full_scan; });
+    }
 
-    [[nodiscard]] std::string qualifiedName() const {
-        if (table_.empty()) {
-            return std::string(name_);
+    // Tables read in full, in plan order
+    [[nodiscard]] std::vector<std::string_view> fullScans() const {
+        std::vector<std::string_view> tables;
+        for (const auto& step : steps) {
+            if (step.full_scan) tables.push_back(step.table);
         }
-        return std::string(table_) + "." + std::string(name_);
+        return tables;
     }
+};
 
-    [[nodiscard]] TypedColumn<T, Config> as(std::string_view alias) const {
-        return TypedColumn<T, Config>(table_, name_, alias);
-    }
+// One row of EXPLAIN output. SQLite reports the id of each step and of its
+// parent; the other dialects report lines of text, nested by indentation,
+// and leave both 0. A row may hold several lines.
+struct PlanRow {
+    int64_t id{0};
+    int64_t parent{0};
+    std::string_view detail;
+};
 
-    operator std::string_view() const { return name_; }
+namespace detail {
+inline std::string_view trimPlanText(std::string_view text) {
+    const auto first = text.find_first_not_of(" \t\r");
+    if (first == std::string_view::npos) return {};
+    return text.substr(first, text.find_last_not_of(" \t\r") - first + 1);
+}
 
-    // Condition generators
-    [[nodiscard]] Condition<Config> isNull() const;
-    [[nodiscard]] Condition<Config> isNotNull() const;
+// The word following `marker`, e.g. the table after " on "
+inline std::string_view planWordAfter(std::string_view text, std::string_view marker) {
+    const auto at = text.find(marker);
+    if (at == std::string_view::npos) return {};
+    const auto rest = text.substr(at + marker.size());
+    return rest.substr(0, rest.find_first_of(" (\t"));
+}
 
-    template<SqlCompatible U>
-    [[nodiscard]] Condition<Config> eq(U&& value) const;
+// The number following `key` inside the "(...)" group starting at `group`;
+// for a range such as cost=0.00..35.50, its end. -1 if absent.
+inline double planNumber(std::string_view text, std::string_view group, std::string_view key) {
+    const auto start = text.find(group);
+    if (start == std::string_view::npos) return -1;
+    auto section = text.substr(start);
+    section = section.substr(0, section.find(')'));
+    const auto at = section.find(key);
+    if (at == std::string_view::npos) return -1;
+    auto rest = section.substr(at + key.size());
+    const auto range = rest.find("..");
+    if (range != std::string_view::npos && range < rest.find(' ')) rest = rest.substr(range + 2);
+    double value = -1;
+    std::from_chars(rest.data(), rest.data() + rest.size(), value);
+    return value;
+}
 
-    template<typename OtherType, typename OtherConfig>
-    [[nodiscard]] Condition<Config> eq(const TypedColumn<OtherType, OtherConfig>& other) const;
+// Fill in what one step reads from its text, which has no tree markers
+template<typename Dialect>
+void classifyPlanStep(PlanStep& step, std::string_view text) {
+    const auto costs = std::min(text.find(" (cost="), text.find(" (actual "));
+    const auto head = trimPlanText(text.substr(0, costs));
+    step.detail = head;
+    step.cost = planNumber(text, "(cost=", "cost=");
+    step.rows = planNumber(text, "(cost=", "rows=");
+    step.actual_rows = planNumber(text, "(actual ", "rows=");
+
+    if constexpr(Dialect::plan_format == PlanFormat::QueryPlanRows) {
+        // SCAN users, SCAN TABLE users AS u, SEARCH u USING INDEX idx (email=?)
+        const bool scan = head.starts_with("SCAN ");
+        if (!scan && !head.starts_with("SEARCH ")) return;
+        auto rest = head.substr(head.find(' ') + 1);
+        if (rest.starts_with("TABLE ")) rest.remove_prefix(6);
+        if (rest.starts_with("(") || rest.starts_with("CONSTANT ROW")) return;  // Subquery results
+        step.table = rest.substr(0, rest.find(' '));
+        step.index = planWordAfter(rest, " INDEX ");
+        if (step.index.empty() && rest.find(" PRIMARY KEY") != std::string_view::npos) step.index = "PRIMARY KEY";
+        step.full_scan = scan;
+    } else if constexpr(Dialect::plan_format == PlanFormat::IndentedText) {
+        // Seq Scan on users u, Index Scan using idx on users, Bitmap Index Scan on idx
+        if (head.starts_with("Bitmap Index Scan")) {
+            step.index = planWordAfter(head, " on ");
+            return;
+        }
+        step.table = planWordAfter(head, " on ");
+        step.index = planWordAfter(head, " using ");
+        step.full_scan = head.find("Seq Scan") != std::string_view::npos;
+    } else {
+        // Table scan on users, Index lookup on u using idx (email='x'), Index scan on u using idx
+        step.table = planWordAfter(head, " on ");
+        step.index = planWordAfter(head, " using ");
+        step.full_scan = (head.starts_with("Table scan") && !step.table.starts_with("<")) ||
+                         head.starts_with("Index scan");
+    }
+}
 
-    template<SqlCompatible U>
-    [[nodiscard]] Condition<Config> ne(U&& value) const;
+// Builds the steps of text plans, finding each step's parent from its
+// indentation: a step is nested under the last one whose text starts left
+// of its marker, and a detail line belongs to the last step whose text
+// starts left of the detail.
+template<typename Dialect>
+class PlanTextParser {
+private:
+    struct Open {
+        size_t content;  // Column the step's text starts at
+        int32_t step;
+    };
 
-    template<typename OtherType, typename OtherConfig>
-    [[nodiscard]] Condition<Config> ne(const TypedColumn<OtherType, OtherConfig>& other) const;
+    QueryPlan& plan_;
+    std::vector<Open> open_;
 
-    template<SqlCompatible U>
-    [[nodiscard]] Condition<Config> lt(U&& value) const;
+public:
+    explicit PlanTextParser(QueryPlan& plan) : plan_(plan) {}
+
+    void lines(std::string_view text) {
+        while (!text.empty()) {
+            const auto end = text.find('\n');
+            line(text.substr(0, end));
+            if (end == std::string_view::npos) break;
+            text.remove_prefix(end + 1);
+        }
+    }
 
-    template<typename OtherType, typename OtherConfig>
-    [[nodiscard]] Condition<Config> lt(const TypedColumn<OtherType, OtherConfig>& other) const;
+    void line(std::string_view line) {
+        const auto indent = line.find_first_not_of(' ');
+        if (indent == std::string_view::npos || trimPlanText(line).empty()) return;
+
+        size_t marker = indent;
+        size_t content = indent;
+        bool node = plan_.steps.empty();
+        if constexpr(Dialect::plan_format == PlanFormat::QueryPlanRows) {
+            // Shell output: "QUERY PLAN", then "|--SCAN a", "|  `--SEARCH b ..."
+            if (trimPlanText(line) == "QUERY PLAN") return;
+            const auto dashes = line.find("--");
+            if (dashes != std::string_view::npos && dashes > 0 && (line[dashes - 1] == '|' || line[dashes - 1] == '`')) {
+                marker = dashes - 1;
+                content = dashes + 2;
+            }
+            node = true;
+        } else if (line.compare(indent, 2, "->") == 0) {
+            marker = indent;
+            content = line.find_first_not_of(' ', indent + 2);
+            node = true;
+        }
 
-    template<SqlCompatible U>
-    [[nodiscard]] Condition<Config> le(U&& value) const;
+        if (!node) {
+            while (!open_.empty() && open_.back().content >= indent) open_.pop_back();
+            auto& owner = plan_.steps[open_.empty() ? 0 : static_cast<size_t>(open_.back().step)];
+            owner.properties.emplace_back(trimPlanText(line));
+            return;
+        }
 
-    template<typename OtherType, typename OtherConfig>
-    [[nodiscard]] Condition<Config> le(const TypedColumn<OtherType, OtherConfig>& other) const;
+        while (!open_.empty() && open_.back().content > marker) open_.pop_back();
+        PlanStep step;
+        step.parent = open_.empty() ? -1 : open_.back().step;
+        classifyPlanStep<Dialect>(step, line.substr(std::min(content, line.size())));
+        plan_.steps.push_back(std::move(step));
+        open_.push_back({content, static_cast<int32_t>(plan_.steps.size() - 1)});
+    }
+};
+} // namespace detail
 
-    template<SqlCompatible U>
-    [[nodiscard]] Condition<Config> gt(U&& value) const;
+// Parse EXPLAIN output of Config's dialect, as read from the driver
+template<typename Config = DefaultConfig>
+[[nodiscard]] QueryPlan parsePlan(std::span<const PlanRow> rows) {
+    using Dialect = DialectOf<Config>;
+    QueryPlan plan;
+    if constexpr(Dialect::plan_format == PlanFormat::QueryPlanRows) {
+        std::unordered_map<int64_t, int32_t> steps;
+        for (const auto& row : rows) {
+            PlanStep step;
+            const auto parent = steps.find(row.parent);
+            step.parent = row.parent != 0 && parent != steps.end() ? parent->second : -1;
+            detail::classifyPlanStep<Dialect>(step, detail::trimPlanText(row.detail));
+            plan.steps.push_back(std::move(step));
+            steps[row.id] = static_cast<int32_t>(plan.steps.size() - 1);
+        }
+    } else {
+        detail::PlanTextParser<Dialect> parser(plan);
+        for (const auto& row : rows) parser.lines(row.detail);
+    }
+    return plan;
+}
 
-    template<typename OtherType, typename OtherConfig>
-    [[nodiscard]] Condition<Config> gt(const TypedColumn<OtherType, OtherConfig>& other) const;
+// Parse a plan as printed by the database's console, one step per line
+template<typename Config = DefaultConfig>
+[[nodiscard]] QueryPlan parsePlan(std::string_view text) {
+    QueryPlan plan;
+    detail::PlanTextParser<DialectOf<Config>> parser(plan);
+    parser.lines(text);
+    return plan;
+}
 
-    template<SqlCompatible U>
-    [[nodiscard]] Condition<Config> ge(U&& value) const;
+// A plan captured for a statement, as reported to a Config::Observer
+struct PlanEvent {
+    std::string_view sql;    // The statement explained, without the EXPLAIN prefix
+    const QueryPlan& plan;
+    ExplainMode mode{ExplainMode::Plan};
+};
 
-    template<typename OtherType, typename OtherConfig>
-    [[nodiscard]] Condition<Config> ge(const TypedColumn<OtherType, OtherConfig>& other) const;
+// One rendered statement, as reported to a Config::Observer
+struct BuildEvent {
+    std::string_view statement;  // "SELECT", "INSERT", ...
+    std::string_view sql;        // The rendered text, when the sink exposes data(); empty on error
+    size_t bytes{0};             // Length of the rendered text
+    size_t reserved{0};          // estimateSize() reserved for it by build(), 0 for caller sinks
+    std::chrono::nanoseconds elapsed{0};
+    QueryError::Code error{QueryError::Code::None};
+    uint16_t columns{0};         // Selected columns, or values of an INSERT/UPDATE
+    uint16_t conditions{0};      // Top-level WHERE conditions
+    uint16_t joins{0};
+    uint16_t order_by{0};
+    uint16_t group_by{0};
+    uint16_t subqueries{0};      // Nested builders: CTEs, derived tables, subqueries
+};
 
-    [[nodiscard]] Condition<Config> like(std::string_view pattern) const;
-    [[nodiscard]] Condition<Config> notLike(std::string_view pattern) const;
+// Observers receive builder events through static functions, selected with
+// `using Observer = ...` in a Config. Derive from NullObserver to handle only
+// some events. With NullObserver itself, the default, the hooks and their
+// timing are compiled out.
+struct NullObserver {
+    // After each build(), buildInto(), compile() and so on, failed or not.
+    // Not called for measure() or for nested builders.
+    static void onBuild(const BuildEvent&) {}
+
+    // For each error a builder records, at the call that caused it or
+    // while rendering
+    static void onError(const QueryError&) {}
+
+    // For each plan captured by PreparedStatements::explain(), or by a plan
+    // audit when a statement is first prepared (Qt SQL)
+    static void onPlan(const PlanEvent&) {}
+};
 
-    template<SqlCompatible T1, SqlCompatible T2>
-    [[nodiscard]] Condition<Config> between(T1&& start, T2&& end) const;
+template<typename Config>
+struct config_observer {
+    using type = NullObserver;
+};
 
-    template<typename U>
-    [[nodiscard]] Condition<Config> in(std::span<const U> values) const;
+template<typename Config>
+    requires requires { typename Config::Observer; }
+struct config_observer<Config> {
+    using type = typename Config::Observer;
+};
 
-    template<typename U>
-    [[nodiscard]] Condition<Config> notIn(std::span<const U> values) const;
+template<typename Config>
+using ObserverOf = typename config_observer<Config>::type;
 
-    [[nodiscard]] Condition<Config> eq(const SqlValue<Config>& value) const {
-        using Op = typename ConditionBase<Config>::Op;
-        return Condition<Config>(name_, Op::Eq, value);
+template<typename Config>
+inline constexpr bool is_observed = !std::is_same_v<ObserverOf<Config>, NullObserver>;
+
+// Observer that aggregates events into per-thread counters: a thread only
+// writes its own slot, with plain relaxed stores, and snapshot() sums the
+// slots of all threads. Use a distinct `Tag` for each independent set of
+// metrics. Histograms bucket by powers of two: latency bucket i counts
+// builds under 2^(i + 8) ns (the first under 256 ns, the last everything
+// slower), size bucket i builds under 2^(i + 6) bytes.
+template<typename Tag = void>
+class BuildMetrics : public NullObserver {
+public:
+    static constexpr size_t Buckets = 16;
+    static constexpr size_t ErrorCodes = static_cast<size_t>(QueryError::Code::DatabaseError) + 1;
+
+    struct Snapshot {
+        uint64_t builds{0};
+        uint64_t failures{0};
+        uint64_t bytes{0};
+        uint64_t nanoseconds{0};
+        uint64_t reserved{0};         // Bytes reserved from estimateSize(), for builds that reserve
+        uint64_t reserved_used{0};    // Bytes those builds actually produced
+        uint64_t underestimated{0};   // Builds that outgrew their reservation
+        uint64_t plans{0};            // Plans captured, see onPlan()
+        uint64_t full_scans{0};       // Plans that read a table in full
+        std::array<uint64_t, Buckets> latency{};
+        std::array<uint64_t, Buckets> size{};
+        std::array<uint64_t, ErrorCodes> errors{};  // By QueryError::Code
+    };
+
+    static void onBuild(const BuildEvent& event) {
+        Slot& slot = local();
+        const auto ns = static_cast<uint64_t>(event.elapsed.count());
+        bump(slot.builds);
+        bump(slot.nanoseconds, ns);
+        bump(slot.latency[bucket(ns, 8)]);
+        if (event.error != QueryError::Code::None) {
+            bump(slot.failures);
+            return;
+        }
+        bump(slot.bytes, event.bytes);
+        bump(slot.size[bucket(event.bytes, 6)]);
+        if (event.reserved > 0) {
+            bump(slot.reserved, event.reserved);
+            bump(slot.reserved_used, event.bytes);
+            if (event.bytes > event.reserved) bump(slot.underestimated);
+        }
     }
 
-    [[nodiscard]] Condition<Config> ne(const SqlValue<Config>& value) const {
-        using Op = typename ConditionBase<Config>::Op;
-        return Condition<Config>(name_, Op::Ne, value);
+    static void onError(const QueryError& error) {
+        const auto code = static_cast<size_t>(error.code);
+        if (code < ErrorCodes) bump(local().errors[code]);
     }
 
-    [[nodiscard]] Condition<Config> lt(const SqlValue<Config>& value) const {
-        using Op = typename ConditionBase<Config>::Op;
-        return Condition<Config>(name_, Op::Lt, value);
+    static void onPlan(const PlanEvent& event) {
+        Slot& slot = local();
+        bump(slot.plans);
+        if (event.plan.hasFullScan()) bump(slot.full_scans);
     }
 
-    [[nodiscard]] Condition<Config> le(const SqlValue<Config>& value) const {
-        using Op = typename ConditionBase<Config>::Op;
-        return Condition<Config>(name_, Op::Le, value);
+    // Totals over all threads so far. Counts of a thread still building may
+    // be a few events behind.
+    [[nodiscard]] static Snapshot snapshot() {
+        Snapshot total;
+        std::lock_guard lock(registry().mutex);
+        for (const auto& slot : registry().slots) {
+            total.builds += slot->builds.load(std::memory_order_relaxed);
+            total.failures += slot->failures.load(std::memory_order_relaxed);
+            total.bytes += slot->bytes.load(std::memory_order_relaxed);
+            total.nanoseconds += slot->nanoseconds.load(std::memory_order_relaxed);
+            total.reserved += slot->reserved.load(std::memory_order_relaxed);
+            total.reserved_used += slot->reserved_used.load(std::memory_order_relaxed);
+            total.underestimated += slot->underestimated.load(std::memory_order_relaxed);
+            total.plans += slot->plans.load(std::memory_order_relaxed);
+            total.full_scans += slot->full_scans.load(std::memory_order_relaxed);
+            for (size_t i = 0; i < Buckets; ++i) {
+                total.latency[i] += slot->latency[i].load(std::memory_order_relaxed);
+                total.size[i] += slot->size[i].load(std::memory_order_relaxed);
+            }
+            for (size_t i = 0; i < ErrorCodes; ++i) {
+                total.errors[i] += slot->errors[i].load(std::memory_order_relaxed);
+            }
+        }
+        return total;
     }
 
-    [[nodiscard]] Condition<Config> gt(const SqlValue<Config>& value) const {
-        using Op = typename ConditionBase<Config>::Op;
-        return Condition<Config>(name_, Op::Gt, value);
+private:
+    using Counter = std::atomic<uint64_t>;
+
+    // Written by one thread only; cache-line aligned so threads do not share lines
+    struct alignas(64) Slot {
+        Counter builds{0}, failures{0}, bytes{0}, nanoseconds{0};
+        Counter reserved{0}, reserved_used{0}, underestimated{0};
+        Counter plans{0}, full_scans{0};
+        std::array<Counter, Buckets> latency{};
+        std::array<Counter, Buckets> size{};
+        std::array<Counter, ErrorCodes> errors{};
+    };
+
+    // Slots outlive their threads, so counts of finished threads are kept
+    struct Registry {
+        std::mutex mutex;
+        std::vector<std::unique_ptr<Slot>> slots;
+    };
+
+    static Registry& registry() {
+        static Registry instance;
+        return instance;
     }
 
-    [[nodiscard]] Condition<Config> ge(const SqlValue<Config>& value) const {
-        using Op = typename ConditionBase<Config>::Op;
-        return Condition<Config>(name_, Op::Ge, value);
+    static Slot& local() {
+        thread_local Slot* slot = [] {
+            auto owned = std::make_unique<Slot>();
+            Slot* raw = owned.get();
+            std::lock_guard lock(registry().mutex);
+            registry().slots.push_back(std::move(owned));
+            return raw;
+        }();
+        return *slot;
+    }
+
+    // Single writer, so a load and a store instead of a locked read-modify-write
+    static void bump(Counter& counter, uint64_t amount = 1) {
+        counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    // Power-of-two bucket of `value`, the first holding values below 2^bits
+    static size_t bucket(uint64_t value, unsigned bits) {
+        const auto width = static_cast<unsigned>(std::bit_width(value));
+        return std::min<size_t>(width > bits ? width - bits : 0, Buckets - 1);
     }
 };
 
-// SqlValue class with type-safe storage
-template<typename Config>
-class SqlValue {
-public:
-    using StorageType = std::variant<
-        std::monostate,  // For NULL
-        int64_t,
-        double,
-        bool,
-        std::string_view,
-        Placeholder<Config>
-#ifdef SQLQUERYBUILDER_USE_QT
-        ,QString
-        ,QDateTime
-#endif
-        >;
+// Output target for rendering SQL text: std::string, std::pmr::string,
+// FixedBuffer<N> or anything else with the same appending interface
+template<typename S>
+concept SqlSink = requires(S& sink, std::string_view text, char c, size_t n) {
+    sink += text;
+    sink.push_back(c);
+    { sink.size() } -> std::convertible_to<size_t>;
+    sink.resize(n);
+};
 
-private:
-    StorageType storage_;
+// Fixed-capacity, null-terminated output buffer. Text past the capacity is
+// dropped and reported as BufferOverflow by buildInto().
+template<size_t N>
+class FixedBuffer {
+    std::array<char, N + 1> data_{};
+    size_t size_{0};
+    bool overflowed_{false};
 
 public:
-    SqlValue() = default;
-
-    template<SqlCompatible T>
-    explicit SqlValue(T&& value) {
-        if constexpr(std::is_integral_v<std::remove_cvref_t<T>> && !std::is_same_v<std::remove_cvref_t<T>, bool>) {
-            storage_ = static_cast<int64_t>(value);
-        } else if constexpr(std::is_floating_point_v<std::remove_cvref_t<T>>) {
-            storage_ = static_cast<double>(value);
-        } else if constexpr(std::is_same_v<std::remove_cvref_t<T>, bool>) {
-            storage_ = value;
-        } else if constexpr(std::is_same_v<std::remove_cvref_t<T>, std::string_view>) {
-            storage_ = value;
-        } else if constexpr(is_string_literal<std::remove_cvref_t<T>>::value) {
-            storage_ = std::string_view(value);
-#ifdef SQLQUERYBUILDER_USE_QT
-        } else if constexpr(std::is_same_v<std::remove_cvref_t<T>, QString>) {
-            storage_ = value;
-        } else if constexpr(std::is_same_v<std::remove_cvref_t<T>, QDateTime>) {
-            storage_ = value;
-#endif
-        } else if constexpr(std::is_enum_v<std::remove_cvref_t<T>>) {
-            storage_ = static_cast<int64_t>(value);
-        } else if constexpr(std::is_same_v<std::remove_cvref_t<T>, std::string>) {
-            storage_ = std::string_view(value.data(), value.size());
-        }
+    FixedBuffer& operator+=(std::string_view text) {
+        const size_t count = std::min(text.size(), N - size_);
+        std::memcpy(data_.data() + size_, text.data(), count);
+        size_ += count;
+        data_[size_] = '\0';
+        overflowed_ |= count < text.size();
+        return *this;
     }
-    explicit SqlValue(Placeholder<Config> placeholder) : storage_(placeholder) {}
-
 
-    static std::string escapeString(std::string_view str) {
-        // Pre-allocate with a bit of extra space for quotes and potential escapes
-        std::string escaped;
-        escaped.reserve(str.size() + 10);
-        escaped.push_back('\'');
+    FixedBuffer& operator+=(char c) {
+        push_back(c);
+        return *this;
+    }
 
-        for (char c : str) {
-            if (c == '\'') {
-                escaped.append("''");
-            } else {
-                escaped.push_back(c);
-            }
+    void push_back(char c) {
+        if (size_ == N) {
+            overflowed_ = true;
+            return;
         }
-
-        escaped.push_back('\'');
-        return escaped;
+        data_[size_++] = c;
+        data_[size_] = '\0';
     }
 
-    [[nodiscard]] std::string toSqlString() const {
-        return std::visit([](const auto& value) -> std::string {
-            using T = std::decay_t<decltype(value)>;
-            if constexpr(std::is_same_v<T, std::monostate>) {
-                return std::string(keywords::NULL_VALUE);
-            } else if constexpr(std::is_integral_v<T>) {
-                return std::to_string(value);
-            } else if constexpr(std::is_floating_point_v<T>) {
-                return std::to_string(value);
-            } else if constexpr(std::is_same_v<T, bool>) {
-                return value ? std::string(keywords::TRUE_VALUE) : std::string(keywords::FALSE_VALUE);
-            } else if constexpr(std::is_same_v<T, std::string_view>) {
-                return escapeString(value);
-            } else if constexpr(std::is_same_v<T, Placeholder<Config>>) {
-                return value.toString();
-#ifdef SQLQUERYBUILDER_USE_QT
-            } else if constexpr(std::is_same_v<T, QString>) {
-                return escapeString(value.toStdString());
-            } else if constexpr(std::is_same_v<T, QDateTime>) {
-                return std::format("'{}'", value.toString(Qt::ISODate).toStdString());
-#endif
-            }
-            return std::string(keywords::NULL_VALUE); // Fallback
-        }, storage_);
+    // Shrinking also clears the overflow flag, so a failed build can be rolled back
+    void resize(size_t size) {
+        if (size <= size_) {
+            overflowed_ = false;
+        }
+        size = std::min(size, N);
+        if (size > size_) {
+            std::memset(data_.data() + size_, 0, size - size_);
+        }
+        size_ = size;
+        data_[size_] = '\0';
     }
 
-    [[nodiscard]] bool isNull() const { return std::holds_alternative<std::monostate>(storage_); }
-    [[nodiscard]] bool isPlaceholder() const {
-        return std::holds_alternative<Placeholder<Config>>(storage_);
-    }
-};
+    void clear() { resize(0); }
 
-template<typename Config = DefaultConfig>
-inline SqlValue<Config> ph(std::string_view name = "") {
-    return SqlValue<Config>(Placeholder<Config>(name));
-}
+    [[nodiscard]] size_t size() const { return size_; }
+    [[nodiscard]] static constexpr size_t capacity() { return N; }
+    [[nodiscard]] bool overflowed() const { return overflowed_; }
+    [[nodiscard]] const char* c_str() const { return data_.data(); }
+    [[nodiscard]] std::string_view view() const { return std::string_view(data_.data(), size_); }
+};
 
-template<typename Config>
-class Condition;
+#ifdef SQLQUERYBUILDER_USE_QT
+// Renders straight into a QString as UTF-16, without the std::string
+// temporary and the fromStdString() re-encode. Sizes count UTF-16 units.
+class QStringSink {
+    QString& out_;
 
-// Base class for common condition operations
-template<typename Config>
-class ConditionBase {
 public:
-    enum class Op : uint8_t {
-        Eq, Ne, Lt, Le, Gt, Ge,
-        IsNull, IsNotNull,
-        In, NotIn,
-        Like, NotLike,
-        Between,
-        Raw,
-        And,
-        Or
-    };
-
-    enum class Type : uint8_t {
-        Invalid,
-        SimpleValue,     // column OP value
-        ColumnColumn,    // column OP other_column
-        Between,         // column BETWEEN value1 AND value2
-        IsNull,          // column IS NULL
-        IsNotNull,       // column IS NOT NULL
-        Raw,             // Raw SQL string
-        Compound,        // AND/OR of two conditions
-        In               // column IN (values)
-    };
+    explicit QStringSink(QString& out) : out_(out) {}
 
-    static const char* opToString(Op op) {
-        switch (op) {
-        case Op::Eq: return "=";
-        case Op::Ne: return "!=";
-        case Op::Lt: return "<";
-        case Op::Le: return "<=";
-        case Op::Gt: return ">";
-        case Op::Ge: return ">=";
-        case Op::Like: return "LIKE";
-        case Op::NotLike: return "NOT LIKE";
-        case Op::And: return "AND";
-        case Op::Or: return "OR";
-        default: return "";
+    QStringSink& operator+=(std::string_view text) {
+        bool ascii = true;
+        for (char c : text) {
+            if (static_cast<unsigned char>(c) >= 0x80) {
+                ascii = false;
+                break;
+            }
         }
+        if (ascii) {
+            out_.append(QLatin1String(text.data(), static_cast<int>(text.size())));
+        } else {
+            out_.append(QString::fromUtf8(text.data(), static_cast<int>(text.size())));
+        }
+        return *this;
     }
-};
 
-// Primary Condition class
-template<typename Config>
-class Condition : public ConditionBase<Config> {
-public:
-    using typename ConditionBase<Config>::Op;
-    using typename ConditionBase<Config>::Type;
+    QStringSink& operator+=(char c) {
+        push_back(c);
+        return *this;
+    }
 
+    void push_back(char c) { out_.append(QLatin1Char(c)); }
+    void resize(size_t size) { out_.resize(static_cast<int>(size)); }
+    void reserve(size_t size) { out_.reserve(static_cast<int>(size)); }
+    [[nodiscard]] size_t size() const { return static_cast<size_t>(out_.size()); }
+
+    [[nodiscard]] QString& string() { return out_; }
+};
+#endif
+
+// Owns copies of strings that have to outlive the call that produced them:
+// values, placeholder names or table aliases built at runtime. Text is packed
+// into blocks that never move, so the returned views stay valid until
+// clear() or destruction.
+class StringArena {
 private:
-    Type type_ = Type::Invalid;
-    Op op_ = Op::Eq;
-    bool negated_ = false;
+    std::vector<std::unique_ptr<char[]>> blocks_;
+    size_t block_size_;
+    size_t used_{0};      // Bytes used in the current block
+    size_t capacity_{0};  // Size of the current block
+    size_t bytes_{0};
 
-    // For column operations
-    std::string_view column_;
-    std::string_view table_;
+public:
+    explicit StringArena(size_t blockSize = 4096) : block_size_(blockSize > 0 ? blockSize : 1) {}
 
-    // Storage for various condition types
-    struct SimpleConditionData {
-        SqlValue<Config> value;
-    };
+    StringArena(const StringArena&) = delete;
+    StringArena& operator=(const StringArena&) = delete;
+    StringArena(StringArena&&) noexcept = default;
+    StringArena& operator=(StringArena&&) noexcept = default;
 
-    struct BetweenConditionData {
-        SqlValue<Config> start;
-        SqlValue<Config> end;
-    };
+    [[nodiscard]] std::string_view keep(std::string_view text) {
+        if (text.empty()) {
+            return {};
+        }
+        if (text.size() > capacity_ - used_) {
+            capacity_ = std::max(block_size_, text.size());
+            blocks_.push_back(std::make_unique_for_overwrite<char[]>(capacity_));
+            used_ = 0;
+        }
+        char* target = blocks_.back().get() + used_;
+        std::memcpy(target, text.data(), text.size());
+        used_ += text.size();
+        bytes_ += text.size();
+        return std::string_view(target, text.size());
+    }
 
-    struct ColumnColumnData {
-        std::string_view right_column;
-        std::string_view right_table;
-    };
+    // Invalidates every view handed out so far
+    void clear() {
+        blocks_.clear();
+        used_ = 0;
+        capacity_ = 0;
+        bytes_ = 0;
+    }
 
-    struct RawData {
-        std::string raw_sql;
-    };
+    [[nodiscard]] size_t bytes() const { return bytes_; }
+};
 
-    struct InConditionData {
-        std::array<SqlValue<Config>, Config::MaxInValues> values;
-        size_t count = 0;
-    };
+namespace detail {
+// Storage for clause text a builder derives or is handed: aliased table
+// names, join conditions, raw, EXISTS and HAVING conditions. Strings are
+// bump-allocated into blocks. Copies of a builder share the blocks and a
+// shared block is never written again, so views stay valid in every copy;
+// blocks a builder owns alone are reused after reset().
+class ClauseArena {
+private:
+    static constexpr size_t BlockSize = 512;
 
-    // CompoundCondition for recursive conditions (AND/OR)
-    struct CompoundConditionData {
-        std::string left_condition;
-        std::string right_condition;
-        Op op;
+    struct Block {
+        std::unique_ptr<char[]> data;
+        size_t capacity{0};
+        size_t used{0};
     };
 
-    using ConditionVariant = std::variant<
-        std::monostate,            // Invalid or simple conditions
-        SimpleConditionData,       // For SimpleValue
-        BetweenConditionData,      // For Between
-        ColumnColumnData,          // For ColumnColumn
-        RawData,                   // For Raw
-        InConditionData,           // For In
-        CompoundConditionData      // For Compound
-        >;
+    std::vector<std::shared_ptr<Block>> blocks_;
+    size_t current_{0};
+    std::string scratch_;  // Reused rendering buffer, not shared
+
+    char* allocate(size_t size) {
+        for (; current_ < blocks_.size(); ++current_) {
+            Block& block = *blocks_[current_];
+            if (blocks_[current_].use_count() == 1 && size <= block.capacity - block.used) {
+                char* target = block.data.get() + block.used;
+                block.used += size;
+                return target;
+            }
+        }
 
-    ConditionVariant data_;
+        auto block = std::make_shared<Block>();
+        block->capacity = std::max(BlockSize, size);
+        block->data = std::make_unique_for_overwrite<char[]>(block->capacity);
+        block->used = size;
+        blocks_.push_back(std::move(block));
+        current_ = blocks_.size() - 1;
+        return blocks_.back()->data.get();
+    }
 
 public:
-    // Default constructor - creates an invalid condition
-    Condition() = default;
+    ClauseArena() = default;
+    ClauseArena(const ClauseArena& other) : blocks_(other.blocks_), current_(other.current_) {}
+    ClauseArena(ClauseArena&&) noexcept = default;
 
-    // Constructor for raw SQL conditions
-    explicit Condition(std::string_view raw_condition)
-        : type_(Type::Raw) {
-        data_ = RawData{std::string(raw_condition)};
+    ClauseArena& operator=(const ClauseArena& other) {
+        if (this != &other) {
+            blocks_ = other.blocks_;
+            current_ = other.current_;
+        }
+        return *this;
     }
 
-    // Constructor for column OP value conditions
-    Condition(std::string_view column, Op op, SqlValue<Config> value)
-        : type_(Type::SimpleValue), op_(op), column_(column) {
-        data_ = SimpleConditionData{value};
-    }
+    ClauseArena& operator=(ClauseArena&&) noexcept = default;
 
-    // Column-to-column comparison constructor with explicit tables
-    Condition(std::string_view left_table, std::string_view left_column,
-              Op op,
-              std::string_view right_table, std::string_view right_column)
-        : type_(Type::ColumnColumn), op_(op),
-        table_(left_table), column_(left_column) {
-        data_ = ColumnColumnData{right_column, right_table};
-    }
+    // Concatenation of `parts`, stored in the arena
+    std::string_view store(std::initializer_list<std::string_view> parts) {
+        size_t size = 0;
+        for (std::string_view part : parts) size += part.size();
+        if (size == 0) {
+            return {};
+        }
 
-    // Shorthand for column-to-column without explicit tables
-    Condition(std::string_view left_column, Op op, std::string_view right_column)
-        : type_(Type::ColumnColumn), op_(op),
-        column_(left_column) {
-        data_ = ColumnColumnData{right_column, ""};
+        char* target = allocate(size);
+        char* out = target;
+        for (std::string_view part : parts) {
+            std::memcpy(out, part.data(), part.size());
+            out += part.size();
+        }
+        return std::string_view(target, size);
     }
 
-    // Between constructor
-    Condition(std::string_view column, Op op, SqlValue<Config> value1, SqlValue<Config> value2)
-        : type_(Type::Between), op_(op), column_(column) {
-        data_ = BetweenConditionData{value1, value2};
+    // Copy of `text` unless it already lives in the arena
+    std::string_view keep(std::string_view text) {
+        return owns(text) ? text : store({text});
     }
 
-    // IS NULL constructor
-    static Condition isNull(std::string_view column) {
-        Condition cond;
-        cond.type_ = Type::IsNull;
-        cond.column_ = column;
-        return cond;
+    // Output of `render(std::string&)`, stored in the arena
+    template<typename Fn>
+    std::string_view render(Fn&& render) {
+        scratch_.clear();
+        render(scratch_);
+        return store({scratch_});
     }
 
-    // IS NOT NULL constructor
-    static Condition isNotNull(std::string_view column) {
-        Condition cond;
-        cond.type_ = Type::IsNotNull;
-        cond.column_ = column;
-        return cond;
+    [[nodiscard]] bool owns(std::string_view text) const {
+        const std::less<const char*> before;
+        for (const auto& block : blocks_) {
+            const char* begin = block->data.get();
+            if (!before(text.data(), begin) && before(text.data(), begin + block->capacity)) {
+                return true;
+            }
+        }
+        return false;
     }
 
-    // For IN conditions with a fixed-size array of values
-    template<typename T>
-    static Condition in(std::string_view column, std::span<const T> values) {
-        Condition cond;
-        cond.type_ = Type::In;
-        cond.op_ = Op::In;
-        cond.column_ = column;
-
-        InConditionData inData;
-        // Check bounds
-        const size_t count = std::min(values.size(), static_cast<size_t>(Config::MaxInValues));
-
-        // Convert each value to SqlValue
-        for (size_t i = 0; i < count; ++i) {
-            inData.values[i] = SqlValue<Config>(values[i]);
+    // Drop the blocks shared with other builders and rewind the rest
+    void reset() {
+        std::erase_if(blocks_, [](const auto& block) { return block.use_count() > 1; });
+        for (auto& block : blocks_) {
+            block->used = 0;
         }
-        inData.count = count;
-        cond.data_ = std::move(inData);
-
-        return cond;
+        current_ = 0;
     }
+};
 
-    // For NOT IN conditions
-    template<typename T>
-    static Condition notIn(std::string_view column, std::span<const T> values) {
-        auto cond = in(column, values);
-        cond.op_ = Op::NotIn;
-        return cond;
-    }
+// Rendered text of a SELECT's clauses, kept between builds of a reused
+// builder along with a dirty bit per clause, so a build only renders the
+// clauses changed since the last one. Off until enabled; copies of a
+// builder get their own copy of the fragments.
+class ClauseCache {
+public:
+    enum Clause : uint8_t {
+        Head,   // SELECT list, FROM and joins
+        Where,
+        Group,  // GROUP BY and HAVING
+        Order,
+        Count
+    };
 
-    Condition(const Condition& other)
-        : type_(other.type_), op_(other.op_), negated_(other.negated_),
-        column_(other.column_), table_(other.table_), data_(other.data_) {
-    }
+private:
+    static constexpr uint8_t AllDirty = (1u << Count) - 1;
 
-    Condition(Condition&& other) noexcept = default;
+    struct Fragments {
+        std::array<std::string, Count> text;
+    };
+
+    std::unique_ptr<Fragments> fragments_;
+    uint8_t dirty_{AllDirty};
+
+public:
+    ClauseCache() = default;
+    ClauseCache(const ClauseCache& other)
+        : fragments_(other.fragments_ ? std::make_unique<Fragments>(*other.fragments_) : nullptr),
+        dirty_(other.dirty_) {}
+    ClauseCache(ClauseCache&&) noexcept = default;
 
-    Condition& operator=(const Condition& other) {
+    ClauseCache& operator=(const ClauseCache& other) {
         if (this != &other) {
-            type_ = other.type_;
-            op_ = other.op_;
-            negated_ = other.negated_;
-            column_ = other.column_;
-            table_ = other.table_;
-            data_ = other.data_;
+            ClauseCache copy(other);
+            *this = std::move(copy);
         }
         return *this;
     }
 
-    Condition& operator=(Condition&& other) noexcept = default;
+    ClauseCache& operator=(ClauseCache&&) noexcept = default;
 
-    // Cross-config copy constructor
-    template<typename OtherConfig>
-    Condition(const Condition<OtherConfig>& other) {
-        // For cross-config conversion, we'll use the string representation
-        type_ = Type::Raw;
-        data_ = RawData{other.toString()};
+    void enable(bool on) {
+        if (!on) {
+            fragments_.reset();
+        } else if (!fragments_) {
+            fragments_ = std::make_unique<Fragments>();
+        }
+        dirty_ = AllDirty;
     }
 
-    // Negation operator
-    Condition operator!() const {
-        Condition result = *this;
-        result.negated_ = !negated_;
-        return result;
-    }
-    // Compound AND operator
-    Condition operator&&(const Condition& other) const {
-        Condition result;
-        result.type_ = Type::Compound;
-        result.op_ = Op::And;
+    [[nodiscard]] bool enabled() const { return fragments_ != nullptr; }
 
-        // Convert conditions to strings first
-        CompoundConditionData compound;
-        compound.left_condition = this->toString();
-        compound.right_condition = other.toString();
-        compound.op = Op::And;
-        result.data_ = std::move(compound);
+    void touch(Clause clause) { dirty_ |= static_cast<uint8_t>(1u << clause); }
+    void touchAll() { dirty_ = AllDirty; }
 
-        return result;
+    // Text of `clause`, rendered by `render(std::string&)` first if dirty.
+    // If rendering throws the clause stays dirty.
+    template<typename Fn>
+    std::string_view get(Clause clause, Fn&& render) {
+        std::string& text = fragments_->text[clause];
+        const auto bit = static_cast<uint8_t>(1u << clause);
+        if (dirty_ & bit) {
+            text.clear();
+            render(text);
+            dirty_ &= static_cast<uint8_t>(~bit);
+        }
+        return text;
     }
+};
 
-    // Compound OR operator
-    Condition operator||(const Condition& other) const {
-        Condition result;
-        result.type_ = Type::Compound;
-        result.op_ = Op::Or;
-
-        // Create compound condition using serialized strings
-        CompoundConditionData compound;
-        compound.left_condition = this->toString();
-        compound.right_condition = other.toString();
-        compound.op = Op::Or;
-        result.data_ = std::move(compound);
+// Allocation-free formatting helpers used while rendering SQL
+class CountingSink;
 
-        return result;
+inline size_t integerLength(int64_t value) {
+    uint64_t magnitude = value < 0 ? 0 - static_cast<uint64_t>(value) : static_cast<uint64_t>(value);
+    size_t length = value < 0 ? 2 : 1;
+    while (magnitude >= 10) {
+        magnitude /= 10;
+        ++length;
     }
+    return length;
+}
 
-    // Convert to string for SQL generation
-    void toString(std::string& query) const {
-        if (type_ == Type::Invalid) {
-            query += "INVALID CONDITION";
-            return;
-        }
-
-        if (negated_) {
-            query += "NOT (";
-        }
-
-        switch (type_) {
-        case Type::Raw:
-            query += std::get<RawData>(data_).raw_sql;
-            break;
-
-        case Type::IsNull:
-            query += column_;
-            query += " IS NULL";
-            break;
+template<SqlSink Out>
+inline void appendInteger(Out& out, int64_t value) {
+    if constexpr(std::is_same_v<Out, CountingSink>) {
+        out.skip(integerLength(value));
+        return;
+    }
+    char buffer[24];
+    const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out += std::string_view(buffer, static_cast<size_t>(result.ptr - buffer));
+}
 
-        case Type::IsNotNull:
-            query += column_;
-            query += " IS NOT NULL";
-            break;
+// Shortest representation that round-trips, kept recognisable as a real
+template<SqlSink Out>
+inline void appendDouble(Out& out, double value) {
+    char buffer[32];
+    const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    const std::string_view digits(buffer, static_cast<size_t>(result.ptr - buffer));
+    out += digits;
+    if (digits.find_first_of(".eEn") == std::string_view::npos) {
+        out += ".0";
+    }
+}
 
-        case Type::Between: {
-            const auto& betweenData = std::get<BetweenConditionData>(data_);
-            query += column_;
-            query += " BETWEEN ";
-            query += betweenData.start.toSqlString();
-            query += " AND ";
-            query += betweenData.end.toSqlString();
-            break;
-        }
+// Quote a string literal, doubling embedded single quotes
+template<SqlSink Out>
+inline void appendEscaped(Out& out, std::string_view str) {
+    out.push_back('\'');
+    size_t start = 0;
+    for (size_t quote = str.find('\''); quote != std::string_view::npos; quote = str.find('\'', start)) {
+        out += str.substr(start, quote + 1 - start);
+        out.push_back('\'');
+        start = quote + 1;
+    }
+    out += str.substr(start);
+    out.push_back('\'');
+}
 
-        case Type::SimpleValue: {
-            const auto& simpleData = std::get<SimpleConditionData>(data_);
-            query += column_;
-            query += " ";
-            query += this->opToString(op_);
-            query += " ";
-            query += simpleData.value.toSqlString();
-            break;
+#ifdef SQLQUERYBUILDER_USE_QT
+// Quote a QString as UTF-8 without an intermediate QByteArray/std::string
+template<SqlSink Out>
+inline void appendEscaped(Out& out, const QString& str) {
+    out.push_back('\'');
+    const char16_t* units = reinterpret_cast<const char16_t*>(str.utf16());
+    const qsizetype size = str.size();
+    for (qsizetype i = 0; i < size; ++i) {
+        char32_t cp = units[i];
+        if (cp >= 0xD800 && cp <= 0xDBFF && i + 1 < size && units[i + 1] >= 0xDC00 && units[i + 1] <= 0xDFFF) {
+            cp = 0x10000 + ((cp - 0xD800) << 10) + (units[++i] - 0xDC00);
         }
 
-        case Type::ColumnColumn: {
-            const auto& colData = std::get<ColumnColumnData>(data_);
-            if (!table_.empty() && !colData.right_table.empty()) {
-                // Fully qualified names for explicit JOINs
-                query += table_;
-                query += ".";
-                query += column_;
-                query += " ";
-                query += this->opToString(op_);
-                query += " ";
-                query += colData.right_table;
-                query += ".";
-                query += colData.right_column;
-            } else {
-                // Just column names
-                query += column_;
-                query += " ";
-                query += this->opToString(op_);
-                query += " ";
-                query += colData.right_column;
+        if (cp < 0x80) {
+            out.push_back(static_cast<char>(cp));
+            if (cp == '\'') {
+                out.push_back('\'');
             }
-            break;
-        }
-
-        case Type::Compound: {
-            const auto& compoundData = std::get<CompoundConditionData>(data_);
-            query += "(";
-            query += compoundData.left_condition;
-            query += ") ";
-            query += this->opToString(compoundData.op);
-            query += " (";
-            query += compoundData.right_condition;
-            query += ")";
-            break;
+        } else if (cp < 0x800) {
+            out.push_back(static_cast<char>(0xC0 | (cp >> 6)));
+            out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+        } else if (cp < 0x10000) {
+            out.push_back(static_cast<char>(0xE0 | (cp >> 12)));
+            out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+        } else {
+            out.push_back(static_cast<char>(0xF0 | (cp >> 18)));
+            out.push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
         }
+    }
+    out.push_back('\'');
+}
 
-        case Type::In: {
-            const auto& inData = std::get<InConditionData>(data_);
-            query += column_;
-            query += (op_ == Op::In ? " IN (" : " NOT IN (");
-            for (size_t i = 0; i < inData.count; ++i) {
-                if (i > 0) query += ", ";
-                query += inData.values[i].toSqlString();
+// QString literals into a QString sink need no transcoding at all
+inline void appendEscaped(QStringSink& out, const QString& str) {
+    QString& target = out.string();
+    target.append(QLatin1Char('\''));
+    if (!str.contains(QLatin1Char('\''))) {
+        target.append(str);
+    } else {
+        for (QChar c : str) {
+            target.append(c);
+            if (c == QLatin1Char('\'')) {
+                target.append(c);
             }
-            query += ")";
-            break;
         }
+    }
+    target.append(QLatin1Char('\''));
+}
+#endif
 
-        default:
-            query += "UNKNOWN CONDITION TYPE";
-            break;
-        }
+// Sink that only counts, for sizing output exactly before rendering it
+class CountingSink {
+    size_t size_{0};
 
-        if (negated_) {
-            query += ")";
-        }
+public:
+    CountingSink& operator+=(std::string_view text) {
+        size_ += text.size();
+        return *this;
     }
 
-    std::string toString() const {
-        std::string result;
-        result.reserve(100); // Reserve a reasonable initial size
-        toString(result);
-        return result;
+    CountingSink& operator+=(char) {
+        ++size_;
+        return *this;
     }
 
-    [[nodiscard]] bool isValid() const { return type_ != Type::Invalid; }
-    [[nodiscard]] Type getType() const { return type_; }
+    void push_back(char) { ++size_; }
+    void skip(size_t count) { size_ += count; }
+    void resize(size_t size) { size_ = size; }
+    [[nodiscard]] size_t size() const { return size_; }
 };
 
-// Expression template for delayed condition evaluation
-template<typename Left, typename Right, typename Op, typename Config = DefaultConfig>
-class ConditionExpression {
-private:
-    Left left_;
-    Right right_;
-
-public:
-    ConditionExpression(Left left, Right right)
-        : left_(std::move(left)), right_(std::move(right)) {}
+// Positional parameter marker: "?", or "$n" for dialects that number them,
+// counted in `binds` across the whole statement. `name` is the token the
+// caller wrote, kept in the slot when a "$n" of theirs is renumbered.
+template<typename Dialect, SqlSink Out>
+void appendPositional(Out& query, BindCollector* binds, std::string_view name = {}) {
+    const size_t offset = query.size();
+    if constexpr(Dialect::positional == PlaceholderStyle::Dollar) {
+        query += '$';
+        appendInteger(query, binds ? ++binds->positional : 1);
+    } else {
+        query += '?';
+    }
+    if (binds) {
+        binds->slots.push_back(BindSlot{std::string(name), Dialect::positional, offset, query.size() - offset});
+    }
+}
 
-    operator Condition<Config>() const {
-        // Construct the actual condition only when needed
-        if constexpr (std::is_same_v<Op, typename ConditionBase<Config>::Op>) {
-            // Handle direct operations
-            return Condition<Config>(left_, Op::value, right_);
-        } else {
-            // Handle compound conditions (AND/OR)
-            Condition<Config> leftCond = left_;
-            Condition<Config> rightCond = right_;
-            if constexpr (std::is_same_v<Op, std::logical_and<>>) {
-                return leftCond && rightCond;
-            } else if constexpr (std::is_same_v<Op, std::logical_or<>>) {
-                return leftCond || rightCond;
-            }
+// Append `text` with its "$n" markers renumbered from `positional` on, for
+// statements assembled from values rendered apart. `markers` are the slots
+// recorded while rendering, ascending, at offsets `base` bytes before `text`.
+template<SqlSink Out>
+void appendRenumbered(Out& out, std::string_view text, size_t base, std::span<const BindSlot> markers,
+                      uint32_t& positional) {
+    size_t pos = 0;
+    for (auto it = std::ranges::lower_bound(markers, base, {}, &BindSlot::offset);
+         it != markers.end() && it->offset < base + text.size(); ++it) {
+        if (it->style != PlaceholderStyle::Dollar) {
+            continue;  // Named markers are kept as written
         }
+        const size_t at = it->offset - base;
+        out += text.substr(pos, at - pos);
+        out += '$';
+        appendInteger(out, ++positional);
+        pos = at + it->length;
     }
+    out += text.substr(pos);
+}
 
-    // Allow combining with other expressions
-    template<typename OtherRight, typename OtherOp>
-    auto operator&&(const ConditionExpression<Right, OtherRight, OtherOp, Config>& other) const {
-        return ConditionExpression<ConditionExpression, ConditionExpression<Right, OtherRight, OtherOp, Config>, std::logical_and<>, Config>(*this, other);
+// `identifier` in the dialect's identifier quotes, each part of a dotted
+// name quoted separately and embedded quotes doubled
+template<typename Dialect, SqlSink Out>
+void appendQuotedIdentifier(Out& query, std::string_view identifier) {
+    constexpr char quote = Dialect::identifier_quote;
+    query.push_back(quote);
+    for (char c : identifier) {
+        if (c == '.') {
+            query.push_back(quote);
+            query.push_back('.');
+            query.push_back(quote);
+            continue;
+        }
+        if (c == quote) {
+            query.push_back(quote);
+        }
+        query.push_back(c);
     }
+    query.push_back(quote);
+}
 
-    template<typename OtherRight, typename OtherOp>
-    auto operator||(const ConditionExpression<Right, OtherRight, OtherOp, Config>& other) const {
-        return ConditionExpression<ConditionExpression, ConditionExpression<Right, OtherRight, OtherOp, Config>, std::logical_or<>, Config>(*this, other);
+// URL-safe base64 without padding, for tokens handed to clients
+inline void appendBase64Url(std::string& out, std::string_view bytes) {
+    static constexpr char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+    uint32_t bits = 0;
+    int count = 0;
+    for (unsigned char c : bytes) {
+        bits = (bits << 8) | c;
+        count += 8;
+        while (count >= 6) {
+            count -= 6;
+            out += alphabet[(bits >> count) & 0x3f];
+        }
     }
-};
-
-// Column class with non-template base implementation
-template<typename Config>
-class Column {
-    std::string_view name_;
-
-public:
-    explicit Column(std::string_view name) : name_(name) {}
-    [[nodiscard]] std::string_view name() const { return name_; }
-
-    [[nodiscard]] Condition<Config> isNull() const {
-        return Condition<Config>::isNull(name_);
+    if (count > 0) {
+        out += alphabet[(bits << (6 - count)) & 0x3f];
     }
+}
 
-    [[nodiscard]] Condition<Config> isNotNull() const {
-        return Condition<Config>::isNotNull(name_);
+inline std::optional<std::string> decodeBase64Url(std::string_view text) {
+    std::string out;
+    out.reserve(text.size() * 3 / 4);
+    uint32_t bits = 0;
+    int count = 0;
+    for (char c : text) {
+        int value;
+        if (c >= 'A' && c <= 'Z') value = c - 'A';
+        else if (c >= 'a' && c <= 'z') value = c - 'a' + 26;
+        else if (c >= '0' && c <= '9') value = c - '0' + 52;
+        else if (c == '-') value = 62;
+        else if (c == '_') value = 63;
+        else return std::nullopt;
+        bits = (bits << 6) | static_cast<uint32_t>(value);
+        count += 6;
+        if (count >= 8) {
+            count -= 8;
+            out += static_cast<char>((bits >> count) & 0xff);
+        }
     }
+    return out;
+}
 
-    template<SqlCompatible T>
-    [[nodiscard]] Condition<Config> eq(T&& value) const {
-        using Op = typename ConditionBase<Config>::Op;
-        return Condition<Config>(name_, Op::Eq, SqlValue<Config>(std::forward<T>(value)));
-    }
+// Hash over the parts of a query that determine its SQL shape. Mixes a
+// word at a time, since it runs on every cache lookup.
+class ShapeHash {
+    uint64_t state_{0xcbf29ce484222325ull};
 
-    template<SqlCompatible T>
-    [[nodiscard]] Condition<Config> ne(T&& value) const {
-        using Op = typename ConditionBase<Config>::Op;
-        return Condition<Config>(name_, Op::Ne, SqlValue<Config>(std::forward<T>(value)));
+public:
+    void add(uint64_t value) {
+        state_ = (state_ ^ value) * 0x9e3779b97f4a7c15ull;
+        state_ ^= state_ >> 29;
     }
 
-    template<SqlCompatible T>
-    [[nodiscard]] Condition<Config> lt(T&& value) const {
-        using Op = typename ConditionBase<Config>::Op;
-        return Condition<Config>(name_, Op::Lt, SqlValue<Config>(std::forward<T>(value)));
+    // Length-prefixed so adjacent strings cannot run together
+    void add(std::string_view text) {
+        add(static_cast<uint64_t>(text.size()));
+        size_t i = 0;
+        for (; i + sizeof(uint64_t) <= text.size(); i += sizeof(uint64_t)) {
+            uint64_t word;
+            std::memcpy(&word, text.data() + i, sizeof(word));
+            add(word);
+        }
+        if (i < text.size()) {
+            uint64_t word = 0;
+            std::memcpy(&word, text.data() + i, text.size() - i);
+            add(word);
+        }
     }
 
-    template<SqlCompatible T>
-    [[nodiscard]] Condition<Config> le(T&& value) const {
-        using Op = typename ConditionBase<Config>::Op;
-        return Condition<Config>(name_, Op::Le, SqlValue<Config>(std::forward<T>(value)));
-    }
+    [[nodiscard]] uint64_t value() const { return state_; }
+};
 
-    template<SqlCompatible T>
-    [[nodiscard]] Condition<Config> gt(T&& value) const {
-        using Op = typename ConditionBase<Config>::Op;
-        return Condition<Config>(name_, Op::Gt, SqlValue<Config>(std::forward<T>(value)));
+// 64-bit FNV-1a over the bytes of `text`. Unlike std::hash and ShapeHash it
+// is the same on every platform and in every process, so keys hashed with
+// it keep their shard across restarts and between services.
+inline uint64_t stableHash(std::string_view text) {
+    uint64_t hash = 14695981039346656037ull;
+    for (const char c : text) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ull;
     }
+    return hash;
+}
 
-    template<SqlCompatible T>
-    [[nodiscard]] Condition<Config> ge(T&& value) const {
-        using Op = typename ConditionBase<Config>::Op;
-        return Condition<Config>(name_, Op::Ge, SqlValue<Config>(std::forward<T>(value)));
+// Whether `written`, a column as a condition names it, is `column` with or
+// without a table or alias qualifier
+inline bool sameColumn(std::string_view written, std::string_view column) {
+    if (written.size() == column.size()) {
+        return written == column;
     }
+    return written.size() > column.size() && written.ends_with(column) &&
+           written[written.size() - column.size() - 1] == '.';
+}
+} // namespace detail
 
-    [[nodiscard]] Condition<Config> like(std::string_view pattern) const {
-        using Op = typename ConditionBase<Config>::Op;
-        return Condition<Config>(name_, Op::Like, SqlValue<Config>(pattern));
-    }
+// Forward declarations
+template<typename Config = DefaultConfig>
+class SqlValue;
 
-    [[nodiscard]] Condition<Config> notLike(std::string_view pattern) const {
-        using Op = typename ConditionBase<Config>::Op;
-        return Condition<Config>(name_, Op::NotLike, SqlValue<Config>(pattern));
-    }
+template<typename Config = DefaultConfig>
+class ConditionBase;
 
-    template<SqlCompatible T, SqlCompatible U>
-    [[nodiscard]] Condition<Config> between(T&& start, U&& end) const {
-        using Op = typename ConditionBase<Config>::Op;
-        return Condition<Config>(
-            name_,
-            Op::Between,
-            SqlValue<Config>(std::forward<T>(start)),
-            SqlValue<Config>(std::forward<U>(end))
-            );
-    }
+template<typename Config = DefaultConfig>
+class Condition;
 
-    template<typename U>
-    [[nodiscard]] Condition<Config> in(std::span<const U> values) const {
-        return Condition<Config>::in(name_, values);
-    }
+template<typename Config = DefaultConfig>
+class Column;
 
-    template<typename U>
-    [[nodiscard]] Condition<Config> notIn(std::span<const U> values) const {
-        return Condition<Config>::notIn(name_, values);
-    }
+template<typename Config = DefaultConfig>
+class AliasedTable;
 
-    [[nodiscard]] Condition<Config> eq(const SqlValue<Config>& value) const {
-        using Op = typename ConditionBase<Config>::Op;
-        return Condition<Config>(name_, Op::Eq, value);
-    }
+template<typename Config = DefaultConfig>
+class Placeholder;
 
-    [[nodiscard]] Condition<Config> ne(const SqlValue<Config>& value) const {
-        using Op = typename ConditionBase<Config>::Op;
-        return Condition<Config>(name_, Op::Ne, value);
-    }
+template<typename Config = DefaultConfig>
+class QueryBuilder;
 
-    [[nodiscard]] Condition<Config> lt(const SqlValue<Config>& value) const {
-        using Op = typename ConditionBase<Config>::Op;
-        return Condition<Config>(name_, Op::Lt, value);
-    }
+template<typename Config = DefaultConfig>
+class PageCursor;
 
-    [[nodiscard]] Condition<Config> le(const SqlValue<Config>& value) const {
-        using Op = typename ConditionBase<Config>::Op;
-        return Condition<Config>(name_, Op::Le, value);
-    }
+template<typename Config = DefaultConfig>
+class ShardRouter;
 
-    [[nodiscard]] Condition<Config> gt(const SqlValue<Config>& value) const {
+// Table class with config awareness
+template<typename Config = DefaultConfig>
+class Table {
+private:
+    std::string_view name_;
+
+public:
+    constexpr explicit Table(std::string_view name) : name_(name) {}
+
+    [[nodiscard]] constexpr std::string_view name() const { return name_; }
+
+    constexpr operator std::string_view() const { return name_; }
+
+    [[nodiscard]] AliasedTable<Config> as(std::string_view alias) const;
+};
+
+// AliasedTable for better join handling
+template<typename Config>
+class AliasedTable {
+private:
+    std::string_view table_;
+    std::string_view alias_;
+
+public:
+    constexpr AliasedTable(std::string_view table, std::string_view alias)
+        : table_(table), alias_(alias) {}
+
+    [[nodiscard]] constexpr std::string_view tableName() const { return table_; }
+    [[nodiscard]] constexpr std::string_view alias() const { return alias_; }
+
+    [[nodiscard]] std::string toString() const {
+        return std::string(table_) + " " + std::string(alias_);
+    }
+
+    operator std::string() const { return toString(); }
+};
+
+// Implementation of Table::as
+template<typename Config>
+AliasedTable<Config> Table<Config>::as(std::string_view alias) const {
+    return AliasedTable<Config>(name_, alias);
+}
+
+// TypedColumn class with config awareness
+template<typename T, typename Config = DefaultConfig>
+class TypedColumn {
+private:
+    std::string_view table_;
+    std::string_view name_;
+    std::string_view alias_; // Optional column alias
+
+public:
+    using value_type = T;
+    using config_type = Config;
+
+    constexpr TypedColumn(std::string_view table, std::string_view name)
+        : table_(table), name_(name), alias_() {}
+
+    // Constructor that includes column alias
+    constexpr TypedColumn(std::string_view table, std::string_view name, std::string_view alias)
+        : table_(table), name_(name), alias_(alias) {}
+
+    [[nodiscard]] constexpr std::string_view tableName() const { return table_; }
+    [[nodiscard]] constexpr std::string_view name() const { return name_; }
+    [[nodiscard]] constexpr std::string_view alias() const { return alias_; }
+
+    [[nodiscard]] std::string qualifiedName() const {
+        if (table_.empty()) {
+            return std::string(name_);
+        }
+        return std::string(table_) + "." + std::string(name_);
+    }
+
+    [[nodiscard]] constexpr TypedColumn<T, Config> as(std::string_view alias) const {
+        return TypedColumn<T, Config>(table_, name_, alias);
+    }
+
+    constexpr operator std::string_view() const { return name_; }
+
+    // Condition generators
+    [[nodiscard]] Condition<Config> isNull() const;
+    [[nodiscard]] Condition<Config> isNotNull() const;
+
+    template<SqlCompatible U>
+    [[nodiscard]] Condition<Config> eq(U&& value) const;
+
+    template<typename OtherType, typename OtherConfig>
+    [[nodiscard]] Condition<Config> eq(const TypedColumn<OtherType, OtherConfig>& other) const;
+
+    template<SqlCompatible U>
+    [[nodiscard]] Condition<Config> ne(U&& value) const;
+
+    template<typename OtherType, typename OtherConfig>
+    [[nodiscard]] Condition<Config> ne(const TypedColumn<OtherType, OtherConfig>& other) const;
+
+    template<SqlCompatible U>
+    [[nodiscard]] Condition<Config> lt(U&& value) const;
+
+    template<typename OtherType, typename OtherConfig>
+    [[nodiscard]] Condition<Config> lt(const TypedColumn<OtherType, OtherConfig>& other) const;
+
+    template<SqlCompatible U>
+    [[nodiscard]] Condition<Config> le(U&& value) const;
+
+    template<typename OtherType, typename OtherConfig>
+    [[nodiscard]] Condition<Config> le(const TypedColumn<OtherType, OtherConfig>& other) const;
+
+    template<SqlCompatible U>
+    [[nodiscard]] Condition<Config> gt(U&& value) const;
+
+    template<typename OtherType, typename OtherConfig>
+    [[nodiscard]] Condition<Config> gt(const TypedColumn<OtherType, OtherConfig>& other) const;
+
+    template<SqlCompatible U>
+    [[nodiscard]] Condition<Config> ge(U&& value) const;
+
+    template<typename OtherType, typename OtherConfig>
+    [[nodiscard]] Condition<Config> ge(const TypedColumn<OtherType, OtherConfig>& other) const;
+
+    [[nodiscard]] Condition<Config> like(std::string_view pattern) const;
+    [[nodiscard]] Condition<Config> notLike(std::string_view pattern) const;
+
+    template<SqlCompatible T1, SqlCompatible T2>
+    [[nodiscard]] Condition<Config> between(T1&& start, T2&& end) const;
+
+    template<typename U>
+    [[nodiscard]] Condition<Config> in(std::span<const U> values) const;
+
+    template<typename U>
+    [[nodiscard]] Condition<Config> notIn(std::span<const U> values) const;
+
+    [[nodiscard]] Condition<Config> eq(const SqlValue<Config>& value) const {
+        using Op = typename ConditionBase<Config>::Op;
+        return Condition<Config>(name_, Op::Eq, value);
+    }
+
+    [[nodiscard]] Condition<Config> ne(const SqlValue<Config>& value) const {
+        using Op = typename ConditionBase<Config>::Op;
+        return Condition<Config>(name_, Op::Ne, value);
+    }
+
+    [[nodiscard]] Condition<Config> lt(const SqlValue<Config>& value) const {
+        using Op = typename ConditionBase<Config>::Op;
+        return Condition<Config>(name_, Op::Lt, value);
+    }
+
+    [[nodiscard]] Condition<Config> le(const SqlValue<Config>& value) const {
+        using Op = typename ConditionBase<Config>::Op;
+        return Condition<Config>(name_, Op::Le, value);
+    }
+
+    [[nodiscard]] Condition<Config> gt(const SqlValue<Config>& value) const {
         using Op = typename ConditionBase<Config>::Op;
         return Condition<Config>(name_, Op::Gt, value);
     }
@@ -984,1559 +1782,7554 @@ public:
     }
 };
 
-template<typename T, typename Config>
-Condition<Config> TypedColumn<T, Config>::isNull() const {
-    return Condition<Config>::isNull(name_);
-}
-
-template<typename T, typename Config>
-Condition<Config> TypedColumn<T, Config>::isNotNull() const {
-    return Condition<Config>::isNotNull(name_);
-}
+// SqlValue class with type-safe storage
+template<typename Config>
+class SqlValue {
+public:
+    using StorageType = std::variant<
+        std::monostate,  // For NULL
+        int64_t,
+        double,
+        bool,
+        std::string_view,
+        Placeholder<Config>
+#ifdef SQLQUERYBUILDER_USE_QT
+        ,QString
+        ,QDateTime
+#endif
+        >;
 
-template<typename T, typename Config>
-template<SqlCompatible U>
-Condition<Config> TypedColumn<T, Config>::eq(U&& value) const {
-    using Op = typename ConditionBase<Config>::Op;
-    return Condition<Config>(name_, Op::Eq, SqlValue<Config>(std::forward<U>(value)));
-}
+private:
+    template<typename> friend class SqlValue;
+    friend class PageCursor<Config>;
 
-template<typename T, typename Config>
-template<typename OtherType, typename OtherConfig>
-Condition<Config> TypedColumn<T, Config>::eq(const TypedColumn<OtherType, OtherConfig>& other) const {
-    using Op = typename ConditionBase<Config>::Op;
-    return Condition<Config>(table_, name_, Op::Eq, other.tableName(), other.name());
-}
+    StorageType storage_;
 
-template<typename T, typename Config>
-template<SqlCompatible U>
-Condition<Config> TypedColumn<T, Config>::ne(U&& value) const {
-    using Op = typename ConditionBase<Config>::Op;
-    return Condition<Config>(name_, Op::Ne, SqlValue<Config>(std::forward<U>(value)));
-}
+public:
+    SqlValue() = default;
 
-template<typename T, typename Config>
-template<typename OtherType, typename OtherConfig>
-Condition<Config> TypedColumn<T, Config>::ne(const TypedColumn<OtherType, OtherConfig>& other) const {
-    using Op = typename ConditionBase<Config>::Op;
-    return Condition<Config>(table_, name_, Op::Ne, other.tableName(), other.name());
-}
+    // Same value under another config, rendered in this config's dialect
+    template<typename OtherConfig>
+        requires (!std::is_same_v<OtherConfig, Config>)
+    explicit SqlValue(const SqlValue<OtherConfig>& other) {
+        std::visit([this](const auto& value) {
+            using T = std::decay_t<decltype(value)>;
+            if constexpr(std::is_same_v<T, Placeholder<OtherConfig>>) {
+                storage_ = Placeholder<Config>(value);
+            } else {
+                storage_ = value;
+            }
+        }, other.storage_);
+    }
 
-template<typename T, typename Config>
-template<SqlCompatible U>
-Condition<Config> TypedColumn<T, Config>::lt(U&& value) const {
-    using Op = typename ConditionBase<Config>::Op;
-    return Condition<Config>(name_, Op::Lt, SqlValue<Config>(std::forward<U>(value)));
-}
+    // Strings are referenced, not copied. A temporary would dangle, so it
+    // has to be kept alive by the caller or stored in a StringArena.
+    template<SqlCompatible T>
+    explicit SqlValue(T&& value) {
+        static_assert(!std::is_same_v<T, std::string>,
+                      "A temporary std::string would dangle: keep it alive or use StringArena::keep()");
+        if constexpr(std::is_integral_v<std::remove_cvref_t<T>> && !std::is_same_v<std::remove_cvref_t<T>, bool>) {
+            storage_ = static_cast<int64_t>(value);
+        } else if constexpr(std::is_floating_point_v<std::remove_cvref_t<T>>) {
+            storage_ = static_cast<double>(value);
+        } else if constexpr(std::is_same_v<std::remove_cvref_t<T>, bool>) {
+            storage_ = value;
+        } else if constexpr(std::is_same_v<std::remove_cvref_t<T>, std::string_view>) {
+            storage_ = value;
+        } else if constexpr(is_string_literal<std::remove_cvref_t<T>>::value) {
+            storage_ = std::string_view(value);
+#ifdef SQLQUERYBUILDER_USE_QT
+        } else if constexpr(std::is_same_v<std::remove_cvref_t<T>, QString>) {
+            storage_ = value;
+        } else if constexpr(std::is_same_v<std::remove_cvref_t<T>, QDateTime>) {
+            storage_ = value;
+#endif
+        } else if constexpr(std::is_enum_v<std::remove_cvref_t<T>>) {
+            storage_ = static_cast<int64_t>(value);
+        } else if constexpr(std::is_same_v<std::remove_cvref_t<T>, std::string>) {
+            storage_ = std::string_view(value.data(), value.size());
+        }
+    }
+    explicit SqlValue(Placeholder<Config> placeholder) : storage_(placeholder) {}
 
-template<typename T, typename Config>
-template<typename OtherType, typename OtherConfig>
-Condition<Config> TypedColumn<T, Config>::lt(const TypedColumn<OtherType, OtherConfig>& other) const {
-    using Op = typename ConditionBase<Config>::Op;
-    return Condition<Config>(table_, name_, Op::Lt, other.tableName(), other.name());
-}
 
-template<typename T, typename Config>
-template<SqlCompatible U>
-Condition<Config> TypedColumn<T, Config>::le(U&& value) const {
-    using Op = typename ConditionBase<Config>::Op;
-    return Condition<Config>(name_, Op::Le, SqlValue<Config>(std::forward<U>(value)));
-}
+    static std::string escapeString(std::string_view str) {
+        // Pre-allocate with a bit of extra space for quotes and potential escapes
+        std::string escaped;
+        escaped.reserve(str.size() + 10);
+        detail::appendEscaped(escaped, str);
+        return escaped;
+    }
 
-template<typename T, typename Config>
-template<typename OtherType, typename OtherConfig>
-Condition<Config> TypedColumn<T, Config>::le(const TypedColumn<OtherType, OtherConfig>& other) const {
-    using Op = typename ConditionBase<Config>::Op;
-    return Condition<Config>(table_, name_, Op::Le, other.tableName(), other.name());
-}
+    [[nodiscard]] std::string toSqlString() const {
+        std::string result;
+        appendSql(result);
+        return result;
+    }
 
-template<typename T, typename Config>
-template<SqlCompatible U>
-Condition<Config> TypedColumn<T, Config>::gt(U&& value) const {
-    using Op = typename ConditionBase<Config>::Op;
-    return Condition<Config>(name_, Op::Gt, SqlValue<Config>(std::forward<U>(value)));
-}
+    // Append the SQL form of this value directly into `query`. When
+    // compiling, placeholder positions are recorded in `binds`.
+    template<SqlSink Out>
+    void appendSql(Out& query, BindCollector* binds = nullptr) const {
+        using Dialect = DialectOf<Config>;
+        if (binds && binds->bind_literals && !isPlaceholder()) {
+            detail::appendPositional<Dialect>(query, binds);
+            return;
+        }
 
-template<typename T, typename Config>
-template<typename OtherType, typename OtherConfig>
-Condition<Config> TypedColumn<T, Config>::gt(const TypedColumn<OtherType, OtherConfig>& other) const {
-    using Op = typename ConditionBase<Config>::Op;
-    return Condition<Config>(table_, name_, Op::Gt, other.tableName(), other.name());
-}
+        std::visit([&query, binds](const auto& value) {
+            using T = std::decay_t<decltype(value)>;
+            if constexpr(std::is_same_v<T, std::monostate>) {
+                query += keywords::NULL_VALUE;
+            } else if constexpr(std::is_same_v<T, bool>) {
+                query += value ? Dialect::true_value : Dialect::false_value;
+            } else if constexpr(std::is_integral_v<T>) {
+                detail::appendInteger(query, value);
+            } else if constexpr(std::is_floating_point_v<T>) {
+                detail::appendDouble(query, value);
+            } else if constexpr(std::is_same_v<T, std::string_view>) {
+                detail::appendEscaped(query, value);
+            } else if constexpr(std::is_same_v<T, Placeholder<Config>>) {
+                if (value.style() == PlaceholderStyle::QuestionMark) {
+                    detail::appendPositional<Dialect>(query, binds);
+                    return;
+                }
+                if (Dialect::positional == PlaceholderStyle::Dollar && value.style() == PlaceholderStyle::Dollar) {
+                    // Renumbered in statement order, so that the "$n" of
+                    // subqueries and joins never collide
+                    detail::appendPositional<Dialect>(query, binds, value.name());
+                    return;
+                }
+                const size_t offset = query.size();
+                value.appendSql(query);
+                if (binds) {
+                    binds->slots.push_back(BindSlot{value.name(), value.style(), offset, query.size() - offset});
+                }
+#ifdef SQLQUERYBUILDER_USE_QT
+            } else if constexpr(std::is_same_v<T, QString>) {
+                detail::appendEscaped(query, value);
+            } else if constexpr(std::is_same_v<T, QDateTime>) {
+                detail::appendEscaped(query, value.toString(Qt::ISODate));
+#endif
+            } else {
+                query += keywords::NULL_VALUE; // Fallback
+            }
+        }, storage_);
+    }
 
-template<typename T, typename Config>
-template<SqlCompatible U>
-Condition<Config> TypedColumn<T, Config>::ge(U&& value) const {
-    using Op = typename ConditionBase<Config>::Op;
-    return Condition<Config>(name_, Op::Ge, SqlValue<Config>(std::forward<U>(value)));
+    [[nodiscard]] bool isNull() const { return std::holds_alternative<std::monostate>(storage_); }
+    [[nodiscard]] bool isPlaceholder() const {
+        return std::holds_alternative<Placeholder<Config>>(storage_);
+    }
+
+    [[nodiscard]] std::optional<Placeholder<Config>> placeholder() const {
+        if (const auto* value = std::get_if<Placeholder<Config>>(&storage_)) {
+            return *value;
+        }
+        return std::nullopt;
+    }
+
+    // Key that places the value on a shard (see ShardRouter). Integers and
+    // booleans are their own key and text is hashed with detail::stableHash(),
+    // so a value keeps its shard in every process. NULL, reals and
+    // placeholders have none.
+    [[nodiscard]] std::optional<uint64_t> routingKey() const {
+        return std::visit([](const auto& value) -> std::optional<uint64_t> {
+            using T = std::decay_t<decltype(value)>;
+            if constexpr(std::is_same_v<T, int64_t> || std::is_same_v<T, bool>) {
+                return static_cast<uint64_t>(value);
+            } else if constexpr(std::is_same_v<T, std::string_view>) {
+                return detail::stableHash(value);
+#ifdef SQLQUERYBUILDER_USE_QT
+            } else if constexpr(std::is_same_v<T, QString>) {
+                const QByteArray utf8 = value.toUtf8();
+                return detail::stableHash(std::string_view(utf8.constData(), static_cast<size_t>(utf8.size())));
+            } else if constexpr(std::is_same_v<T, QDateTime>) {
+                const QByteArray text = value.toString(Qt::ISODate).toUtf8();
+                return detail::stableHash(std::string_view(text.constData(), static_cast<size_t>(text.size())));
+#endif
+            } else {
+                return std::nullopt;
+            }
+        }, storage_);
+    }
+
+    // Literals all hash alike since compileParameterized() lifts them into
+    // slots; placeholders keep their name in the SQL, so they hash by name
+    void hashShape(detail::ShapeHash& hash) const {
+        if (const auto* placeholder = std::get_if<Placeholder<Config>>(&storage_)) {
+            hash.add(static_cast<uint64_t>(placeholder->style()) + 1);
+            hash.add(placeholder->id());
+        } else {
+            hash.add(uint64_t{0});
+        }
+    }
+
+#ifdef SQLQUERYBUILDER_USE_QTSQL
+    // Value for QSqlQuery::bindValue(), converted without going through SQL
+    // text. NULL and placeholders map to a null QVariant.
+    [[nodiscard]] QVariant toVariant() const {
+        return std::visit([](const auto& value) -> QVariant {
+            using T = std::decay_t<decltype(value)>;
+            if constexpr(std::is_same_v<T, int64_t>) {
+                return QVariant(static_cast<qlonglong>(value));
+            } else if constexpr(std::is_same_v<T, double> || std::is_same_v<T, bool> ||
+                                std::is_same_v<T, QString> || std::is_same_v<T, QDateTime>) {
+                return QVariant(value);
+            } else if constexpr(std::is_same_v<T, std::string_view>) {
+                return QVariant(QString::fromUtf8(value.data(), static_cast<int>(value.size())));
+            } else {
+                return QVariant();
+            }
+        }, storage_);
+    }
+#endif
+};
+
+template<typename Config = DefaultConfig>
+inline SqlValue<Config> ph(std::string_view name = "") {
+    return SqlValue<Config>(Placeholder<Config>(name));
 }
 
-template<typename T, typename Config>
-template<typename OtherType, typename OtherConfig>
-Condition<Config> TypedColumn<T, Config>::ge(const TypedColumn<OtherType, OtherConfig>& other) const {
-    using Op = typename ConditionBase<Config>::Op;
-    return Condition<Config>(table_, name_, Op::Ge, other.tableName(), other.name());
-}
+// The name would dangle; keep generated names alive, e.g. in a StringArena
+template<typename Config = DefaultConfig, typename S>
+    requires std::same_as<S, std::string>
+SqlValue<Config> ph(S&& name) = delete;
+
+// Opaque, URL-safe token holding the sort key of the last row of a page,
+// handed to the client and passed back to QueryBuilder::seekAfter() for the
+// next page. It encodes values only: it is not signed, so treat it as user
+// input, which the builder does by rendering its values as escaped literals
+// or bind parameters.
+template<typename Config>
+class PageCursor {
+public:
+    [[nodiscard]] static Result<std::string> encode(std::span<const SqlValue<Config>> row) {
+        std::string payload(1, Version);
+        for (const auto& value : row) {
+            const bool stored = std::visit([&payload](const auto& item) {
+                using T = std::decay_t<decltype(item)>;
+                if constexpr(std::is_same_v<T, std::monostate>) {
+                    payload += 'n';
+                } else if constexpr(std::is_same_v<T, bool>) {
+                    payload += item ? "b1" : "b0";
+                } else if constexpr(std::is_same_v<T, int64_t>) {
+                    payload += 'i';
+                    detail::appendInteger(payload, item);
+                    payload += ';';
+                } else if constexpr(std::is_same_v<T, double>) {
+                    char buffer[32];
+                    const auto result = std::to_chars(buffer, buffer + sizeof(buffer), item);
+                    payload += 'd';
+                    payload.append(buffer, result.ptr);
+                    payload += ';';
+                } else if constexpr(std::is_same_v<T, std::string_view>) {
+                    appendText(payload, item);
+#ifdef SQLQUERYBUILDER_USE_QT
+                } else if constexpr(std::is_same_v<T, QString>) {
+                    appendText(payload, item.toStdString());
+                } else if constexpr(std::is_same_v<T, QDateTime>) {
+                    appendText(payload, item.toString(Qt::ISODate).toStdString());
+#endif
+                } else {
+                    return false;
+                }
+                return true;
+            }, value.storage_);
+            if (!stored) {
+                return QueryError(QueryError::Code::InvalidOperation, "A page cursor cannot hold placeholders");
+            }
+        }
+
+        std::string token;
+        token.reserve(payload.size() * 4 / 3 + 1);
+        detail::appendBase64Url(token, payload);
+        return token;
+    }
+
+    // Values of `token`, with their text kept in `arena` (anything with a
+    // keep(std::string_view) returning a stable view, like StringArena)
+    template<typename Arena>
+    [[nodiscard]] static Result<std::vector<SqlValue<Config>>> decode(std::string_view token, Arena& arena) {
+        const QueryError invalid(QueryError::Code::InvalidOperation, "Invalid page cursor");
+        const auto payload = detail::decodeBase64Url(token);
+        if (!payload || payload->empty() || payload->front() != Version) {
+            return invalid;
+        }
+
+        std::vector<SqlValue<Config>> row;
+        std::string_view rest = std::string_view(*payload).substr(1);
+        while (!rest.empty()) {
+            const char tag = rest.front();
+            rest.remove_prefix(1);
+            if (tag == 'n') {
+                row.emplace_back();
+            } else if (tag == 'b' && !rest.empty() && (rest.front() == '0' || rest.front() == '1')) {
+                row.emplace_back(rest.front() == '1');
+                rest.remove_prefix(1);
+            } else if (tag == 'i' || tag == 'd') {
+                const size_t end = rest.find(';');
+                if (end == std::string_view::npos) {
+                    return invalid;
+                }
+                const char* first = rest.data();
+                std::from_chars_result result;
+                if (tag == 'i') {
+                    int64_t number = 0;
+                    result = std::from_chars(first, first + end, number);
+                    row.emplace_back(number);
+                } else {
+                    double number = 0;
+                    result = std::from_chars(first, first + end, number);
+                    row.emplace_back(number);
+                }
+                if (result.ec != std::errc() || result.ptr != first + end) {
+                    return invalid;
+                }
+                rest.remove_prefix(end + 1);
+            } else if (tag == 's') {
+                const size_t colon = rest.find(':');
+                size_t length = 0;
+                if (colon == std::string_view::npos ||
+                    std::from_chars(rest.data(), rest.data() + colon, length).ptr != rest.data() + colon ||
+                    length > rest.size() - colon - 1) {
+                    return invalid;
+                }
+                row.emplace_back(arena.keep(rest.substr(colon + 1, length)));
+                rest.remove_prefix(colon + 1 + length);
+            } else {
+                return invalid;
+            }
+        }
+        return row;
+    }
+
+private:
+    static constexpr char Version = '1';
+
+    static void appendText(std::string& payload, std::string_view text) {
+        payload += 's';
+        detail::appendInteger(payload, static_cast<int64_t>(text.size()));
+        payload += ':';
+        payload += text;
+    }
+};
+
+template<typename Config>
+class Condition;
+
+// Base class for common condition operations
+template<typename Config>
+class ConditionBase {
+public:
+    enum class Op : uint8_t {
+        Eq, Ne, Lt, Le, Gt, Ge,
+        IsNull, IsNotNull,
+        In, NotIn,
+        Like, NotLike,
+        Between,
+        Raw,
+        And,
+        Or,
+        Exists
+    };
+
+    enum class Type : uint8_t {
+        Invalid,
+        SimpleValue,     // column OP value
+        ColumnColumn,    // column OP other_column
+        Between,         // column BETWEEN value1 AND value2
+        IsNull,          // column IS NULL
+        IsNotNull,       // column IS NOT NULL
+        Raw,             // Raw SQL string
+        Compound,        // AND/OR of two conditions
+        In,              // column IN (values)
+        Subquery,        // EXISTS (query), column [NOT] IN (query)
+        RowCompare       // (column, ...) OP (value, ...)
+    };
+
+    static const char* opToString(Op op) {
+        switch (op) {
+        case Op::Eq: return "=";
+        case Op::Ne: return "!=";
+        case Op::Lt: return "<";
+        case Op::Le: return "<=";
+        case Op::Gt: return ">";
+        case Op::Ge: return ">=";
+        case Op::Like: return "LIKE";
+        case Op::NotLike: return "NOT LIKE";
+        case Op::And: return "AND";
+        case Op::Or: return "OR";
+        default: return "";
+        }
+    }
+};
+
+// Primary Condition class
+template<typename Config>
+class Condition : public ConditionBase<Config> {
+public:
+    using typename ConditionBase<Config>::Op;
+    using typename ConditionBase<Config>::Type;
+
+private:
+    // Hot fields, inline and trivially copyable apart from the value: the
+    // column (or the text of a raw condition), and the operand of a column
+    // OP value condition or the start of a BETWEEN
+    Type type_ = Type::Invalid;
+    Op op_ = Op::Eq;
+    bool negated_ = false;
+    std::string_view column_;
+    SqlValue<Config> value_;
+
+    // Side table entry for everything else, which type_ identifies: null for
+    // simple comparisons, NULL checks and raw views. Immutable once built
+    // and shared between copies, except the compound pool (see mutablePool()).
+    std::shared_ptr<void> extra_;
+
+    // For Between: the end of the range
+    struct BetweenData {
+        SqlValue<Config> end;
+    };
+
+    struct ColumnColumnData {
+        std::string_view left_table;
+        std::string_view right_column;
+        std::string_view right_table;
+    };
+
+    // For Raw, the owned text column_ views. Conditions made by rawView()
+    // have none. Config independent, so conversions share it.
+    using RawText = std::string;
+
+    // IN list of any length, read through `at` so that the span passed to
+    // inList() is not copied. in() and conversions point it at `owned`.
+    // Array strategies carry their serialized parameter.
+    struct InListData {
+        const void* items = nullptr;
+        size_t count = 0;
+        SqlValue<Config> (*at)(const void* items, size_t index) = nullptr;
+        InStrategy strategy = InStrategy::Inline;
+        std::vector<SqlValue<Config>> owned;
+        std::string array;
+
+        [[nodiscard]] bool hasArray() const {
+            return strategy == InStrategy::JsonEach || strategy == InStrategy::AnyArray;
+        }
+    };
+
+    // For Subquery: the nested builder itself, rendered in place with the
+    // enclosing query. Not owned; extra_ holds it without a control block.
+
+    // Row value comparison, one value per column
+    struct RowCompareData {
+        std::vector<std::string_view> columns;
+        std::vector<SqlValue<Config>> values;
+    };
+
+    // CompoundCondition for recursive conditions (AND/OR). The expression
+    // tree lives in a flat pool: leaves hold the operand conditions and
+    // nodes reference their children by index, so combining conditions
+    // never re-serializes the operands. The pool is shared between copies
+    // and only duplicated when a shared tree is modified.
+    struct CompoundConditionData {
+        static constexpr uint32_t LeafBit = 0x80000000u;  // Child ref points into leaves
+
+        struct Node {
+            Op op;
+            bool negated;
+            uint32_t left;
+            uint32_t right;
+        };
+
+        std::vector<Condition> leaves;
+        std::vector<Node> nodes;  // Children precede parents; the root is nodes.back()
+    };
+
+    template<typename> friend class Condition;
+
+    template<typename T>
+    [[nodiscard]] const T& side() const {
+        return *static_cast<const T*>(extra_.get());
+    }
+
+    [[nodiscard]] const QueryBuilder<Config>& subquery() const {
+        return side<QueryBuilder<Config>>();
+    }
+
+    // IN list that owns its values
+    static std::shared_ptr<InListData> ownedList(std::vector<SqlValue<Config>> values, InStrategy strategy) {
+        auto list = std::make_shared<InListData>();
+        list->owned = std::move(values);
+        list->items = list->owned.data();
+        list->count = list->owned.size();
+        list->at = &valueAt<SqlValue<Config>>;
+        list->strategy = strategy;
+        return list;
+    }
+
+public:
+    // Default constructor - creates an invalid condition
+    Condition() = default;
+
+    // Constructor for raw SQL conditions
+    explicit Condition(std::string_view raw_condition)
+        : type_(Type::Raw) {
+        auto text = std::make_shared<RawText>(raw_condition);
+        column_ = *text;
+        extra_ = std::move(text);
+    }
+
+    // Raw SQL condition that references `sql` instead of copying it. The
+    // builder uses it for text kept in its clause arena.
+    static Condition rawView(std::string_view sql) {
+        Condition cond;
+        cond.type_ = Type::Raw;
+        cond.column_ = sql;
+        return cond;
+    }
+
+    // Constructor for column OP value conditions
+    Condition(std::string_view column, Op op, SqlValue<Config> value)
+        : type_(Type::SimpleValue), op_(op), column_(column), value_(std::move(value)) {}
+
+    // Column-to-column comparison constructor with explicit tables
+    Condition(std::string_view left_table, std::string_view left_column,
+              Op op,
+              std::string_view right_table, std::string_view right_column)
+        : type_(Type::ColumnColumn), op_(op), column_(left_column),
+        extra_(std::make_shared<ColumnColumnData>(ColumnColumnData{left_table, right_column, right_table})) {}
+
+    // Shorthand for column-to-column without explicit tables
+    Condition(std::string_view left_column, Op op, std::string_view right_column)
+        : type_(Type::ColumnColumn), op_(op), column_(left_column),
+        extra_(std::make_shared<ColumnColumnData>(ColumnColumnData{{}, right_column, {}})) {}
+
+    // Between constructor
+    Condition(std::string_view column, Op op, SqlValue<Config> value1, SqlValue<Config> value2)
+        : type_(Type::Between), op_(op), column_(column), value_(std::move(value1)),
+        extra_(std::make_shared<BetweenData>(BetweenData{std::move(value2)})) {}
+
+    // IS NULL constructor
+    static Condition isNull(std::string_view column) {
+        Condition cond;
+        cond.type_ = Type::IsNull;
+        cond.column_ = column;
+        return cond;
+    }
+
+    // IS NOT NULL constructor
+    static Condition isNotNull(std::string_view column) {
+        Condition cond;
+        cond.type_ = Type::IsNotNull;
+        cond.column_ = column;
+        return cond;
+    }
+
+    // For IN conditions over a copy of the values, of any length
+    template<typename T>
+    static Condition in(std::string_view column, std::span<const T> values) {
+        Condition cond;
+        cond.type_ = Type::In;
+        cond.op_ = Op::In;
+        cond.column_ = column;
+
+        std::vector<SqlValue<Config>> owned;
+        owned.reserve(values.size());
+        for (const auto& value : values) {
+            owned.push_back(SqlValue<Config>(value));
+        }
+        cond.extra_ = ownedList(std::move(owned), InStrategy::Inline);
+
+        return cond;
+    }
+
+    // IN over a span of any length, rendered with `strategy`. The values are
+    // not copied, so the span must outlive the condition, like column names.
+    // Bind and the array strategies render "?" markers: bind them from
+    // QueryBuilder::bindValues() after compileParameterized(), or use a
+    // QueryCache. Array strategies serialize the values once, here.
+    template<typename T>
+    static Condition inList(std::string_view column, std::span<const T> values,
+                            InStrategy strategy = InStrategy::Bind) {
+        Condition cond;
+        cond.type_ = Type::In;
+        cond.op_ = Op::In;
+        cond.column_ = column;
+
+        auto list = std::make_shared<InListData>();
+        list->items = values.data();
+        list->count = values.size();
+        list->at = &valueAt<T>;
+        list->strategy = strategy;
+        if (list->hasArray()) {
+            list->array = arrayParameter(values, strategy);
+        }
+        cond.extra_ = std::move(list);
+        return cond;
+    }
+
+    template<typename T>
+    static Condition notInList(std::string_view column, std::span<const T> values,
+                               InStrategy strategy = InStrategy::Bind) {
+        auto cond = inList(column, values, strategy);
+        cond.op_ = Op::NotIn;
+        return cond;
+    }
+
+    // For NOT IN conditions
+    template<typename T>
+    static Condition notIn(std::string_view column, std::span<const T> values) {
+        auto cond = in(column, values);
+        cond.op_ = Op::NotIn;
+        return cond;
+    }
+
+    // EXISTS (query). `query` is rendered with the condition, directly into
+    // the same output, and must outlive it.
+    static Condition exists(const QueryBuilder<Config>& query) {
+        Condition cond;
+        cond.type_ = Type::Subquery;
+        cond.op_ = Op::Exists;
+        cond.extra_ = subqueryEntry(query);
+        return cond;
+    }
+
+    // column IN (query), with the same lifetime rule as exists()
+    static Condition inSubquery(std::string_view column, const QueryBuilder<Config>& query) {
+        Condition cond;
+        cond.type_ = Type::Subquery;
+        cond.op_ = Op::In;
+        cond.column_ = column;
+        cond.extra_ = subqueryEntry(query);
+        return cond;
+    }
+
+    static Condition notInSubquery(std::string_view column, const QueryBuilder<Config>& query) {
+        auto cond = inSubquery(column, query);
+        cond.op_ = Op::NotIn;
+        return cond;
+    }
+
+    // A temporary builder would dangle; keep it alive, or use
+    // QueryBuilder::whereExists() and whereIn(), which keep a copy
+    static Condition exists(QueryBuilder<Config>&&) = delete;
+    static Condition inSubquery(std::string_view, QueryBuilder<Config>&&) = delete;
+    static Condition notInSubquery(std::string_view, QueryBuilder<Config>&&) = delete;
+
+    // (a, b) OP (x, y), compared in order like ORDER BY a, b. `columns`
+    // and `values` must have the same length.
+    static Condition rowCompare(std::span<const std::string_view> columns, Op op,
+                                std::span<const SqlValue<Config>> values) {
+        Condition cond;
+        cond.type_ = Type::RowCompare;
+        cond.op_ = op;
+        cond.extra_ = std::make_shared<RowCompareData>(
+            RowCompareData{{columns.begin(), columns.end()}, {values.begin(), values.end()}});
+        return cond;
+    }
+
+    // Copies duplicate the inline value and share the side entry; the builder
+    // and the operators below take rvalues so that conditions built inline
+    // are only ever moved
+    Condition(const Condition& other) = default;
+    Condition(Condition&& other) noexcept = default;
+    Condition& operator=(const Condition& other) = default;
+    Condition& operator=(Condition&& other) noexcept = default;
+
+    // Cross-config copy constructor. Keeps the structure, so values render
+    // in this config's dialect and can still be lifted into bind slots.
+    template<typename OtherConfig>
+    Condition(const Condition<OtherConfig>& other)
+        : type_(static_cast<Type>(other.type_)), op_(static_cast<Op>(other.op_)), negated_(other.negated_),
+        column_(other.column_), value_(other.value_) {
+        using Other = Condition<OtherConfig>;
+        switch (other.type_) {
+        case Other::Type::Between:
+            extra_ = std::make_shared<BetweenData>(
+                BetweenData{SqlValue<Config>(other.template side<typename Other::BetweenData>().end)});
+            break;
+        case Other::Type::ColumnColumn: {
+            const auto& data = other.template side<typename Other::ColumnColumnData>();
+            extra_ = std::make_shared<ColumnColumnData>(
+                ColumnColumnData{data.left_table, data.right_column, data.right_table});
+            break;
+        }
+        case Other::Type::Raw:
+            extra_ = other.extra_;
+            break;
+        case Other::Type::In: {
+            const auto& data = other.template side<typename Other::InListData>();
+            std::vector<SqlValue<Config>> values;
+            values.reserve(data.count);
+            for (size_t i = 0; i < data.count; ++i) values.emplace_back(data.at(data.items, i));
+            auto list = ownedList(std::move(values), data.strategy);
+            list->array = data.array;
+            extra_ = std::move(list);
+            break;
+        }
+        case Other::Type::Compound: {
+            const auto& data = other.pool();
+            auto pool = std::make_shared<CompoundConditionData>();
+            pool->leaves.reserve(data.leaves.size());
+            for (const auto& operand : data.leaves) pool->leaves.emplace_back(operand);
+            pool->nodes.reserve(data.nodes.size());
+            for (const auto& node : data.nodes) {
+                pool->nodes.push_back({static_cast<Op>(node.op), node.negated, node.left, node.right});
+            }
+            extra_ = std::move(pool);
+            break;
+        }
+        case Other::Type::RowCompare: {
+            const auto& data = other.template side<typename Other::RowCompareData>();
+            auto row = std::make_shared<RowCompareData>(RowCompareData{data.columns, {}});
+            row->values.reserve(data.values.size());
+            for (const auto& value : data.values) row->values.emplace_back(value);
+            extra_ = std::move(row);
+            break;
+        }
+        case Other::Type::Subquery: {
+            // A builder of another config cannot render into this one
+            type_ = Type::Raw;
+            negated_ = false;
+            auto text = std::make_shared<RawText>(other.toString());
+            column_ = *text;
+            extra_ = std::move(text);
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    // Negation operator
+    Condition operator!() const& {
+        Condition result = *this;
+        result.negated_ = !negated_;
+        return result;
+    }
+
+    Condition operator!() && {
+        Condition result = std::move(*this);
+        result.negated_ = !result.negated_;
+        return result;
+    }
+
+    // Compound AND operator; temporary operands are moved into the tree
+    Condition operator&&(const Condition& other) const& {
+        return combine(*this, other, Op::And);
+    }
+
+    Condition operator&&(const Condition& other) && {
+        return combine(std::move(*this), other, Op::And);
+    }
+
+    Condition operator&&(Condition&& other) const& {
+        return combine(*this, std::move(other), Op::And);
+    }
+
+    Condition operator&&(Condition&& other) && {
+        return combine(std::move(*this), std::move(other), Op::And);
+    }
+
+    // Compound OR operator
+    Condition operator||(const Condition& other) const& {
+        return combine(*this, other, Op::Or);
+    }
+
+    Condition operator||(const Condition& other) && {
+        return combine(std::move(*this), other, Op::Or);
+    }
+
+    Condition operator||(Condition&& other) const& {
+        return combine(*this, std::move(other), Op::Or);
+    }
+
+    Condition operator||(Condition&& other) && {
+        return combine(std::move(*this), std::move(other), Op::Or);
+    }
+
+    // Convert to string for SQL generation. When compiling, placeholder
+    // positions are recorded in `binds`.
+    template<SqlSink Out>
+    void toString(Out& query, BindCollector* binds = nullptr) const {
+        if (type_ == Type::Invalid) {
+            query += "INVALID CONDITION";
+            return;
+        }
+
+        if (negated_) {
+            query += "NOT (";
+        }
+
+        switch (type_) {
+        case Type::Raw:
+            query += column_;
+            break;
+
+        case Type::IsNull:
+            query += column_;
+            query += " IS NULL";
+            break;
+
+        case Type::IsNotNull:
+            query += column_;
+            query += " IS NOT NULL";
+            break;
+
+        case Type::Between: {
+            query += column_;
+            query += " BETWEEN ";
+            value_.appendSql(query, binds);
+            query += " AND ";
+            side<BetweenData>().end.appendSql(query, binds);
+            break;
+        }
+
+        case Type::SimpleValue:
+            query += column_;
+            query += " ";
+            query += this->opToString(op_);
+            query += " ";
+            value_.appendSql(query, binds);
+            break;
+
+        case Type::ColumnColumn: {
+            const auto& colData = side<ColumnColumnData>();
+            if (!colData.left_table.empty() && !colData.right_table.empty()) {
+                // Fully qualified names for explicit JOINs
+                query += colData.left_table;
+                query += ".";
+                query += column_;
+                query += " ";
+                query += this->opToString(op_);
+                query += " ";
+                query += colData.right_table;
+                query += ".";
+                query += colData.right_column;
+            } else {
+                // Just column names
+                query += column_;
+                query += " ";
+                query += this->opToString(op_);
+                query += " ";
+                query += colData.right_column;
+            }
+            break;
+        }
+
+        case Type::Compound: {
+            const auto& compoundData = pool();
+            renderNode(query, compoundData, compoundData.nodes.back(), binds);
+            break;
+        }
+
+        case Type::In:
+            renderInList(query, side<InListData>(), binds);
+            break;
+
+        case Type::Subquery: {
+            if (op_ == Op::Exists) {
+                query += "EXISTS (";
+            } else {
+                query += column_;
+                query += (op_ == Op::In ? " IN (" : " NOT IN (");
+            }
+            subquery().renderStatement(query, binds);
+            query += ")";
+            break;
+        }
+
+        case Type::RowCompare: {
+            const auto& rowData = side<RowCompareData>();
+            query += "(";
+            for (size_t i = 0; i < rowData.columns.size(); ++i) {
+                if (i > 0) query += ", ";
+                query += rowData.columns[i];
+            }
+            query += ") ";
+            query += this->opToString(op_);
+            query += " (";
+            for (size_t i = 0; i < rowData.values.size(); ++i) {
+                if (i > 0) query += ", ";
+                rowData.values[i].appendSql(query, binds);
+            }
+            query += ")";
+            break;
+        }
+
+        default:
+            query += "UNKNOWN CONDITION TYPE";
+            break;
+        }
+
+        if (negated_) {
+            query += ")";
+        }
+    }
+
+    std::string toString() const {
+        std::string result;
+        result.reserve(100); // Reserve a reasonable initial size
+        toString(result);
+        return result;
+    }
+
+    [[nodiscard]] bool isValid() const { return type_ != Type::Invalid; }
+    [[nodiscard]] Type getType() const { return type_; }
+    [[nodiscard]] Op getOp() const { return op_; }
+    [[nodiscard]] bool isNegated() const { return negated_; }
+    [[nodiscard]] bool isCompound() const { return type_ == Type::Compound; }
+
+    // Whether the condition renders values or placeholders, i.e. whether
+    // collectValues() can yield anything
+    [[nodiscard]] bool hasValues() const {
+        switch (type_) {
+        case Type::SimpleValue:
+        case Type::Between:
+        case Type::In:
+        case Type::Subquery:
+        case Type::RowCompare:
+            return true;
+        case Type::Compound:
+            return std::ranges::any_of(pool().leaves, [](const auto& leaf) { return leaf.hasValues(); });
+        default:
+            return false;
+        }
+    }
+
+    // Whether the top level is an OR, which needs parentheses next to AND
+    [[nodiscard]] bool isDisjunction() const {
+        return isCompound() && !negated_ && pool().nodes.back().op == Op::Or;
+    }
+
+    // Whether the condition or one of its operands renders a nested builder
+    [[nodiscard]] bool hasSubquery() const {
+        if (type_ == Type::Subquery) {
+            return true;
+        }
+        if (!isCompound()) {
+            return false;
+        }
+        return std::ranges::any_of(pool().leaves, [](const Condition& operand) { return operand.hasSubquery(); });
+    }
+
+    // Call `fn(const QueryBuilder<Config>&)` for each nested builder the
+    // condition renders, in SQL order
+    template<typename Fn>
+    void forEachSubquery(Fn&& fn) const {
+        if (type_ == Type::Subquery) {
+            fn(subquery());
+        } else if (isCompound()) {
+            for (const auto& operand : pool().leaves) {
+                operand.forEachSubquery(fn);
+            }
+        }
+    }
+
+    // Operand conditions of a compound, in the order they appear in the SQL
+    [[nodiscard]] size_t leafCount() const {
+        return isCompound() ? pool().leaves.size() : 0;
+    }
+
+    [[nodiscard]] const Condition& leaf(size_t index) const {
+        return pool().leaves[index];
+    }
+
+    // Mutable access for rewriting an operand in place, e.g. to reuse a
+    // filter tree with new values. Detaches the tree from other copies.
+    [[nodiscard]] Condition& leaf(size_t index) {
+        return mutablePool().leaves[index];
+    }
+
+    // Hash everything that affects the parameterized SQL text
+    void hashShape(detail::ShapeHash& hash) const {
+        hash.add((static_cast<uint64_t>(type_) << 16) | (static_cast<uint64_t>(op_) << 8) | negated_);
+        hash.add(column_);
+
+        switch (type_) {
+        case Type::SimpleValue:
+            value_.hashShape(hash);
+            break;
+        case Type::Between:
+            value_.hashShape(hash);
+            side<BetweenData>().end.hashShape(hash);
+            break;
+        case Type::ColumnColumn: {
+            const auto& data = side<ColumnColumnData>();
+            hash.add(data.left_table);
+            hash.add(data.right_column);
+            hash.add(data.right_table);
+            break;
+        }
+        case Type::In: {
+            // One parameter for array strategies, whatever the list length
+            const auto& data = side<InListData>();
+            hash.add(static_cast<uint64_t>(data.strategy));
+            if (!data.hasArray()) {
+                hash.add(static_cast<uint64_t>(data.count));
+                for (size_t i = 0; i < data.count; ++i) {
+                    data.at(data.items, i).hashShape(hash);
+                }
+            }
+            break;
+        }
+        case Type::RowCompare: {
+            const auto& data = side<RowCompareData>();
+            hash.add(static_cast<uint64_t>(data.columns.size()));
+            for (size_t i = 0; i < data.columns.size(); ++i) {
+                hash.add(data.columns[i]);
+                data.values[i].hashShape(hash);
+            }
+            break;
+        }
+        case Type::Subquery:
+            hash.add(subquery().fingerprint());
+            break;
+        case Type::Compound:
+            for (const auto& node : pool().nodes) {
+                hash.add((static_cast<uint64_t>(node.op) << 8) | node.negated);
+                hash.add((static_cast<uint64_t>(node.left) << 32) | node.right);
+            }
+            for (const auto& leafCondition : pool().leaves) {
+                leafCondition.hashShape(hash);
+            }
+            break;
+        default:
+            break;
+        }
+    }
+
+    // Append the values this condition renders, in SQL order
+    void collectValues(std::vector<SqlValue<Config>>& out) const {
+        switch (type_) {
+        case Type::SimpleValue:
+            out.push_back(value_);
+            break;
+        case Type::Between:
+            out.push_back(value_);
+            out.push_back(side<BetweenData>().end);
+            break;
+        case Type::In: {
+            const auto& data = side<InListData>();
+            if (data.hasArray()) {
+                out.push_back(SqlValue<Config>(std::string_view(data.array)));
+            } else {
+                for (size_t i = 0; i < data.count; ++i) {
+                    out.push_back(data.at(data.items, i));
+                }
+            }
+            break;
+        }
+        case Type::RowCompare: {
+            const auto& values = side<RowCompareData>().values;
+            out.insert(out.end(), values.begin(), values.end());
+            break;
+        }
+        case Type::Subquery:
+            subquery().bindValues(out);
+            break;
+        case Type::Compound:
+            for (const auto& leafCondition : pool().leaves) {
+                leafCondition.collectValues(out);
+            }
+            break;
+        default:
+            break;
+        }
+    }
+
+    template<typename Fn>
+    void forEachLeaf(Fn&& fn) const {
+        if (!isCompound()) {
+            fn(*this);
+            return;
+        }
+        for (const auto& leafCondition : pool().leaves) {
+            fn(leafCondition);
+        }
+    }
+
+    // Column the condition tests, as written; the text of a raw condition,
+    // empty for compounds and EXISTS
+    [[nodiscard]] std::string_view column() const { return column_; }
+
+    // Append the values `column` must equal for the condition to hold and
+    // return true: those of an = or IN on it, alone, AND-ed with anything
+    // or on both sides of an OR. The first operand of an AND that restricts
+    // the column is taken, so the values may be a superset. Returns false,
+    // appending nothing, when the column is left open: ranges, negations,
+    // subqueries and raw text. `column` matches with or without a qualifier.
+    bool keyValues(std::string_view column, std::vector<SqlValue<Config>>& out) const {
+        if (negated_) {
+            return false;
+        }
+        switch (type_) {
+        case Type::SimpleValue:
+            if (op_ != Op::Eq || !detail::sameColumn(column_, column)) {
+                return false;
+            }
+            out.push_back(value_);
+            return true;
+        case Type::In: {
+            if (op_ != Op::In || !detail::sameColumn(column_, column)) {
+                return false;
+            }
+            const auto& data = side<InListData>();
+            for (size_t i = 0; i < data.count; ++i) {
+                out.push_back(data.at(data.items, i));
+            }
+            return true;
+        }
+        case Type::RowCompare: {
+            if (op_ != Op::Eq) {
+                return false;
+            }
+            const auto& data = side<RowCompareData>();
+            for (size_t i = 0; i < data.columns.size(); ++i) {
+                if (detail::sameColumn(data.columns[i], column)) {
+                    out.push_back(data.values[i]);
+                    return true;
+                }
+            }
+            return false;
+        }
+        case Type::Compound:
+            return nodeKeyValues(pool(), pool().nodes.back(), column, out);
+        default:
+            return false;
+        }
+    }
+
+    // The same IN condition over `values` instead, e.g. the share of one
+    // shard. Array strategies serialize their values up front, so those
+    // conditions, like every other kind, are returned unchanged.
+    [[nodiscard]] Condition withValues(std::vector<SqlValue<Config>> values) const {
+        if (type_ != Type::In || side<InListData>().hasArray()) {
+            return *this;
+        }
+        Condition result = *this;
+        result.extra_ = ownedList(std::move(values), side<InListData>().strategy);
+        return result;
+    }
+
+private:
+    using PoolPtr = std::shared_ptr<CompoundConditionData>;
+
+    [[nodiscard]] const CompoundConditionData& pool() const {
+        return side<CompoundConditionData>();
+    }
+
+    [[nodiscard]] CompoundConditionData& mutablePool() {
+        if (extra_.use_count() > 1) {
+            extra_ = std::make_shared<CompoundConditionData>(pool());
+        }
+        return *static_cast<CompoundConditionData*>(extra_.get());
+    }
+
+    // Side entry that points at `query` without owning it
+    static std::shared_ptr<void> subqueryEntry(const QueryBuilder<Config>& query) {
+        return std::shared_ptr<void>(std::shared_ptr<void>(), const_cast<QueryBuilder<Config>*>(&query));
+    }
+
+    // keyValues() of the operand `ref` points at: a leaf, or a node with its own negation
+    static bool refKeyValues(const CompoundConditionData& pool, uint32_t ref, std::string_view column,
+                             std::vector<SqlValue<Config>>& out) {
+        if (ref & CompoundConditionData::LeafBit) {
+            return pool.leaves[ref & ~CompoundConditionData::LeafBit].keyValues(column, out);
+        }
+        const auto& node = pool.nodes[ref];
+        return !node.negated && nodeKeyValues(pool, node, column, out);
+    }
+
+    // The root's negation is the condition's own, checked by keyValues()
+    static bool nodeKeyValues(const CompoundConditionData& pool, const typename CompoundConditionData::Node& node,
+                              std::string_view column, std::vector<SqlValue<Config>>& out) {
+        const size_t start = out.size();
+        if (node.op == Op::And) {
+            return refKeyValues(pool, node.left, column, out) || refKeyValues(pool, node.right, column, out);
+        }
+        if (refKeyValues(pool, node.left, column, out) && refKeyValues(pool, node.right, column, out)) {
+            return true;
+        }
+        out.erase(out.begin() + static_cast<std::ptrdiff_t>(start), out.end());
+        return false;
+    }
+
+    static Condition combine(Condition lhs, Condition rhs, Op op) {
+        Condition result;
+        result.type_ = Type::Compound;
+        result.op_ = op;
+
+        // Grow the left operand's tree in place when nothing else shares it
+        PoolPtr compound;
+        uint32_t left;
+        if (lhs.type_ == Type::Compound && lhs.extra_.use_count() == 1) {
+            compound = std::static_pointer_cast<CompoundConditionData>(std::move(lhs.extra_));
+            compound->nodes.back().negated = lhs.negated_;
+            left = static_cast<uint32_t>(compound->nodes.size() - 1);
+        } else {
+            compound = std::make_shared<CompoundConditionData>();
+            left = adopt(*compound, std::move(lhs));
+        }
+        const uint32_t right = adopt(*compound, std::move(rhs));
+        compound->nodes.push_back({op, false, left, right});
+        result.extra_ = std::move(compound);
+
+        return result;
+    }
+
+    // Add an operand to the pool and return the reference to it. Compound
+    // operands are spliced in by remapping their child indices.
+    static uint32_t adopt(CompoundConditionData& target, Condition&& operand) {
+        if (operand.type_ != Type::Compound) {
+            target.leaves.push_back(std::move(operand));
+            return CompoundConditionData::LeafBit | static_cast<uint32_t>(target.leaves.size() - 1);
+        }
+
+        auto* source = static_cast<CompoundConditionData*>(operand.extra_.get());
+        const bool unique = operand.extra_.use_count() == 1;
+        const auto leafBase = static_cast<uint32_t>(target.leaves.size());
+        const auto nodeBase = static_cast<uint32_t>(target.nodes.size());
+        const auto remap = [&](uint32_t ref) {
+            return (ref & CompoundConditionData::LeafBit) ? ref + leafBase : ref + nodeBase;
+        };
+
+        target.leaves.reserve(target.leaves.size() + source->leaves.size());
+        for (auto& leafCondition : source->leaves) {
+            if (unique) {
+                target.leaves.push_back(std::move(leafCondition));
+            } else {
+                target.leaves.push_back(leafCondition);
+            }
+        }
+        for (const auto& node : source->nodes) {
+            target.nodes.push_back({node.op, node.negated, remap(node.left), remap(node.right)});
+        }
+
+        target.nodes.back().negated = operand.negated_;
+        return static_cast<uint32_t>(target.nodes.size() - 1);
+    }
+
+    template<typename T>
+    static SqlValue<Config> valueAt(const void* items, size_t index) {
+        const T& item = static_cast<const T*>(items)[index];
+        if constexpr(std::is_same_v<T, SqlValue<Config>>) {
+            return item;
+        } else {
+            return SqlValue<Config>(item);
+        }
+    }
+
+    // JSON array for json_each(), or a PostgreSQL array literal for ANY()
+    template<typename T>
+    static std::string arrayParameter(std::span<const T> values, InStrategy strategy) {
+        const bool json = strategy == InStrategy::JsonEach;
+        std::string text;
+        text.reserve(values.size() * 8 + 2);
+        text += json ? '[' : '{';
+        for (size_t i = 0; i < values.size(); ++i) {
+            if (i > 0) text += ',';
+            const auto& value = values[i];
+            using V = std::remove_cvref_t<T>;
+            if constexpr(std::is_same_v<V, bool>) {
+                text += json ? (value ? "1" : "0") : (value ? "true" : "false");
+            } else if constexpr(std::is_integral_v<V> || std::is_enum_v<V>) {
+                detail::appendInteger(text, static_cast<int64_t>(value));
+            } else if constexpr(std::is_floating_point_v<V>) {
+                detail::appendDouble(text, static_cast<double>(value));
+            } else {
+                static_assert(std::is_convertible_v<const V&, std::string_view>,
+                              "Array parameters support numbers, bools, enums and strings");
+                const std::string_view str(value);
+                text += '"';
+                for (char c : str) {
+                    if (c == '"' || c == '\\') {
+                        text += '\\';
+                        text += c;
+                    } else if (json && static_cast<unsigned char>(c) < 0x20) {
+                        constexpr char hex[] = "0123456789abcdef";
+                        text += "\\u00";
+                        text += hex[(c >> 4) & 0xF];
+                        text += hex[c & 0xF];
+                    } else {
+                        text += c;
+                    }
+                }
+                text += '"';
+            }
+        }
+        text += json ? ']' : '}';
+        return text;
+    }
+
+    template<SqlSink Out>
+    static void appendParameter(Out& query, BindCollector* binds) {
+        detail::appendPositional<DialectOf<Config>>(query, binds);
+    }
+
+    template<SqlSink Out>
+    void renderInList(Out& query, const InListData& list, BindCollector* binds) const {
+        query += column_;
+        switch (list.strategy) {
+        case InStrategy::Inline:
+        case InStrategy::Bind:
+            query += (op_ == Op::In ? " IN (" : " NOT IN (");
+            for (size_t i = 0; i < list.count; ++i) {
+                if (i > 0) query += ", ";
+                if (list.strategy == InStrategy::Bind) {
+                    appendParameter(query, binds);
+                } else {
+                    list.at(list.items, i).appendSql(query, binds);
+                }
+            }
+            query += ")";
+            break;
+        case InStrategy::JsonEach:
+            query += (op_ == Op::In ? " IN (SELECT value FROM json_each(" : " NOT IN (SELECT value FROM json_each(");
+            appendParameter(query, binds);
+            query += "))";
+            break;
+        case InStrategy::AnyArray:
+            query += (op_ == Op::In ? " = ANY(" : " <> ALL(");
+            appendParameter(query, binds);
+            query += ")";
+            break;
+        }
+    }
+
+    template<SqlSink Out>
+    static void renderRef(Out& query, const CompoundConditionData& pool, uint32_t ref,
+                          BindCollector* binds) {
+        if (ref & CompoundConditionData::LeafBit) {
+            pool.leaves[ref & ~CompoundConditionData::LeafBit].toString(query, binds);
+            return;
+        }
+
+        const auto& node = pool.nodes[ref];
+        if (node.negated) {
+            query += "NOT (";
+        }
+        renderNode(query, pool, node, binds);
+        if (node.negated) {
+            query += ")";
+        }
+    }
+
+    template<SqlSink Out>
+    static void renderNode(Out& query, const CompoundConditionData& pool,
+                           const typename CompoundConditionData::Node& node,
+                           BindCollector* binds) {
+        query += "(";
+        renderRef(query, pool, node.left, binds);
+        query += ") ";
+        query += ConditionBase<Config>::opToString(node.op);
+        query += " (";
+        renderRef(query, pool, node.right, binds);
+        query += ")";
+    }
+};
+
+// Expression template for delayed condition evaluation
+template<typename Left, typename Right, typename Op, typename Config = DefaultConfig>
+class ConditionExpression {
+private:
+    Left left_;
+    Right right_;
+
+public:
+    ConditionExpression(Left left, Right right)
+        : left_(std::move(left)), right_(std::move(right)) {}
+
+    operator Condition<Config>() const {
+        // Construct the actual condition only when needed
+        if constexpr (std::is_same_v<Op, typename ConditionBase<Config>::Op>) {
+            // Handle direct operations
+            return Condition<Config>(left_, Op::value, right_);
+        } else {
+            // Handle compound conditions (AND/OR)
+            Condition<Config> leftCond = left_;
+            Condition<Config> rightCond = right_;
+            if constexpr (std::is_same_v<Op, std::logical_and<>>) {
+                return leftCond && rightCond;
+            } else if constexpr (std::is_same_v<Op, std::logical_or<>>) {
+                return leftCond || rightCond;
+            }
+        }
+    }
+
+    // Allow combining with other expressions
+    template<typename OtherRight, typename OtherOp>
+    auto operator&&(const ConditionExpression<Right, OtherRight, OtherOp, Config>& other) const {
+        return ConditionExpression<ConditionExpression, ConditionExpression<Right, OtherRight, OtherOp, Config>, std::logical_and<>, Config>(*this, other);
+    }
+
+    template<typename OtherRight, typename OtherOp>
+    auto operator||(const ConditionExpression<Right, OtherRight, OtherOp, Config>& other) const {
+        return ConditionExpression<ConditionExpression, ConditionExpression<Right, OtherRight, OtherOp, Config>, std::logical_or<>, Config>(*this, other);
+    }
+};
+
+// Column class with non-template base implementation
+template<typename Config>
+class Column {
+    std::string_view name_;
+
+public:
+    explicit Column(std::string_view name) : name_(name) {}
+    [[nodiscard]] std::string_view name() const { return name_; }
+
+    [[nodiscard]] Condition<Config> isNull() const {
+        return Condition<Config>::isNull(name_);
+    }
+
+    [[nodiscard]] Condition<Config> isNotNull() const {
+        return Condition<Config>::isNotNull(name_);
+    }
+
+    template<SqlCompatible T>
+    [[nodiscard]] Condition<Config> eq(T&& value) const {
+        using Op = typename ConditionBase<Config>::Op;
+        return Condition<Config>(name_, Op::Eq, SqlValue<Config>(std::forward<T>(value)));
+    }
+
+    template<SqlCompatible T>
+    [[nodiscard]] Condition<Config> ne(T&& value) const {
+        using Op = typename ConditionBase<Config>::Op;
+        return Condition<Config>(name_, Op::Ne, SqlValue<Config>(std::forward<T>(value)));
+    }
+
+    template<SqlCompatible T>
+    [[nodiscard]] Condition<Config> lt(T&& value) const {
+        using Op = typename ConditionBase<Config>::Op;
+        return Condition<Config>(name_, Op::Lt, SqlValue<Config>(std::forward<T>(value)));
+    }
+
+    template<SqlCompatible T>
+    [[nodiscard]] Condition<Config> le(T&& value) const {
+        using Op = typename ConditionBase<Config>::Op;
+        return Condition<Config>(name_, Op::Le, SqlValue<Config>(std::forward<T>(value)));
+    }
+
+    template<SqlCompatible T>
+    [[nodiscard]] Condition<Config> gt(T&& value) const {
+        using Op = typename ConditionBase<Config>::Op;
+        return Condition<Config>(name_, Op::Gt, SqlValue<Config>(std::forward<T>(value)));
+    }
+
+    template<SqlCompatible T>
+    [[nodiscard]] Condition<Config> ge(T&& value) const {
+        using Op = typename ConditionBase<Config>::Op;
+        return Condition<Config>(name_, Op::Ge, SqlValue<Config>(std::forward<T>(value)));
+    }
+
+    [[nodiscard]] Condition<Config> like(std::string_view pattern) const {
+        using Op = typename ConditionBase<Config>::Op;
+        return Condition<Config>(name_, Op::Like, SqlValue<Config>(pattern));
+    }
+
+    [[nodiscard]] Condition<Config> notLike(std::string_view pattern) const {
+        using Op = typename ConditionBase<Config>::Op;
+        return Condition<Config>(name_, Op::NotLike, SqlValue<Config>(pattern));
+    }
+
+    template<SqlCompatible T, SqlCompatible U>
+    [[nodiscard]] Condition<Config> between(T&& start, U&& end) const {
+        using Op = typename ConditionBase<Config>::Op;
+        return Condition<Config>(
+            name_,
+            Op::Between,
+            SqlValue<Config>(std::forward<T>(start)),
+            SqlValue<Config>(std::forward<U>(end))
+            );
+    }
+
+    template<typename U>
+    [[nodiscard]] Condition<Config> in(std::span<const U> values) const {
+        return Condition<Config>::in(name_, values);
+    }
+
+    template<typename U>
+    [[nodiscard]] Condition<Config> notIn(std::span<const U> values) const {
+        return Condition<Config>::notIn(name_, values);
+    }
+
+    [[nodiscard]] Condition<Config> eq(const SqlValue<Config>& value) const {
+        using Op = typename ConditionBase<Config>::Op;
+        return Condition<Config>(name_, Op::Eq, value);
+    }
+
+    [[nodiscard]] Condition<Config> ne(const SqlValue<Config>& value) const {
+        using Op = typename ConditionBase<Config>::Op;
+        return Condition<Config>(name_, Op::Ne, value);
+    }
+
+    [[nodiscard]] Condition<Config> lt(const SqlValue<Config>& value) const {
+        using Op = typename ConditionBase<Config>::Op;
+        return Condition<Config>(name_, Op::Lt, value);
+    }
+
+    [[nodiscard]] Condition<Config> le(const SqlValue<Config>& value) const {
+        using Op = typename ConditionBase<Config>::Op;
+        return Condition<Config>(name_, Op::Le, value);
+    }
+
+    [[nodiscard]] Condition<Config> gt(const SqlValue<Config>& value) const {
+        using Op = typename ConditionBase<Config>::Op;
+        return Condition<Config>(name_, Op::Gt, value);
+    }
+
+    [[nodiscard]] Condition<Config> ge(const SqlValue<Config>& value) const {
+        using Op = typename ConditionBase<Config>::Op;
+        return Condition<Config>(name_, Op::Ge, value);
+    }
+};
+
+template<typename T, typename Config>
+Condition<Config> TypedColumn<T, Config>::isNull() const {
+    return Condition<Config>::isNull(name_);
+}
+
+template<typename T, typename Config>
+Condition<Config> TypedColumn<T, Config>::isNotNull() const {
+    return Condition<Config>::isNotNull(name_);
+}
+
+template<typename T, typename Config>
+template<SqlCompatible U>
+Condition<Config> TypedColumn<T, Config>::eq(U&& value) const {
+    using Op = typename ConditionBase<Config>::Op;
+    return Condition<Config>(name_, Op::Eq, SqlValue<Config>(std::forward<U>(value)));
+}
+
+template<typename T, typename Config>
+template<typename OtherType, typename OtherConfig>
+Condition<Config> TypedColumn<T, Config>::eq(const TypedColumn<OtherType, OtherConfig>& other) const {
+    using Op = typename ConditionBase<Config>::Op;
+    return Condition<Config>(table_, name_, Op::Eq, other.tableName(), other.name());
+}
+
+template<typename T, typename Config>
+template<SqlCompatible U>
+Condition<Config> TypedColumn<T, Config>::ne(U&& value) const {
+    using Op = typename ConditionBase<Config>::Op;
+    return Condition<Config>(name_, Op::Ne, SqlValue<Config>(std::forward<U>(value)));
+}
+
+template<typename T, typename Config>
+template<typename OtherType, typename OtherConfig>
+Condition<Config> TypedColumn<T, Config>::ne(const TypedColumn<OtherType, OtherConfig>& other) const {
+    using Op = typename ConditionBase<Config>::Op;
+    return Condition<Config>(table_, name_, Op::Ne, other.tableName(), other.name());
+}
+
+template<typename T, typename Config>
+template<SqlCompatible U>
+Condition<Config> TypedColumn<T, Config>::lt(U&& value) const {
+    using Op = typename ConditionBase<Config>::Op;
+    return Condition<Config>(name_, Op::Lt, SqlValue<Config>(std::forward<U>(value)));
+}
+
+template<typename T, typename Config>
+template<typename OtherType, typename OtherConfig>
+Condition<Config> TypedColumn<T, Config>::lt(const TypedColumn<OtherType, OtherConfig>& other) const {
+    using Op = typename ConditionBase<Config>::Op;
+    return Condition<Config>(table_, name_, Op::Lt, other.tableName(), other.name());
+}
+
+template<typename T, typename Config>
+template<SqlCompatible U>
+Condition<Config> TypedColumn<T, Config>::le(U&& value) const {
+    using Op = typename ConditionBase<Config>::Op;
+    return Condition<Config>(name_, Op::Le, SqlValue<Config>(std::forward<U>(value)));
+}
+
+template<typename T, typename Config>
+template<typename OtherType, typename OtherConfig>
+Condition<Config> TypedColumn<T, Config>::le(const TypedColumn<OtherType, OtherConfig>& other) const {
+    using Op = typename ConditionBase<Config>::Op;
+    return Condition<Config>(table_, name_, Op::Le, other.tableName(), other.name());
+}
+
+template<typename T, typename Config>
+template<SqlCompatible U>
+Condition<Config> TypedColumn<T, Config>::gt(U&& value) const {
+    using Op = typename ConditionBase<Config>::Op;
+    return Condition<Config>(name_, Op::Gt, SqlValue<Config>(std::forward<U>(value)));
+}
+
+template<typename T, typename Config>
+template<typename OtherType, typename OtherConfig>
+Condition<Config> TypedColumn<T, Config>::gt(const TypedColumn<OtherType, OtherConfig>& other) const {
+    using Op = typename ConditionBase<Config>::Op;
+    return Condition<Config>(table_, name_, Op::Gt, other.tableName(), other.name());
+}
+
+template<typename T, typename Config>
+template<SqlCompatible U>
+Condition<Config> TypedColumn<T, Config>::ge(U&& value) const {
+    using Op = typename ConditionBase<Config>::Op;
+    return Condition<Config>(name_, Op::Ge, SqlValue<Config>(std::forward<U>(value)));
+}
+
+template<typename T, typename Config>
+template<typename OtherType, typename OtherConfig>
+Condition<Config> TypedColumn<T, Config>::ge(const TypedColumn<OtherType, OtherConfig>& other) const {
+    using Op = typename ConditionBase<Config>::Op;
+    return Condition<Config>(table_, name_, Op::Ge, other.tableName(), other.name());
+}
+
+template<typename T, typename Config>
+Condition<Config> TypedColumn<T, Config>::like(std::string_view pattern) const {
+    using Op = typename ConditionBase<Config>::Op;
+    return Condition<Config>(name_, Op::Like, SqlValue<Config>(pattern));
+}
+
+template<typename T, typename Config>
+Condition<Config> TypedColumn<T, Config>::notLike(std::string_view pattern) const {
+    using Op = typename ConditionBase<Config>::Op;
+    return Condition<Config>(name_, Op::NotLike, SqlValue<Config>(pattern));
+}
+
+template<typename T, typename Config>
+template<SqlCompatible T1, SqlCompatible T2>
+Condition<Config> TypedColumn<T, Config>::between(T1&& start, T2&& end) const {
+    using Op = typename ConditionBase<Config>::Op;
+    return Condition<Config>(
+        name_,
+        Op::Between,
+        SqlValue<Config>(std::forward<T1>(start)),
+        SqlValue<Config>(std::forward<T2>(end))
+        );
+}
+
+template<typename T, typename Config>
+template<typename U>
+Condition<Config> TypedColumn<T, Config>::in(std::span<const U> values) const {
+    return Condition<Config>::in(name_, values);
+}
+
+template<typename T, typename Config>
+template<typename U>
+Condition<Config> TypedColumn<T, Config>::notIn(std::span<const U> values) const {
+    return Condition<Config>::notIn(name_, values);
+}
+
+// Operator overloads for TypedColumn
+template<typename T, typename Config, SqlCompatible U>
+inline Condition<Config> operator==(const TypedColumn<T, Config>& col, U&& val) {
+    return col.eq(std::forward<U>(val));
+}
+
+template<typename T, typename U, typename ConfigT, typename ConfigU>
+inline Condition<ConfigT> operator==(const TypedColumn<T, ConfigT>& col1, const TypedColumn<U, ConfigU>& col2) {
+    return col1.eq(col2);
+}
+
+template<typename T, typename Config, SqlCompatible U>
+inline Condition<Config> operator!=(const TypedColumn<T, Config>& col, U&& val) {
+    return col.ne(std::forward<U>(val));
+}
+
+template<typename T, typename U, typename ConfigT, typename ConfigU>
+inline Condition<ConfigT> operator!=(const TypedColumn<T, ConfigT>& col1, const TypedColumn<U, ConfigU>& col2) {
+    return col1.ne(col2);
+}
+
+template<typename T, typename Config, SqlCompatible U>
+inline Condition<Config> operator<(const TypedColumn<T, Config>& col, U&& val) {
+    return col.lt(std::forward<U>(val));
+}
+
+template<typename T, typename U, typename ConfigT, typename ConfigU>
+inline Condition<ConfigT> operator<(const TypedColumn<T, ConfigT>& col1, const TypedColumn<U, ConfigU>& col2) {
+    return col1.lt(col2);
+}
+
+template<typename T, typename Config, SqlCompatible U>
+inline Condition<Config> operator<=(const TypedColumn<T, Config>& col, U&& val) {
+    return col.le(std::forward<U>(val));
+}
+
+template<typename T, typename U, typename ConfigT, typename ConfigU>
+inline Condition<ConfigT> operator<=(const TypedColumn<T, ConfigT>& col1, const TypedColumn<U, ConfigU>& col2) {
+    return col1.le(col2);
+}
+
+template<typename T, typename Config, SqlCompatible U>
+inline Condition<Config> operator>(const TypedColumn<T, Config>& col, U&& val) {
+    return col.gt(std::forward<U>(val));
+}
+
+template<typename T, typename U, typename ConfigT, typename ConfigU>
+inline Condition<ConfigT> operator>(const TypedColumn<T, ConfigT>& col1, const TypedColumn<U, ConfigU>& col2) {
+    return col1.gt(col2);
+}
+
+template<typename T, typename Config, SqlCompatible U>
+inline Condition<Config> operator>=(const TypedColumn<T, Config>& col, U&& val) {
+    return col.ge(std::forward<U>(val));
+}
+
+template<typename T, typename U, typename ConfigT, typename ConfigU>
+inline Condition<ConfigT> operator>=(const TypedColumn<T, ConfigT>& col1, const TypedColumn<U, ConfigU>& col2) {
+    return col1.ge(col2);
+}
+
+// Operator overloads for Column
+template<typename Config>
+inline Condition<Config> operator==(const Column<Config>& col, const SqlValue<Config>& val) {
+    return col.eq(val);
+}
+
+template<typename Config, SqlCompatible T>
+inline Condition<Config> operator==(const Column<Config>& col, T&& val) {
+    return col.eq(std::forward<T>(val));
+}
+
+template<typename Config>
+inline Condition<Config> operator==(const Column<Config>& col, const std::string& val) {
+    return col.eq(std::string_view(val));
+}
+
+template<typename Config>
+inline Condition<Config> operator!=(const Column<Config>& col, const SqlValue<Config>& val) {
+    return col.ne(val);
+}
+
+template<typename Config, SqlCompatible T>
+inline Condition<Config> operator!=(const Column<Config>& col, T&& val) {
+    return col.ne(std::forward<T>(val));
+}
+
+template<typename Config>
+inline Condition<Config> operator<(const Column<Config>& col, const SqlValue<Config>& val) {
+    return col.lt(val);
+}
+
+template<typename Config, SqlCompatible T>
+inline Condition<Config> operator<(const Column<Config>& col, T&& val) {
+    return col.lt(std::forward<T>(val));
+}
+
+template<typename Config>
+inline Condition<Config> operator<=(const Column<Config>& col, const SqlValue<Config>& val) {
+    return col.le(val);
+}
+
+template<typename Config, SqlCompatible T>
+inline Condition<Config> operator<=(const Column<Config>& col, T&& val) {
+    return col.le(std::forward<T>(val));
+}
+
+template<typename Config>
+inline Condition<Config> operator>(const Column<Config>& col, const SqlValue<Config>& val) {
+    return col.gt(val);
+}
+
+template<typename Config, SqlCompatible T>
+inline Condition<Config> operator>(const Column<Config>& col, T&& val) {
+    return col.gt(std::forward<T>(val));
+}
+
+template<typename Config>
+inline Condition<Config> operator>=(const Column<Config>& col, const SqlValue<Config>& val) {
+    return col.ge(val);
+}
+
+template<typename Config, SqlCompatible T>
+inline Condition<Config> operator>=(const Column<Config>& col, T&& val) {
+    return col.ge(std::forward<T>(val));
+}
+// new
+template<typename T, typename Config>
+inline Condition<Config> operator==(const TypedColumn<T, Config>& col, const SqlValue<Config>& val) {
+    return col.eq(val);
+}
+
+template<typename T, typename Config>
+inline Condition<Config> operator!=(const TypedColumn<T, Config>& col, const SqlValue<Config>& val) {
+    return col.ne(val);
+}
+
+template<typename T, typename Config>
+inline Condition<Config> operator<(const TypedColumn<T, Config>& col, const SqlValue<Config>& val) {
+    return col.lt(val);
+}
+
+template<typename T, typename Config>
+inline Condition<Config> operator<=(const TypedColumn<T, Config>& col, const SqlValue<Config>& val) {
+    return col.le(val);
+}
+
+template<typename T, typename Config>
+inline Condition<Config> operator>(const TypedColumn<T, Config>& col, const SqlValue<Config>& val) {
+    return col.gt(val);
+}
+
+template<typename T, typename Config>
+inline Condition<Config> operator>=(const TypedColumn<T, Config>& col, const SqlValue<Config>& val) {
+    return col.ge(val);
+}
+
+// Qt type operator overloads
+#ifdef SQLQUERYBUILDER_USE_QT
+template<typename Config>
+inline Condition<Config> operator==(const Column<Config>& col, const QString& val) {
+    return col.eq(std::string_view(val.toStdString()));
+}
+
+template<typename Config>
+inline Condition<Config> operator!=(const Column<Config>& col, const QString& val) {
+    return col.ne(std::string_view(val.toStdString()));
+}
+
+template<typename Config>
+inline Condition<Config> operator<(const Column<Config>& col, const QDateTime& val) {
+    return col.lt(val);
+}
+
+template<typename Config>
+inline Condition<Config> operator<=(const Column<Config>& col, const QDateTime& val) {
+    return col.le(val);
+}
+
+template<typename Config>
+inline Condition<Config> operator>(const Column<Config>& col, const QDateTime& val) {
+    return col.gt(val);
+}
+
+template<typename Config>
+inline Condition<Config> operator>=(const Column<Config>& col, const QDateTime& val) {
+    return col.ge(val);
+}
+
+inline std::ostream& operator<<(std::ostream& os, const QString& str) {
+    return os << str.toStdString();
+}
+#endif
+
+// SQL function types
+enum class SqlFunction {
+    None,
+    Count,
+    Sum,
+    Avg,
+    Min,
+    Max,
+    GroupConcat
+};
+
+// Column reference
+template<typename Config = DefaultConfig>
+class ColumnRef {
+private:
+    std::string_view column_;
+    SqlFunction function_ = SqlFunction::None;
+    std::string_view alias_; // Optional column alias
+
+public:
+    ColumnRef() = default;
+
+    explicit ColumnRef(std::string_view column, SqlFunction function = SqlFunction::None, std::string_view alias = "")
+        : column_(column), function_(function), alias_(alias) {}
+
+    std::string_view column() const { return column_; }
+    SqlFunction function() const { return function_; }
+    std::string_view alias() const { return alias_; }
+
+    // Create an aliased column
+    ColumnRef as(std::string_view alias) const {
+        return ColumnRef(column_, function_, alias);
+    }
+
+    template<SqlSink Out>
+    void toSql(Out& query) const {
+        switch (function_) {
+        case SqlFunction::Count:
+            query += "COUNT(";
+            query += column_;
+            query += ")";
+            break;
+        case SqlFunction::Sum:
+            query += "SUM(";
+            query += column_;
+            query += ")";
+            break;
+        case SqlFunction::Avg:
+            query += "AVG(";
+            query += column_;
+            query += ")";
+            break;
+        case SqlFunction::Min:
+            query += "MIN(";
+            query += column_;
+            query += ")";
+            break;
+        case SqlFunction::Max:
+            query += "MAX(";
+            query += column_;
+            query += ")";
+            break;
+        case SqlFunction::GroupConcat:
+            query += "GROUP_CONCAT(";
+            query += column_;
+            query += ")";
+            break;
+        case SqlFunction::None:
+        default:
+            query += column_;
+            break;
+        }
+
+        if (!alias_.empty()) {
+            query += " AS ";
+            query += alias_;
+        }
+    }
+};
+
+namespace detail {
+// Index hint written after a table name and its alias. PostgreSQL has
+// none; its hints go into a comment ahead of the statement.
+template<typename Dialect, SqlSink Out>
+void appendIndexHint(Out& out, std::string_view index) {
+    if (index.empty()) {
+        return;
+    }
+    if constexpr(Dialect::index_hint == IndexHintSyntax::IndexedBy) {
+        out += " INDEXED BY ";
+        out += index;
+    } else if constexpr(Dialect::index_hint == IndexHintSyntax::UseIndex) {
+        out += " USE INDEX (";
+        out += index;
+        out += ")";
+    }
+}
+} // namespace detail
+
+// Join class
+template<typename Config>
+class Join {
+public:
+    enum class Type : uint8_t { Inner, Left, Right, Full, Cross };
+
+private:
+    Type type_;
+    uint32_t on_{TextOnly};  // Index of the ON condition kept by the builder
+    std::string_view table_;
+    std::string_view condition_;
+    std::string_view index_;  // See QueryBuilder::useIndex()
+
+public:
+    // The ON clause is only the text; a join whose condition has values
+    // renders it from the Condition the builder keeps instead
+    static constexpr uint32_t TextOnly = UINT32_MAX;
+
+    Join() = default;
+
+    Join(Type type, std::string_view table, std::string_view condition)
+        : type_(type), table_(table), condition_(condition) {}
+
+    [[nodiscard]] std::string_view table() const { return table_; }
+    [[nodiscard]] std::string_view index() const { return index_; }
+    void setIndex(std::string_view index) { index_ = index; }
+
+    [[nodiscard]] uint32_t conditionIndex() const { return on_; }
+    void setConditionIndex(uint32_t index) { on_ = index; }
+
+    // With `on`, the ON condition is rendered from it, its values becoming
+    // slots in `binds` like those of the WHERE clause
+    template<SqlSink Out>
+    void toString(Out& query, const Condition<Config>* on = nullptr, BindCollector* binds = nullptr) const {
+        const char* type_str = "";
+        switch (type_) {
+        case Type::Inner: type_str = "INNER JOIN"; break;
+        case Type::Left:  type_str = "LEFT JOIN"; break;
+        case Type::Right: type_str = "RIGHT JOIN"; break;
+        case Type::Full:  type_str = "FULL JOIN"; break;
+        case Type::Cross: type_str = "CROSS JOIN"; break;
+        }
+
+        query += type_str;
+        query += " ";
+        query += table_;
+        detail::appendIndexHint<DialectOf<Config>>(query, index_);
+        query += " ON ";
+        if (on) {
+            on->toString(query, binds);
+        } else {
+            query += condition_;
+        }
+    }
+
+    [[nodiscard]] std::string toString() const {
+        std::string result;
+        result.reserve(table_.size() + condition_.size() + 20);
+        toString(result);
+        return result;
+    }
+
+    void hashShape(detail::ShapeHash& hash) const {
+        hash.add(static_cast<uint64_t>(type_));
+        hash.add(table_);
+        if (on_ == TextOnly) {
+            hash.add(condition_);  // Otherwise hashed by shape with the kept condition
+        } else {
+            hash.add(uint64_t{on_});
+        }
+        hash.add(index_);
+    }
+};
+
+// Placeholder class to represent a SQL parameter placeholder. Trivially
+// copyable: the name is a view that, like column names, must outlive the query.
+template <typename Config>
+class Placeholder {
+public:
+    using Style = PlaceholderStyle;
+
+private:
+    std::string_view id_;  // Name without its prefix, empty for "?"
+    Style style_{Style::QuestionMark};
+
+public:
+    constexpr explicit Placeholder(std::string_view name = "") : id_(name) {
+        if (name.empty() || name == "?") {
+            id_ = {};
+        } else if (name[0] == ':') {
+            style_ = Style::Colon;
+            id_ = name.substr(1);
+        } else if (name[0] == '@') {
+            style_ = Style::At;
+            id_ = name.substr(1);
+        } else if (name[0] == '$') {
+            style_ = Style::Dollar;
+            id_ = name.substr(1);
+        } else {
+            style_ = Style::Colon;
+        }
+    }
+
+    // The name would dangle; keep generated names alive, e.g. in a StringArena
+    template<typename S>
+        requires std::same_as<S, std::string>
+    explicit Placeholder(S&&) = delete;
+
+    // Same placeholder under another config
+    template<typename OtherConfig>
+    constexpr explicit Placeholder(const Placeholder<OtherConfig>& other)
+        : id_(other.id()), style_(other.style()) {}
+
+    [[nodiscard]] std::string toString() const {
+        std::string result;
+        appendSql(result);
+        return result;
+    }
+
+    template<SqlSink Out>
+    void appendSql(Out& out) const {
+        if (style_ == Style::QuestionMark) {
+            out += '?';
+            return;
+        }
+        out.push_back(prefix());
+        out += id_;
+    }
+
+    // Token as written in the SQL (":id", "@id", "$1"), empty for "?"
+    [[nodiscard]] std::string name() const {
+        if (style_ == Style::QuestionMark) {
+            return std::string();
+        }
+        std::string token(1, prefix());
+        token += id_;
+        return token;
+    }
+
+    [[nodiscard]] constexpr std::string_view id() const { return id_; }
+    [[nodiscard]] constexpr Style style() const { return style_; }
+
+    [[nodiscard]] constexpr char prefix() const {
+        switch (style_) {
+        case Style::Colon: return ':';
+        case Style::At: return '@';
+        case Style::Dollar: return '$';
+        default: return '?';
+        }
+    }
+
+    [[nodiscard]] constexpr bool isPlaceholder() const { return true; }
+};
+
+// A condition is its tag, column, one value and the side entry. Builders keep
+// MaxConditions of them inline, so growth here multiplies into every builder.
+static_assert(sizeof(Condition<DefaultConfig>) <= sizeof(void*) + sizeof(std::string_view) +
+                                                       sizeof(SqlValue<DefaultConfig>) + sizeof(std::shared_ptr<void>),
+              "Condition payloads belong in the side entry");
+
+// A class that holds a fluent where builder for complex conditions
+template<typename Config>
+class WhereBuilder {
+private:
+    using ConditionFn = std::function<void(WhereBuilder<Config>&)>;
+    Condition<Config> condition_;
+
+public:
+    WhereBuilder() = default;
+
+    WhereBuilder& condition(Condition<Config> cond) {
+        condition_ = std::move(cond);
+        return *this;
+    }
+
+    WhereBuilder& and_(Condition<Config> cond) {
+        if (condition_.isValid()) {
+            condition_ = std::move(condition_) && std::move(cond);
+        } else {
+            condition_ = std::move(cond);
+        }
+        return *this;
+    }
+
+    WhereBuilder& or_(Condition<Config> cond) {
+        if (condition_.isValid()) {
+            condition_ = std::move(condition_) || std::move(cond);
+        } else {
+            condition_ = std::move(cond);
+        }
+        return *this;
+    }
+
+    WhereBuilder& and_(ConditionFn builder) {
+        WhereBuilder<Config> subBuilder;
+        builder(subBuilder);
+        return and_(std::move(subBuilder).build());
+    }
+
+    WhereBuilder& or_(ConditionFn builder) {
+        WhereBuilder<Config> subBuilder;
+        builder(subBuilder);
+        return or_(std::move(subBuilder).build());
+    }
+
+    Condition<Config> build() const& {
+        return condition_;
+    }
+
+    Condition<Config> build() && {
+        return std::move(condition_);
+    }
+
+    operator Condition<Config>() const& {
+        return build();
+    }
+
+    operator Condition<Config>() && {
+        return std::move(*this).build();
+    }
+};
+
+
+namespace detail {
+// Text of one statement in an SqlPool, hashed once when it is added
+inline uint64_t hashText(std::string_view text) {
+    return static_cast<uint64_t>(std::hash<std::string_view>{}(text));
+}
+
+struct InternedText {
+    std::string text;
+    uint64_t hash;
+#ifdef SQLQUERYBUILDER_USE_QT
+    QString qtext;  // Converted once; copies share it through implicit sharing
+#endif
+
+    InternedText(std::string_view sql, uint64_t sqlHash)
+        : text(sql), hash(sqlHash)
+#ifdef SQLQUERYBUILDER_USE_QT
+        , qtext(QString::fromUtf8(text.data(), static_cast<int>(text.size())))
+#endif
+    {}
+};
+
+inline const InternedText& emptyText() {
+    static const InternedText entry(std::string_view(), hashText({}));
+    return entry;
+}
+} // namespace detail
+
+// Handle to statement text kept once in an SqlPool. Equal texts of one
+// pool share a handle, so comparing or hashing a handle costs a word
+// whatever the length of the SQL. Trivially copyable; valid while its pool
+// lives, which for SqlPool::global() is the whole process.
+class InternedSql {
+private:
+    const detail::InternedText* entry_{&detail::emptyText()};
+
+    explicit InternedSql(const detail::InternedText* entry) : entry_(entry) {}
+    friend class SqlPool;
+
+public:
+    struct Hash {
+        size_t operator()(InternedSql sql) const { return static_cast<size_t>(sql.hash()); }
+    };
+
+    InternedSql() = default;
+
+    [[nodiscard]] const std::string& str() const { return entry_->text; }
+    [[nodiscard]] std::string_view view() const { return entry_->text; }
+    [[nodiscard]] const char* c_str() const { return entry_->text.c_str(); }
+    [[nodiscard]] size_t size() const { return entry_->text.size(); }
+    [[nodiscard]] bool empty() const { return entry_->text.empty(); }
+
+    // Hash of the text, computed when it was interned
+    [[nodiscard]] uint64_t hash() const { return entry_->hash; }
+
+#ifdef SQLQUERYBUILDER_USE_QT
+    [[nodiscard]] const QString& qstring() const { return entry_->qtext; }
+#endif
+
+    operator std::string_view() const { return view(); }
+
+    friend bool operator==(InternedSql left, InternedSql right) { return left.entry_ == right.entry_; }
+};
+
+// Pool of statement texts, each stored once however many builders produce
+// it. Entries are never removed, so intern statement shapes (compiled
+// with placeholders), not SQL with literal values spliced in. Thread-safe:
+// lookups are spread over independently locked shards.
+class SqlPool {
+public:
+    struct Stats {
+        size_t hits{0};
+        size_t misses{0};
+        size_t entries{0};
+        size_t bytes{0};
+    };
+
+private:
+    static constexpr size_t ShardCount = 16;
+
+    struct Shard {
+        mutable std::mutex mutex;
+        std::unordered_multimap<uint64_t, detail::InternedText> entries;  // Nodes do not move
+        size_t bytes{0};
+        size_t hits{0};
+        size_t misses{0};
+    };
+
+    std::array<Shard, ShardCount> shards_;
+
+public:
+    SqlPool() = default;
+    SqlPool(const SqlPool&) = delete;
+    SqlPool& operator=(const SqlPool&) = delete;
+
+    // Process-wide pool. It is never destroyed, so its handles stay valid
+    // in static destructors too.
+    [[nodiscard]] static SqlPool& global() {
+        static SqlPool* pool = new SqlPool();
+        return *pool;
+    }
+
+    [[nodiscard]] InternedSql intern(std::string_view text) {
+        if (text.empty()) {
+            return InternedSql();
+        }
+        const uint64_t hash = detail::hashText(text);
+        Shard& shard = shards_[hash % ShardCount];
+
+        std::lock_guard lock(shard.mutex);
+        auto [it, end] = shard.entries.equal_range(hash);
+        for (; it != end; ++it) {
+            if (it->second.text == text) {
+                ++shard.hits;
+                return InternedSql(&it->second);
+            }
+        }
+        ++shard.misses;
+        shard.bytes += text.size();
+        return InternedSql(&shard.entries.emplace(std::piecewise_construct, std::forward_as_tuple(hash),
+                                                  std::forward_as_tuple(text, hash))->second);
+    }
+
+    [[nodiscard]] Stats stats() const {
+        Stats total;
+        for (const auto& shard : shards_) {
+            std::lock_guard lock(shard.mutex);
+            total.hits += shard.hits;
+            total.misses += shard.misses;
+            total.entries += shard.entries.size();
+            total.bytes += shard.bytes;
+        }
+        return total;
+    }
+};
+
+// Immutable compiled statement: SQL text built once, with a table of the
+// placeholder slots it contains. Bind values by slot index when executing.
+template<typename Config = DefaultConfig>
+class CompiledQuery {
+private:
+    std::string sql_;  // Empty once the text is interned
+    std::optional<InternedSql> interned_;
+    std::vector<BindSlot> slots_;
+    QueryError error_;
+
+public:
+    CompiledQuery() = default;
+
+    CompiledQuery(std::string sql, std::vector<BindSlot> slots)
+        : sql_(std::move(sql)), slots_(std::move(slots)) {}
+
+    explicit CompiledQuery(QueryError error)
+        : sql_("/* ERROR: " + std::string(error.message) + " */"), error_(error) {}
+
+    [[nodiscard]] const std::string& sql() const { return interned_ ? interned_->str() : sql_; }
+    [[nodiscard]] std::span<const BindSlot> slots() const { return slots_; }
+    [[nodiscard]] size_t slotCount() const { return slots_.size(); }
+
+    [[nodiscard]] bool hasError() const { return static_cast<bool>(error_); }
+    [[nodiscard]] const QueryError& error() const { return error_; }
+
+    // Move the text into `pool`, so that this statement and its copies share
+    // the pooled text and can be keyed by the handle
+    InternedSql intern(SqlPool& pool = SqlPool::global()) {
+        if (!interned_) {
+            interned_ = pool.intern(sql_);
+            sql_ = std::string();
+        }
+        return *interned_;
+    }
+
+    // Handle to the text, if intern() was called
+    [[nodiscard]] std::optional<InternedSql> interned() const { return interned_; }
+
+    // Index of the first slot with the given placeholder name (":id", "@id", "$1")
+    [[nodiscard]] std::optional<size_t> slotIndex(std::string_view name) const {
+        for (size_t i = 0; i < slots_.size(); ++i) {
+            if (slots_[i].name == name) {
+                return i;
+            }
+        }
+        return std::nullopt;
+    }
+
+    // Splice literal values into the slots, for drivers without prepared
+    // statements. Only the values are formatted; the clauses are not rebuilt.
+    [[nodiscard]] Result<std::string> render(std::span<const SqlValue<Config>> values) const {
+        if (values.size() != slots_.size()) {
+            return QueryError(QueryError::Code::InvalidOperation,
+                              "Bind value count does not match placeholder count");
+        }
+
+        const std::string& sql = this->sql();
+        std::string query;
+        query.reserve(sql.size() + values.size() * 16);
+
+        size_t pos = 0;
+        for (size_t i = 0; i < slots_.size(); ++i) {
+            query.append(sql, pos, slots_[i].offset - pos);
+            values[i].appendSql(query);
+            pos = slots_[i].offset + slots_[i].length;
+        }
+        query.append(sql, pos, std::string::npos);
+        return Result<std::string>(std::move(query));
+    }
+
+    // The statement in the dialect's EXPLAIN form, with its slots moved
+    // along, so that it binds and runs like the statement itself. An error
+    // if the dialect has no form for `mode`.
+    [[nodiscard]] CompiledQuery explain(ExplainMode mode = ExplainMode::Plan) const {
+        if (hasError()) {
+            return *this;
+        }
+        const auto prefix = mode == ExplainMode::Analyze ? DialectOf<Config>::explain_analyze
+                                                         : DialectOf<Config>::explain;
+        if (prefix.empty()) {
+            return CompiledQuery(QueryError(QueryError::Code::InvalidOperation,
+                                            "EXPLAIN ANALYZE is not supported by this dialect"));
+        }
+
+        // A pg_hint_plan comment has to stay at the start to be read
+        const std::string& sql = this->sql();
+        const size_t hints = sql.starts_with("/*+ ") ? sql.find("*/ ") + 3 : 0;
+        std::string query;
+        query.reserve(prefix.size() + 1 + sql.size());
+        query.append(sql, 0, hints);
+        query += prefix;
+        query += ' ';
+        query.append(sql, hints, std::string::npos);
+        auto slots = slots_;
+        for (auto& slot : slots) {
+            slot.offset += prefix.size() + 1;
+        }
+        return CompiledQuery(std::move(query), std::move(slots));
+    }
+};
+
+// The value an upsert tried to insert into a column, for the update of an
+// existing row: excluded.column, or VALUES(column) in MySQL
+struct Excluded {
+    std::string_view column;
+};
+
+template<typename Col>
+    requires std::is_convertible_v<Col, std::string_view>
+[[nodiscard]] constexpr Excluded excluded(const Col& column) {
+    return Excluded{static_cast<std::string_view>(column)};
+}
+
+namespace detail {
+enum class UpsertAction : uint8_t { None, Nothing, Update };
+
+// ON CONFLICT ... DO UPDATE names the key it updates on; only MySQL's
+// ON DUPLICATE KEY UPDATE works without one
+template<typename Dialect>
+constexpr bool upsertMissingKeys(UpsertAction action, std::span<const std::string_view> keys) {
+    return Dialect::upsert == UpsertSyntax::OnConflict && action == UpsertAction::Update && keys.empty();
+}
+
+// " ON CONFLICT (keys) DO UPDATE SET " and its dialect variants, up to the
+// first assignment. MySQL has no conflict target, and spells DO NOTHING as a
+// no-op assignment to `fallback`.
+template<typename Dialect, SqlSink Out>
+void appendUpsertHead(Out& out, std::span<const std::string_view> keys, UpsertAction action,
+                      std::string_view fallback) {
+    out += " ";
+    if constexpr(Dialect::upsert == UpsertSyntax::OnConflict) {
+        out += keywords::ON_CONFLICT;
+        if (!keys.empty()) {
+            out += " (";
+            for (size_t i = 0; i < keys.size(); ++i) {
+                if (i > 0) out += ", ";
+                out += keys[i];
+            }
+            out += ")";
+        }
+        out += " ";
+        out += action == UpsertAction::Update ? keywords::DO_UPDATE_SET : keywords::DO_NOTHING;
+    } else {
+        out += keywords::ON_DUPLICATE_KEY_UPDATE;
+        if (action == UpsertAction::Nothing) {
+            const std::string_view column = keys.empty() ? fallback : keys[0];
+            out += " ";
+            out += column;
+            out += " = ";
+            out += column;
+        }
+    }
+    if (action == UpsertAction::Update) {
+        out += " ";
+    }
+}
+
+template<typename Dialect, SqlSink Out>
+void appendExcluded(Out& out, std::string_view column) {
+    if constexpr(Dialect::upsert == UpsertSyntax::OnConflict) {
+        out += "excluded.";
+        out += column;
+    } else {
+        out += keywords::VALUES;
+        out += "(";
+        out += column;
+        out += ")";
+    }
+}
+} // namespace detail
+
+// Multi-row INSERT writer. Rows are rendered into a reused buffer and each
+// finished statement is handed to a sink, split by row count and/or size.
+template<typename Config = DefaultConfig>
+class BatchInsert {
+public:
+    // Receives the values of one row from a row generator
+    class RowWriter {
+    private:
+        std::string& out_;
+        std::vector<std::pair<size_t, size_t>>* spans_;  // Offsets of each value, if wanted
+        std::vector<SqlValue<Config>>* bound_{nullptr};    // Collects the values instead, if set
+        BindCollector* markers_{nullptr};  // Positions of "$n" markers, renumbered per statement
+        size_t count_{0};
+
+    public:
+        explicit RowWriter(std::string& out, std::vector<std::pair<size_t, size_t>>* spans = nullptr,
+                           BindCollector* markers = nullptr)
+            : out_(out), spans_(spans), markers_(markers) {}
+
+        explicit RowWriter(std::string& out, std::vector<SqlValue<Config>>& bound)
+            : out_(out), spans_(nullptr), bound_(&bound) {}
+
+        template<SqlCompatible T>
+        RowWriter& value(T&& val) {
+            return value(SqlValue<Config>(std::forward<T>(val)));
+        }
+
+        RowWriter& value(const SqlValue<Config>& val) {
+            if (bound_) {
+                ++count_;
+                bound_->push_back(val);
+                return *this;
+            }
+            if (count_++ > 0) out_ += ", ";
+            const size_t begin = out_.size();
+            val.appendSql(out_, markers_);
+            if (spans_) spans_->emplace_back(begin, out_.size());
+            return *this;
+        }
+
+        [[nodiscard]] size_t count() const { return count_; }
+    };
+
+private:
+    std::string_view table_;
+    std::vector<std::string_view> columns_;
+    bool or_replace_{false};
+    std::vector<std::string_view> conflict_keys_;
+    std::vector<std::string_view> update_columns_;
+    detail::UpsertAction upsert_{detail::UpsertAction::None};
+    size_t max_rows_{500};
+    size_t max_bytes_{0};
+
+    // Reused between statements so steady-state batches do not allocate
+    std::string statement_;
+    std::string row_;
+    std::string upsert_clause_;
+    std::vector<SqlValue<Config>> values_;      // Bound values of the pending statement
+    std::vector<SqlValue<Config>> row_values_;  // and of the row being written
+    BindCollector markers_;                     // "$n" markers of the row being written
+    uint32_t positional_{0};                    // and the number of the pending statement's last one
+
+public:
+    BatchInsert(std::string_view table, std::span<const std::string_view> columns)
+        : table_(table), columns_(columns.begin(), columns.end()) {}
+
+    BatchInsert& orReplace(bool enable = true) {
+        static_assert(!DialectOf<Config>::insert_or_replace.empty(),
+                      "This dialect has no INSERT OR REPLACE; use an upsert instead");
+        or_replace_ = enable;
+        return *this;
+    }
+
+    // Rows whose key already exists are updated or skipped instead of
+    // failing, see doUpdate() and doNothing()
+    BatchInsert& onConflict(std::initializer_list<std::string_view> keys) {
+        return onConflict(std::span<const std::string_view>(keys.begin(), keys.size()));
+    }
+
+    BatchInsert& onConflict(std::span<const std::string_view> keys) {
+        conflict_keys_.assign(keys.begin(), keys.end());
+        return *this;
+    }
+
+    // On a conflict, overwrite `columns` of the existing row with the values
+    // of the inserted one
+    BatchInsert& doUpdate(std::initializer_list<std::string_view> columns) {
+        return doUpdate(std::span<const std::string_view>(columns.begin(), columns.size()));
+    }
+
+    BatchInsert& doUpdate(std::span<const std::string_view> columns) {
+        update_columns_.assign(columns.begin(), columns.end());
+        upsert_ = update_columns_.empty() ? detail::UpsertAction::None : detail::UpsertAction::Update;
+        return *this;
+    }
+
+    BatchInsert& doNothing() {
+        update_columns_.clear();
+        upsert_ = detail::UpsertAction::Nothing;
+        return *this;
+    }
+
+    // Rows per statement, 0 for no limit
+    BatchInsert& maxRows(size_t rows) {
+        max_rows_ = rows;
+        return *this;
+    }
+
+    // Approximate upper bound on statement size in bytes, 0 for no limit.
+    // A single row larger than the limit still gets its own statement.
+    BatchInsert& maxBytes(size_t bytes) {
+        max_bytes_ = bytes;
+        return *this;
+    }
+
+    // Pull rows from `next(RowWriter&)` until it returns false and pass every
+    // finished statement to `sink(std::string_view)`. Returns the number of
+    // statements emitted; statements already emitted stay emitted on error.
+    //
+    // A sink taking `(std::string_view, std::span<const SqlValue<Config>>)`
+    // gets the statement with a positional marker per value instead, "$n"
+    // numbered per statement in numbered dialects, and the values to bind in
+    // order. Rows per statement are then also capped so that the statement
+    // stays within the dialect's max_parameters. The values are views like
+    // any SqlValue: what they point to must live until the sink returns.
+    template<typename Generator, typename Sink>
+        requires std::invocable<Generator&, RowWriter&>
+    Result<size_t> write(Generator&& next, Sink&& sink) {
+        constexpr bool Bound = std::invocable<Sink&, std::string_view, std::span<const SqlValue<Config>>>;
+
+        if (table_.empty()) {
+            return fail(QueryError::Code::EmptyTable, "Table name is required");
+        }
+        if (columns_.empty()) {
+            return fail(QueryError::Code::InvalidColumn, "No columns specified for batch INSERT");
+        }
+        upsert_clause_.clear();
+        if (upsert_ != detail::UpsertAction::None) {
+            if (or_replace_) {
+                return fail(QueryError::Code::InvalidOperation, "An upsert cannot be combined with INSERT OR REPLACE");
+            }
+            if (detail::upsertMissingKeys<DialectOf<Config>>(upsert_, conflict_keys_)) {
+                return fail(QueryError::Code::InvalidOperation, "ON CONFLICT DO UPDATE needs conflict columns");
+            }
+            detail::appendUpsertHead<DialectOf<Config>>(upsert_clause_, conflict_keys_, upsert_, columns_[0]);
+            for (size_t i = 0; i < update_columns_.size(); ++i) {
+                if (i > 0) upsert_clause_ += ", ";
+                upsert_clause_ += update_columns_[i];
+                upsert_clause_ += " = ";
+                detail::appendExcluded<DialectOf<Config>>(upsert_clause_, update_columns_[i]);
+            }
+        }
+
+        size_t maxRows = max_rows_;
+        if constexpr(Bound) {
+            const size_t fit = std::max<size_t>(DialectOf<Config>::max_parameters / columns_.size(), 1);
+            maxRows = maxRows > 0 ? std::min(maxRows, fit) : fit;
+        }
+
+        auto emit = [&] {
+            statement_ += upsert_clause_;
+            if constexpr(Bound) {
+                sink(std::string_view(statement_), std::span<const SqlValue<Config>>(values_));
+                values_.clear();
+            } else {
+                sink(std::string_view(statement_));
+            }
+        };
+
+        size_t statements = 0;
+        size_t rows = 0;
+        statement_.clear();
+        values_.clear();
+
+        while (true) {
+            row_.clear();
+            row_values_.clear();
+            markers_.slots.clear();
+            RowWriter writer = Bound ? RowWriter(row_, row_values_) : RowWriter(row_, nullptr, numbered());
+            if (!next(writer)) {
+                break;
+            }
+            if (writer.count() != columns_.size()) {
+                return fail(QueryError::Code::InvalidOperation, "Row value count does not match column count");
+            }
+
+            // Up to "$65535, " per marker
+            const size_t rowSize = Bound ? columns_.size() * 8 : row_.size();
+            if (rows > 0 && ((maxRows > 0 && rows >= maxRows) ||
+                             (max_bytes_ > 0 && statement_.size() + rowSize + upsert_clause_.size() + 4 > max_bytes_))) {
+                emit();
+                ++statements;
+                rows = 0;
+            }
+
+            if (rows == 0) {
+                beginStatement();
+            } else {
+                statement_ += ", ";
+            }
+            statement_ += '(';
+            if constexpr(Bound) {
+                appendMarkers();
+            } else {
+                detail::appendRenumbered(statement_, row_, 0, markers_.slots, positional_);
+            }
+            statement_ += ')';
+            ++rows;
+        }
+
+        if (rows > 0) {
+            emit();
+            ++statements;
+        }
+        return statements;
+    }
+
+    // Write rows given as tuples, one element per column
+    template<typename... Ts, typename Sink>
+    Result<size_t> write(std::span<const std::tuple<Ts...>> rows, Sink&& sink) {
+        size_t index = 0;
+        return write([&rows, &index](RowWriter& row) {
+            if (index == rows.size()) {
+                return false;
+            }
+            std::apply([&row](const auto&... values) { (row.value(values), ...); }, rows[index++]);
+            return true;
+        }, std::forward<Sink>(sink));
+    }
+
+private:
+    // Where rows record their placeholders, in dialects that number them
+    // per statement
+    BindCollector* numbered() {
+        return DialectOf<Config>::positional == PlaceholderStyle::Dollar ? &markers_ : nullptr;
+    }
+
+    // Markers for the values of the row just written, moving them to the
+    // statement's values
+    void appendMarkers() {
+        for (size_t i = 0; i < row_values_.size(); ++i) {
+            if (i > 0) statement_ += ", ";
+            values_.push_back(row_values_[i]);
+            if constexpr(DialectOf<Config>::positional == PlaceholderStyle::Dollar) {
+                statement_ += '$';
+                detail::appendInteger(statement_, values_.size());
+            } else {
+                statement_ += '?';
+            }
+        }
+    }
+
+    void beginStatement() {
+        statement_.clear();
+        positional_ = 0;
+        statement_ += or_replace_ ? DialectOf<Config>::insert_or_replace : keywords::INSERT;
+        statement_ += " ";
+        statement_ += keywords::INTO;
+        statement_ += " ";
+        statement_ += table_;
+        statement_ += " (";
+        for (size_t i = 0; i < columns_.size(); ++i) {
+            if (i > 0) statement_ += ", ";
+            statement_ += columns_[i];
+        }
+        statement_ += ") ";
+        statement_ += keywords::VALUES;
+        statement_ += " ";
+    }
+
+    Result<size_t> fail(QueryError::Code code, std::string_view message) const {
+        QueryError error(code, message);
+        if constexpr(Config::ThrowOnError) {
+            throw error;
+        }
+        return error;
+    }
+};
+
+// Set-based UPDATE of many rows. Each row holds its key values and then the
+// new values of the updated columns. Rows are collected into statements that
+// update them all at once, split like BatchInsert, and each finished
+// statement is handed to a sink. The dialect picks the statement form:
+//
+//     UPDATE t SET a = v.a FROM (VALUES (1, 'x'), (2, 'y')) AS v(id, a) WHERE t.id = v.id
+//     UPDATE t SET a = CASE id WHEN 1 THEN 'x' WHEN 2 THEN 'y' END WHERE id IN (1, 2)
+template<typename Config = DefaultConfig>
+class BatchUpdate {
+public:
+    using RowWriter = typename BatchInsert<Config>::RowWriter;
+
+private:
+    std::string_view table_;
+    std::vector<std::string_view> keys_;
+    std::vector<std::string_view> columns_;
+    bool use_case_{DialectOf<Config>::bulk_update == BulkUpdateSyntax::Case};
+    size_t max_rows_{500};
+    size_t max_bytes_{0};
+
+    // Values of the pending rows and the offsets of each one, row by row;
+    // reused between statements so steady-state batches do not allocate
+    std::string values_;
+    std::vector<std::pair<size_t, size_t>> spans_;
+    BindCollector markers_;  // "$n" markers in values_, renumbered per statement
+    uint32_t positional_{0};
+    std::string statement_;
+
+public:
+    BatchUpdate(std::string_view table, std::span<const std::string_view> keys,
+                std::span<const std::string_view> columns)
+        : table_(table), keys_(keys.begin(), keys.end()), columns_(columns.begin(), columns.end()) {}
+
+    // Render CASE expressions instead of joining a VALUES list, for
+    // databases without UPDATE ... FROM (SQLite before 3.33). Dialects whose
+    // bulk_update is Case always do.
+    BatchUpdate& useCase(bool enable = true) {
+        use_case_ = enable || DialectOf<Config>::bulk_update == BulkUpdateSyntax::Case;
+        return *this;
+    }
+
+    // Rows per statement, 0 for no limit
+    BatchUpdate& maxRows(size_t rows) {
+        max_rows_ = rows;
+        return *this;
+    }
+
+    // Approximate upper bound on statement size in bytes, 0 for no limit.
+    // A single row larger than the limit still gets its own statement.
+    BatchUpdate& maxBytes(size_t bytes) {
+        max_bytes_ = bytes;
+        return *this;
+    }
+
+    // Pull rows from `next(RowWriter&)` until it returns false, keys first,
+    // and pass every finished statement to `sink(std::string_view)`. Returns
+    // the number of statements emitted; statements already emitted stay
+    // emitted on error.
+    template<typename Generator, typename Sink>
+        requires std::invocable<Generator&, RowWriter&>
+    Result<size_t> write(Generator&& next, Sink&& sink) {
+        if (table_.empty()) {
+            return fail(QueryError::Code::EmptyTable, "Table name is required");
+        }
+        if (keys_.empty()) {
+            return fail(QueryError::Code::InvalidColumn, "No key columns specified for batch UPDATE");
+        }
+        if (columns_.empty()) {
+            return fail(QueryError::Code::InvalidColumn, "No columns specified for batch UPDATE");
+        }
+
+        const size_t width = keys_.size() + columns_.size();
+        size_t statements = 0;
+        size_t rows = 0;
+        size_t bytes = 0;  // Estimated size of the pending statement
+        values_.clear();
+        spans_.clear();
+        markers_.slots.clear();
+        BindCollector* markers = DialectOf<Config>::positional == PlaceholderStyle::Dollar ? &markers_ : nullptr;
+
+        while (true) {
+            const size_t rowBegin = values_.size();
+            const size_t spanBegin = spans_.size();
+            const size_t markerBegin = markers_.slots.size();
+            RowWriter writer(values_, &spans_, markers);
+            if (!next(writer)) {
+                values_.resize(rowBegin);
+                spans_.resize(spanBegin);
+                markers_.slots.resize(markerBegin);
+                break;
+            }
+            if (writer.count() != width) {
+                return fail(QueryError::Code::InvalidOperation, "Row value count does not match column count");
+            }
+
+            const size_t rowBytes = estimateRow(spanBegin);
+            if (rows > 0 && ((max_rows_ > 0 && rows >= max_rows_) ||
+                             (max_bytes_ > 0 && bytes + rowBytes > max_bytes_))) {
+                renderStatement(rows);
+                sink(std::string_view(statement_));
+                ++statements;
+
+                // Keep only the row that did not fit
+                values_.erase(0, rowBegin);
+                spans_.erase(spans_.begin(), spans_.begin() + static_cast<std::ptrdiff_t>(spanBegin));
+                for (auto& span : spans_) {
+                    span.first -= rowBegin;
+                    span.second -= rowBegin;
+                }
+                markers_.slots.erase(markers_.slots.begin(),
+                                     markers_.slots.begin() + static_cast<std::ptrdiff_t>(markerBegin));
+                for (auto& marker : markers_.slots) {
+                    marker.offset -= rowBegin;
+                }
+                rows = 0;
+            }
+            if (rows == 0) {
+                bytes = estimateHead();
+            }
+            bytes += rowBytes;
+            ++rows;
+        }
+
+        if (rows > 0) {
+            renderStatement(rows);
+            sink(std::string_view(statement_));
+            ++statements;
+        }
+        return statements;
+    }
+
+    // Write rows given as tuples: the keys, then one element per column
+    template<typename... Ts, typename Sink>
+    Result<size_t> write(std::span<const std::tuple<Ts...>> rows, Sink&& sink) {
+        size_t index = 0;
+        return write([&rows, &index](RowWriter& row) {
+            if (index == rows.size()) {
+                return false;
+            }
+            std::apply([&row](const auto&... values) { (row.value(values), ...); }, rows[index++]);
+            return true;
+        }, std::forward<Sink>(sink));
+    }
+
+private:
+    // Values [first, last] of the pending rows, as rendered; each copy of a
+    // marker gets its own number
+    void appendValues(size_t first, size_t last) {
+        const auto text = std::string_view(values_).substr(spans_[first].first, spans_[last].second - spans_[first].first);
+        detail::appendRenumbered(statement_, text, spans_[first].first, markers_.slots, positional_);
+    }
+
+    [[nodiscard]] size_t estimateHead() const {
+        size_t size = 32 + table_.size() * 2;
+        for (auto key : keys_) size += key.size() * 3 + 8;
+        for (auto column : columns_) size += column.size() * 2 + 16;
+        return size;
+    }
+
+    // The row's share of the statement: its values, plus the keys that CASE
+    // repeats in every column
+    [[nodiscard]] size_t estimateRow(size_t first) const {
+        size_t valueBytes = 0;
+        size_t keyBytes = 0;
+        for (size_t i = 0; i < keys_.size() + columns_.size(); ++i) {
+            const size_t length = spans_[first + i].second - spans_[first + i].first;
+            valueBytes += length + 2;
+            if (i < keys_.size()) keyBytes += length + keys_[i].size() + 8;
+        }
+        return use_case_ ? valueBytes + keyBytes * columns_.size() + 12 * columns_.size() : valueBytes + 4;
+    }
+
+    void renderStatement(size_t rows) {
+        statement_.clear();
+        positional_ = 0;
+        statement_ += keywords::UPDATE;
+        statement_ += " ";
+        statement_ += table_;
+        statement_ += " ";
+        statement_ += keywords::SET;
+        statement_ += " ";
+        if (use_case_) {
+            renderCase(rows);
+        } else {
+            renderFromValues(rows);
+        }
+    }
+
+    // The name of the i-th VALUES column, as v(...) declares it
+    void appendValuesColumn(size_t i) {
+        statement_ += "v.";
+        if constexpr(DialectOf<Config>::bulk_update == BulkUpdateSyntax::FromValuesNumbered) {
+            statement_ += "column";
+            detail::appendInteger(statement_, static_cast<int64_t>(i + 1));
+        } else {
+            statement_ += i < keys_.size() ? keys_[i] : columns_[i - keys_.size()];
+        }
+    }
+
+    void renderFromValues(size_t rows) {
+        const size_t width = keys_.size() + columns_.size();
+        for (size_t c = 0; c < columns_.size(); ++c) {
+            if (c > 0) statement_ += ", ";
+            statement_ += columns_[c];
+            statement_ += " = ";
+            appendValuesColumn(keys_.size() + c);
+        }
+
+        statement_ += " ";
+        statement_ += keywords::FROM;
+        statement_ += " (";
+        statement_ += keywords::VALUES;
+        statement_ += " ";
+        for (size_t r = 0; r < rows; ++r) {
+            if (r > 0) statement_ += ", ";
+            // Values of a row are contiguous and already comma-separated
+            statement_ += '(';
+            appendValues(r * width, r * width + width - 1);
+            statement_ += ')';
+        }
+        statement_ += ") ";
+        statement_ += keywords::AS;
+        statement_ += " v";
+        if constexpr(DialectOf<Config>::bulk_update != BulkUpdateSyntax::FromValuesNumbered) {
+            statement_ += "(";
+            for (size_t i = 0; i < width; ++i) {
+                if (i > 0) statement_ += ", ";
+                statement_ += i < keys_.size() ? keys_[i] : columns_[i - keys_.size()];
+            }
+            statement_ += ")";
+        }
+
+        statement_ += " ";
+        statement_ += keywords::WHERE;
+        statement_ += " ";
+        for (size_t k = 0; k < keys_.size(); ++k) {
+            if (k > 0) {
+                statement_ += " ";
+                statement_ += keywords::AND;
+                statement_ += " ";
+            }
+            statement_ += table_;
+            statement_ += ".";
+            statement_ += keys_[k];
+            statement_ += " = ";
+            appendValuesColumn(k);
+        }
+    }
+
+    void renderCase(size_t rows) {
+        const size_t width = keys_.size() + columns_.size();
+        const bool simple = keys_.size() == 1;
+
+        for (size_t c = 0; c < columns_.size(); ++c) {
+            if (c > 0) statement_ += ", ";
+            statement_ += columns_[c];
+            statement_ += " = ";
+            statement_ += keywords::CASE;
+            if (simple) {
+                statement_ += " ";
+                statement_ += keys_[0];
+            }
+            for (size_t r = 0; r < rows; ++r) {
+                statement_ += " ";
+                statement_ += keywords::WHEN;
+                statement_ += " ";
+                if (simple) {
+                    appendValues(r * width, r * width);
+                } else {
+                    for (size_t k = 0; k < keys_.size(); ++k) {
+                        if (k > 0) {
+                            statement_ += " ";
+                            statement_ += keywords::AND;
+                            statement_ += " ";
+                        }
+                        statement_ += keys_[k];
+                        statement_ += " = ";
+                        appendValues(r * width + k, r * width + k);
+                    }
+                }
+                statement_ += " ";
+                statement_ += keywords::THEN;
+                statement_ += " ";
+                appendValues(r * width + keys_.size() + c, r * width + keys_.size() + c);
+            }
+            statement_ += " ";
+            statement_ += keywords::END;
+        }
+
+        // Only the listed rows: a CASE without a match would set NULL
+        statement_ += " ";
+        statement_ += keywords::WHERE;
+        statement_ += " ";
+        if (simple || DialectOf<Config>::row_values) {
+            if (!simple) statement_ += "(";
+            for (size_t k = 0; k < keys_.size(); ++k) {
+                if (k > 0) statement_ += ", ";
+                statement_ += keys_[k];
+            }
+            if (!simple) statement_ += ")";
+            statement_ += " ";
+            statement_ += keywords::IN;
+            statement_ += " (";
+            for (size_t r = 0; r < rows; ++r) {
+                if (r > 0) statement_ += ", ";
+                if (!simple) statement_ += "(";
+                for (size_t k = 0; k < keys_.size(); ++k) {
+                    if (k > 0) statement_ += ", ";
+                    appendValues(r * width + k, r * width + k);
+                }
+                if (!simple) statement_ += ")";
+            }
+            statement_ += ")";
+        } else {
+            for (size_t r = 0; r < rows; ++r) {
+                if (r > 0) {
+                    statement_ += " ";
+                    statement_ += keywords::OR;
+                    statement_ += " ";
+                }
+                statement_ += "(";
+                for (size_t k = 0; k < keys_.size(); ++k) {
+                    if (k > 0) {
+                        statement_ += " ";
+                        statement_ += keywords::AND;
+                        statement_ += " ";
+                    }
+                    statement_ += keys_[k];
+                    statement_ += " = ";
+                    appendValues(r * width + k, r * width + k);
+                }
+                statement_ += ")";
+            }
+        }
+    }
+
+    Result<size_t> fail(QueryError::Code code, std::string_view message) const {
+        QueryError error(code, message);
+        if constexpr(Config::ThrowOnError) {
+            throw error;
+        }
+        return error;
+    }
+};
+
+// A query used as a table in FROM, see QueryBuilder::as()
+template<typename Config>
+struct DerivedTable {
+    std::shared_ptr<const QueryBuilder<Config>> query;
+    std::string_view alias;
+};
+
+template<typename Config>
+class QueryBuilder {
+public:
+    enum class QueryType : uint8_t { Select, Insert, InsertOrReplace, Update, Delete, Truncate };
+
+private:
+    friend class Condition<Config>;
+    friend class ShardRouter<Config>;
+
+    // Core frequently accessed fields
+    struct {
+        QueryType type{QueryType::Select};
+        std::string_view table;
+        std::string_view index;  // useIndex() hint for the FROM table
+        bool distinct{false};
+    } core_;
+
+    // Columns and values (high-frequency access)
+    struct {
+        ClauseList<Config, ColumnRef<Config>, Config::MaxColumns> select_columns;
+        ClauseList<Config, std::pair<std::string_view, SqlValue<Config>>, Config::MaxColumns> values;
+    } columns_;
+
+    // ON CONFLICT clause of an INSERT, see onConflict(). Rarely used, so
+    // kept in vectors that cost nothing until then.
+    struct UpsertSet {
+        std::string_view column;
+        SqlValue<Config> value;
+        std::string_view excluded;  // Inserted column to take the value of instead, if set
+    };
+
+    struct {
+        std::vector<std::string_view> keys;
+        std::vector<UpsertSet> updates;
+        detail::UpsertAction action{detail::UpsertAction::None};
+    } upsert_;
+
+    // Conditions and joins (medium-frequency access)
+    struct {
+        ClauseList<Config, Condition<Config>, Config::MaxConditions> where_conditions;
+        ClauseList<Config, Join<Config>, Config::MaxJoins> joins;
+        std::vector<Condition<Config>> join_conditions;  // ON conditions with values, see Join::conditionIndex()
+    } filters_;
+
+    // Ordering, grouping, and limits (low-frequency access)
+    struct {
+        ClauseList<Config, std::pair<std::string_view, bool>, Config::MaxOrderBy> order_by;
+        ClauseList<Config, std::string_view, Config::MaxGroupBy> group_by;
+        std::string_view having;
+        int32_t limit{-1};
+        int32_t offset{-1};
+        size_t seek{NoSeek};  // WHERE index of the seekAfter() condition
+        std::shared_ptr<const StringArena> seek_text;  // Strings decoded from its cursor
+    } ordering_;
+
+    // Owned clause text (aliases, join conditions, raw conditions)
+    detail::ClauseArena arena_;
+
+    // Nested builders, rendered in place with this one. Subqueries are kept
+    // in `owned` unless passed by std::cref(), which references them.
+    struct CommonTable {
+        std::string_view name;
+        const QueryBuilder* query;
+    };
+
+    struct {
+        std::vector<CommonTable> ctes;
+        const QueryBuilder* from{nullptr};  // Derived table; core_.table holds its alias
+        bool in_where{false};               // A WHERE condition renders a subquery
+        std::vector<std::shared_ptr<const QueryBuilder>> owned;
+    } nested_;
+
+    // Rendered SELECT clauses reused across builds, see cacheClauses()
+    mutable detail::ClauseCache clauses_;
+
+    // Error handling
+    mutable std::optional<QueryError> last_error_;
+
+    [[nodiscard]] size_t estimateSize() const {
+        size_t size = 64; // Base size
+        size += core_.table.size() + core_.index.size();
+        size += columns_.select_columns.size() * 20; // Average column name size + potential function/alias
+        size += filters_.where_conditions.size() * 50; // Average condition size
+        size += filters_.joins.size() * 60; // Average join size
+        size += ordering_.order_by.size() * 25; // Column name + ASC/DESC
+        size += ordering_.group_by.size() * 15; // Column name
+        size += ordering_.having.size();
+        size += upsert_.keys.size() * 16 + upsert_.updates.size() * 40;
+        if (ordering_.limit >= 0) size += 15;
+        if (ordering_.offset >= 0) size += 15;
+        for (const auto& cte : nested_.ctes) {
+            size += cte.name.size() + 8 + cte.query->estimateSize();
+        }
+        if (nested_.from) size += nested_.from->estimateSize();
+        return size;
+    }
+
+    static constexpr size_t NoSeek = static_cast<size_t>(-1);
+
+    // Index of the WHERE condition keyValues() takes its values from, which
+    // are appended to `out`; InsertedKey when they come from an INSERT,
+    // NoKey when nothing restricts the column
+    static constexpr size_t NoKey = static_cast<size_t>(-1);
+    static constexpr size_t InsertedKey = static_cast<size_t>(-2);
+
+    size_t keyCondition(std::string_view column, std::vector<SqlValue<Config>>& out) const {
+        switch (core_.type) {
+        case QueryType::Insert:
+        case QueryType::InsertOrReplace:
+            for (size_t i = 0; i < columns_.values.size(); ++i) {
+                if (detail::sameColumn(columns_.values[i].first, column)) {
+                    out.push_back(columns_.values[i].second);
+                    return InsertedKey;
+                }
+            }
+            return NoKey;
+        case QueryType::Truncate:
+            return NoKey;
+        default:
+            for (size_t i = 0; i < filters_.where_conditions.size(); ++i) {
+                if (filters_.where_conditions[i].keyValues(column, out)) {
+                    return i;
+                }
+            }
+            return NoKey;
+        }
+    }
+
+    // The keyset condition of seekAfter(): rows that sort after `lastRow`
+    [[nodiscard]] Condition<Config> seekCondition(std::span<const SqlValue<Config>> lastRow) const {
+        using Op = typename Condition<Config>::Op;
+        const auto& keys = ordering_.order_by;
+        const auto after = [&keys](size_t i) { return keys[i].second ? Op::Gt : Op::Lt; };
+
+        bool uniform = true;
+        for (size_t i = 1; i < keys.size(); ++i) {
+            uniform &= keys[i].second == keys[0].second;
+        }
+        if (DialectOf<Config>::row_values && uniform && keys.size() > 1) {
+            std::vector<std::string_view> columns;
+            columns.reserve(keys.size());
+            for (size_t i = 0; i < keys.size(); ++i) columns.push_back(keys[i].first);
+            return Condition<Config>::rowCompare(columns, after(0), lastRow);
+        }
+
+        // a > x OR (a = x AND b > y) OR (a = x AND b = y AND c > z) ...
+        Condition<Config> chain(keys[0].first, after(0), lastRow[0]);
+        for (size_t i = 1; i < keys.size(); ++i) {
+            Condition<Config> term(keys[0].first, Op::Eq, lastRow[0]);
+            for (size_t k = 1; k < i; ++k) {
+                term = std::move(term) && Condition<Config>(keys[k].first, Op::Eq, lastRow[k]);
+            }
+            chain = std::move(chain) || (std::move(term) && Condition<Config>(keys[i].first, after(i), lastRow[i]));
+        }
+        return chain;
+    }
+
+    // Every error goes through here, to lastError() and the Config::Observer
+    void recordError(const QueryError& error) const {
+        last_error_ = error;
+        if constexpr(is_observed<Config>) {
+            ObserverOf<Config>::onError(error);
+        }
+    }
+
+    template<typename Col>
+    QueryBuilder& addUpsertSet(const Col& column, const SqlValue<Config>& val, std::string_view excluded) {
+        static_assert(std::is_convertible_v<Col, std::string_view>, "Column type not supported for doUpdate");
+        if (upsert_.updates.size() >= Config::MaxColumns) {
+            auto error = QueryError(QueryError::Code::TooManyColumns,
+                                    detail::keepMessage(std::format("Too many values: limit is {}", Config::MaxColumns)));
+            recordError(error);
+            if constexpr(Config::ThrowOnError) {
+                throw error;
+            }
+            return *this;
+        }
+        upsert_.updates.push_back(UpsertSet{static_cast<std::string_view>(column), val, excluded});
+        upsert_.action = detail::UpsertAction::Update;
+        return *this;
+    }
+
+    [[nodiscard]] std::string_view statementName() const {
+        switch (core_.type) {
+        case QueryType::Select: return keywords::SELECT;
+        case QueryType::Insert: return keywords::INSERT;
+        case QueryType::InsertOrReplace: return DialectOf<Config>::insert_or_replace;
+        case QueryType::Update: return keywords::UPDATE;
+        case QueryType::Delete: return keywords::DELETE;
+        case QueryType::Truncate: return DialectOf<Config>::truncate;
+        }
+        return {};
+    }
+
+    // Report a finished top-level render to the Config::Observer
+    template<SqlSink Out>
+    void observeBuild(const Out& query, size_t start, size_t reserved, std::chrono::steady_clock::time_point began,
+                      const Result<size_t>& result) const {
+        const auto count = [](size_t n) { return static_cast<uint16_t>(std::min<size_t>(n, UINT16_MAX)); };
+        BuildEvent event;
+        event.statement = statementName();
+        event.elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - began);
+        if (result.hasError()) {
+            event.error = result.error().code;
+        } else {
+            event.bytes = result.value();
+            if constexpr(requires { query.data(); }) {
+                event.sql = std::string_view(query.data() + start, event.bytes);
+            }
+        }
+        event.reserved = reserved;
+        event.columns = count(core_.type == QueryType::Select ? columns_.select_columns.size() : columns_.values.size());
+        event.conditions = count(filters_.where_conditions.size());
+        event.joins = count(filters_.joins.size());
+        event.order_by = count(ordering_.order_by.size());
+        event.group_by = count(ordering_.group_by.size());
+        event.subqueries = count(nested_.ctes.size() + (nested_.from ? 1 : 0) +
+                                 static_cast<size_t>(std::ranges::count_if(
+                                     filters_.where_conditions,
+                                     [](const Condition<Config>& condition) { return condition.hasSubquery(); })));
+        ObserverOf<Config>::onBuild(event);
+    }
+
+    // Keep the ON condition of the join just added if it has values, so
+    // that they are numbered and bound with the rest of the statement
+    void keepJoinCondition(size_t joins, const Condition<Config>& condition) {
+        if (filters_.joins.size() > joins && condition.hasValues()) {
+            filters_.joins.back().setConditionIndex(static_cast<uint32_t>(filters_.join_conditions.size()));
+            filters_.join_conditions.push_back(condition);
+        }
+    }
+
+    [[nodiscard]] const Condition<Config>* joinCondition(const Join<Config>& join) const {
+        return join.conditionIndex() == Join<Config>::TextOnly ? nullptr
+                                                               : &filters_.join_conditions[join.conditionIndex()];
+    }
+
+    // Keep a subquery alive for as long as this builder and its copies
+    const QueryBuilder& keepSubquery(std::shared_ptr<const QueryBuilder> query) {
+        nested_.owned.push_back(std::move(query));
+        return *nested_.owned.back();
+    }
+
+public:
+    QueryBuilder() = default;
+
+    QueryBuilder& reset() {
+        core_.type = QueryType::Select;
+        core_.table = "";
+        core_.index = "";
+        core_.distinct = false;
+
+        columns_.select_columns.clear();
+        columns_.values.clear();
+
+        upsert_.keys.clear();
+        upsert_.updates.clear();
+        upsert_.action = detail::UpsertAction::None;
+
+        filters_.where_conditions.clear();
+        filters_.joins.clear();
+        filters_.join_conditions.clear();
+
+        ordering_.order_by.clear();
+        ordering_.group_by.clear();
+        ordering_.having = "";
+        ordering_.limit = -1;
+        ordering_.offset = -1;
+        ordering_.seek = NoSeek;
+        ordering_.seek_text.reset();
+
+        nested_.ctes.clear();
+        nested_.from = nullptr;
+        nested_.in_where = false;
+        nested_.owned.clear();
+
+        arena_.reset();
+        clauses_.touchAll();
+        last_error_ = std::nullopt;
+        return *this;
+    }
+
+    [[nodiscard]] std::optional<QueryError> lastError() const {
+        return last_error_;
+    }
+
+    // Whether columns of `table` can be referenced: it is the FROM table or
+    // a joined one, by name with or without an alias. Any table passes once
+    // the query reads from a derived table or a CTE, whose columns are not
+    // known here.
+    [[nodiscard]] bool hasTable(std::string_view table) const {
+        if (table.empty() || nested_.from || !nested_.ctes.empty()) {
+            return true;
+        }
+        auto names = [table](std::string_view source) {
+            return source.substr(0, source.find(' ')) == table;
+        };
+        if (names(core_.table)) {
+            return true;
+        }
+        for (const auto& join : filters_.joins) {
+            if (names(join.table())) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Statement metadata, read without rendering or parsing the SQL, e.g.
+    // to route the statement (see ShardRouter)
+    [[nodiscard]] QueryType type() const { return core_.type; }
+
+    // Table the statement reads or writes, without its alias; the alias of
+    // a derived table
+    [[nodiscard]] std::string_view table() const {
+        return core_.table.substr(0, core_.table.find(' '));
+    }
+
+    // Whether the statement only reads: a SELECT whose CTEs and derived
+    // table are read-only too
+    [[nodiscard]] bool isReadOnly() const {
+        if (core_.type != QueryType::Select || (nested_.from && !nested_.from->isReadOnly())) {
+            return false;
+        }
+        return std::ranges::all_of(nested_.ctes, [](const CommonTable& cte) { return cte.query->isReadOnly(); });
+    }
+
+    // Values the statement restricts `column` to: those an INSERT sets it
+    // to, or those of the first WHERE condition that restricts it (see
+    // Condition::keyValues()). nullopt when rows with any value of the
+    // column can be read or written, including TRUNCATE.
+    [[nodiscard]] std::optional<std::vector<SqlValue<Config>>> keyValues(std::string_view column) const {
+        std::vector<SqlValue<Config>> values;
+        if (keyCondition(column, values) == NoKey) {
+            return std::nullopt;
+        }
+        return values;
+    }
+
+    template<typename T>
+    [[nodiscard]] std::optional<std::vector<SqlValue<Config>>> keyValues(const TypedColumn<T, Config>& column) const {
+        return keyValues(column.name());
+    }
+
+    template<typename... Cols>
+    QueryBuilder& select(Cols&&... cols) {
+        static_assert((QueryType::Select == QueryType::Select), "SELECT can only be used with SELECT queries");
+        core_.type = QueryType::Select;
+        const size_t additional = sizeof...(cols);
+
+        if (!columns_.select_columns.hasRoom(additional)) {
+            auto error = QueryError(QueryError::Code::TooManyColumns,
+                                    detail::keepMessage(std::format("Too many columns: limit is {}", Config::MaxColumns)));
+            recordError(error);
+            if constexpr(Config::ThrowOnError) {
+                throw error;
+            }
+            return *this;
+        }
+
+        (addSelectColumn(std::forward<Cols>(cols)), ...);
+        return *this;
+    }
+
+    template<typename T, size_t Extent>
+    QueryBuilder& select(std::span<const T, Extent> cols) {
+        static_assert((QueryType::Select == QueryType::Select), "SELECT can only be used with SELECT queries");
+        core_.type = QueryType::Select;
+
+        if (!columns_.select_columns.hasRoom(cols.size())) {
+            auto error = QueryError(QueryError::Code::TooManyColumns,
+                                    detail::keepMessage(std::format("Too many columns: limit is {}", Config::MaxColumns)));
+            recordError(error);
+            if constexpr(Config::ThrowOnError) {
+                throw error;
+            }
+            return *this;
+        }
+
+        clauses_.touch(detail::ClauseCache::Head);
+        for (const auto& col : cols) {
+            if constexpr (std::is_convertible_v<T, std::string_view>) {
+                columns_.select_columns.push_back(ColumnRef<Config>(static_cast<std::string_view>(col)));
+            }
+        }
+        return *this;
+    }
+
+    template<typename T>
+    void addSelectColumn(const T& col) {
+        if constexpr (std::is_same_v<std::remove_cvref_t<T>, ColumnRef<Config>>) {
+            clauses_.touch(detail::ClauseCache::Head);
+            columns_.select_columns.push_back(col);
+        } else if constexpr (std::is_convertible_v<T, std::string_view>) {
+            clauses_.touch(detail::ClauseCache::Head);
+            columns_.select_columns.push_back(ColumnRef<Config>(static_cast<std::string_view>(col)));
+        } else {
+            static_assert(std::is_convertible_v<T, std::string_view> ||
+                              std::is_same_v<std::remove_cvref_t<T>, ColumnRef<Config>>,
+                          "Column type not supported for select");
+        }
+    }
+
+    // Select from span
+    QueryBuilder& select(std::span<const std::string_view> cols) {
+        static_assert((QueryType::Select == QueryType::Select), "SELECT can only be used with SELECT queries");
+        core_.type = QueryType::Select;
+
+        if (!columns_.select_columns.hasRoom(cols.size())) {
+            auto error = QueryError(QueryError::Code::TooManyColumns,
+                                    detail::keepMessage(std::format("Too many columns: limit is {}", Config::MaxColumns)));
+            recordError(error);
+            if constexpr(Config::ThrowOnError) {
+                throw error;
+            }
+            return *this;
+        }
+
+        clauses_.touch(detail::ClauseCache::Head);
+        for (const auto& col : cols) {
+            columns_.select_columns.push_back(ColumnRef<Config>(col));
+        }
+        return *this;
+    }
+
+    // Select from array
+    template<size_t N>
+    QueryBuilder& select(const std::array<std::string_view, N>& cols) {
+        return select(std::span<const std::string_view>(cols));
+    }
+
+    // From method
+    template<typename T>
+    QueryBuilder& from(const T& table) {
+        core_.index = {};
+        if constexpr (std::is_convertible_v<T, std::string_view>) {
+            clauses_.touch(detail::ClauseCache::Head);
+            core_.table = static_cast<std::string_view>(table);
+        } else if constexpr (std::is_same_v<std::remove_cvref_t<T>, AliasedTable<Config>>) {
+            clauses_.touch(detail::ClauseCache::Head);
+            core_.table = arena_.store({table.tableName(), " ", table.alias()});
+        } else if constexpr (std::is_same_v<std::remove_cvref_t<T>, DerivedTable<Config>>) {
+            clauses_.touch(detail::ClauseCache::Head);
+            nested_.from = &keepSubquery(table.query);
+            core_.table = arena_.keep(table.alias);
+            return *this;
+        } else {
+            static_assert(std::is_convertible_v<T, std::string_view> ||
+                              std::is_same_v<std::remove_cvref_t<T>, AliasedTable<Config>> ||
+                              std::is_same_v<std::remove_cvref_t<T>, DerivedTable<Config>>,
+                          "Table type not supported for from");
+        }
+        nested_.from = nullptr;
+        return *this;
+    }
+
+    // Index hint for the last joined table, or the FROM table before any
+    // join: INDEXED BY on SQLite, USE INDEX on MySQL, and on PostgreSQL an
+    // IndexScan() comment for the pg_hint_plan extension. SELECT only. The
+    // name is a view, like table names.
+    QueryBuilder& useIndex(std::string_view index) {
+        if (filters_.joins.size() == 0 && (core_.table.empty() || nested_.from)) {
+            auto error = QueryError(QueryError::Code::InvalidOperation,
+                                    "useIndex() needs a table from from() or a join");
+            recordError(error);
+            if constexpr(Config::ThrowOnError) {
+                throw error;
+            }
+            return *this;
+        }
+
+        clauses_.touch(detail::ClauseCache::Head);
+        if (filters_.joins.size() > 0) {
+            filters_.joins.back().setIndex(index);
+        } else {
+            core_.index = index;
+        }
+        return *this;
+    }
+
+    // Snapshot of this query as a derived table, for from()
+    [[nodiscard]] DerivedTable<Config> as(std::string_view alias) const& {
+        return DerivedTable<Config>{std::make_shared<const QueryBuilder>(*this), alias};
+    }
+
+    [[nodiscard]] DerivedTable<Config> as(std::string_view alias) && {
+        return DerivedTable<Config>{std::make_shared<const QueryBuilder>(std::move(*this)), alias};
+    }
+
+    // Common table expression: WITH name AS (query) ahead of the statement
+    QueryBuilder& with(std::string_view name, const QueryBuilder& query) {
+        return with(name, std::cref(keepSubquery(std::make_shared<const QueryBuilder>(query))));
+    }
+
+    QueryBuilder& with(std::string_view name, QueryBuilder&& query) {
+        return with(name, std::cref(keepSubquery(std::make_shared<const QueryBuilder>(std::move(query)))));
+    }
+
+    // References `query` instead of keeping a copy; it must outlive this builder
+    QueryBuilder& with(std::string_view name, std::reference_wrapper<const QueryBuilder> query) {
+        nested_.ctes.push_back(CommonTable{name, &query.get()});
+        return *this;
+    }
+
+    template<typename Fn>
+    QueryBuilder& where(Fn builderFn) {
+        WhereBuilder<Config> builder;
+        builderFn(builder);
+        return where(std::move(builder).build());
+    }
+
+    template<typename OtherConfig>
+    QueryBuilder& where(const Condition<OtherConfig>& condition) {
+        if (!filters_.where_conditions.hasRoom()) {
+            auto error = QueryError(QueryError::Code::TooManyConditions,
+                                    detail::keepMessage(std::format("Too many conditions: limit is {}", Config::MaxConditions)));
+            recordError(error);
+            if constexpr(Config::ThrowOnError) {
+                throw error;
+            }
+            return *this;
+        }
+
+        // Convert condition from OtherConfig to our Config
+        clauses_.touch(detail::ClauseCache::Where);
+        filters_.where_conditions.push_back(Condition<Config>(condition));
+        nested_.in_where |= filters_.where_conditions.back().hasSubquery();
+        return *this;
+    }
+
+    // Conditions built inline are moved in rather than copied
+    QueryBuilder& where(Condition<Config>&& condition) {
+        if (!filters_.where_conditions.hasRoom()) {
+            auto error = QueryError(QueryError::Code::TooManyConditions,
+                                    detail::keepMessage(std::format("Too many conditions: limit is {}", Config::MaxConditions)));
+            recordError(error);
+            if constexpr(Config::ThrowOnError) {
+                throw error;
+            }
+            return *this;
+        }
+
+        clauses_.touch(detail::ClauseCache::Where);
+        nested_.in_where |= condition.hasSubquery();
+        filters_.where_conditions.push_back(std::move(condition));
+        return *this;
+    }
+
+    template<SqlCompatible T>
+    QueryBuilder& whereOp(std::string_view column, typename ConditionBase<Config>::Op op, T&& value) {
+        if (!filters_.where_conditions.hasRoom()) {
+            auto error = QueryError(QueryError::Code::TooManyConditions,
+                                    detail::keepMessage(std::format("Too many conditions: limit is {}", Config::MaxConditions)));
+            recordError(error);
+            if constexpr(Config::ThrowOnError) {
+                throw error;
+            }
+            return *this;
+        }
+
+        clauses_.touch(detail::ClauseCache::Where);
+        filters_.where_conditions.push_back(Condition<Config>(
+            column, op, SqlValue<Config>(std::forward<T>(value))
+            ));
+        return *this;
+    }
+
+    // OrderBy with bounds checking and compile-time validation
+    template<typename T>
+    QueryBuilder& orderBy(const T& column, bool asc = true) {
+        static_assert((QueryType::Select == QueryType::Select), "ORDER BY can only be used with SELECT queries");
+
+        if (!ordering_.order_by.hasRoom()) {
+            auto error = QueryError(QueryError::Code::TooManyOrderBy,
+                                    detail::keepMessage(std::format("Too many order by clauses: limit is {}", Config::MaxOrderBy)));
+            recordError(error);
+            if constexpr(Config::ThrowOnError) {
+                throw error;
+            }
+            return *this;
+        }
+
+        if constexpr (std::is_convertible_v<T, std::string_view>) {
+            clauses_.touch(detail::ClauseCache::Order);
+            ordering_.order_by.push_back({static_cast<std::string_view>(column), asc});
+        } else {
+            static_assert(std::is_convertible_v<T, std::string_view>,
+                          "Column type not supported for orderBy");
+        }
+        return *this;
+    }
+
+    QueryBuilder& limit(int32_t limit) {
+        static_assert((QueryType::Select == QueryType::Select), "LIMIT can only be used with SELECT queries");
+        ordering_.limit = limit;
+        return *this;
+    }
+
+    QueryBuilder& offset(int32_t offset) {
+        static_assert((QueryType::Select == QueryType::Select), "OFFSET can only be used with SELECT queries");
+        ordering_.offset = offset;
+        return *this;
+    }
+
+    QueryBuilder& distinct() {
+        static_assert((QueryType::Select == QueryType::Select), "DISTINCT can only be used with SELECT queries");
+        clauses_.touch(detail::ClauseCache::Head);
+        core_.distinct = true;
+        return *this;
+    }
+
+    // Insert with bounds checking
+    template<typename T>
+    QueryBuilder& insert(const T& table) {
+        core_.type = QueryType::Insert;
+        if constexpr (std::is_convertible_v<T, std::string_view>) {
+            clauses_.touch(detail::ClauseCache::Head);
+            core_.table = static_cast<std::string_view>(table);
+        } else {
+            static_assert(std::is_convertible_v<T, std::string_view>,
+                          "Table type not supported for insert");
+        }
+        return *this;
+    }
+
+    // Insert OR REPLACE with bounds checking
+    template<typename T>
+    QueryBuilder& insertOrReplace(const T& table) {
+        static_assert(!DialectOf<Config>::insert_or_replace.empty(),
+                      "This dialect has no INSERT OR REPLACE; use an upsert instead");
+        core_.type = QueryType::InsertOrReplace;
+        if constexpr (std::is_convertible_v<T, std::string_view>) {
+            clauses_.touch(detail::ClauseCache::Head);
+            core_.table = static_cast<std::string_view>(table);
+        } else {
+            static_assert(std::is_convertible_v<T, std::string_view>,
+                          "Table type not supported for insertOrReplace");
+        }
+        return *this;
+    }
+
+    // Multi-row insert into `table`; see BatchInsert
+    template<typename T>
+    [[nodiscard]] static BatchInsert<Config> insertBatch(const T& table, std::initializer_list<std::string_view> columns) {
+        return insertBatch(table, std::span<const std::string_view>(columns.begin(), columns.size()));
+    }
+
+    template<typename T>
+    [[nodiscard]] static BatchInsert<Config> insertBatch(const T& table, std::span<const std::string_view> columns) {
+        static_assert(std::is_convertible_v<T, std::string_view>,
+                      "Table type not supported for insertBatch");
+        return BatchInsert<Config>(static_cast<std::string_view>(table), columns);
+    }
+
+    // Set-based update of many rows of `table`, matched on `keys`; see BatchUpdate
+    template<typename T>
+    [[nodiscard]] static BatchUpdate<Config> updateBatch(const T& table, std::initializer_list<std::string_view> keys,
+                                                         std::initializer_list<std::string_view> columns) {
+        return updateBatch(table, std::span<const std::string_view>(keys.begin(), keys.size()),
+                           std::span<const std::string_view>(columns.begin(), columns.size()));
+    }
+
+    template<typename T>
+    [[nodiscard]] static BatchUpdate<Config> updateBatch(const T& table, std::span<const std::string_view> keys,
+                                                         std::span<const std::string_view> columns) {
+        static_assert(std::is_convertible_v<T, std::string_view>,
+                      "Table type not supported for updateBatch");
+        return BatchUpdate<Config>(static_cast<std::string_view>(table), keys, columns);
+    }
+
+    // Upsert: with doUpdate() or doNothing(), an INSERT whose key already
+    // exists updates or keeps that row instead of failing. Unlike
+    // insertOrReplace() the row is not deleted first. MySQL ignores the
+    // columns; ON DUPLICATE KEY applies to every unique key.
+    template<typename... Cols>
+    QueryBuilder& onConflict(const Cols&... columns) {
+        static_assert((std::is_convertible_v<Cols, std::string_view> && ...),
+                      "Column type not supported for onConflict");
+        upsert_.keys = {static_cast<std::string_view>(columns)...};
+        return *this;
+    }
+
+    // On a conflict, set `column` of the existing row; pass excluded(column)
+    // for the value this INSERT tried to write
+    template<typename Col, SqlCompatible T>
+    QueryBuilder& doUpdate(const Col& column, T&& val) {
+        return doUpdate(column, SqlValue<Config>(std::forward<T>(val)));
+    }
+
+    template<typename Col>
+    QueryBuilder& doUpdate(const Col& column, const SqlValue<Config>& val) {
+        return addUpsertSet(column, val, {});
+    }
+
+    template<typename Col>
+    QueryBuilder& doUpdate(const Col& column, Excluded value) {
+        return addUpsertSet(column, SqlValue<Config>(), value.column);
+    }
+
+    // doUpdate(column, excluded(column)) for each column
+    template<typename... Cols>
+    QueryBuilder& doUpdateExcluded(const Cols&... columns) {
+        (addUpsertSet(columns, SqlValue<Config>(), static_cast<std::string_view>(columns)), ...);
+        return *this;
+    }
+
+    QueryBuilder& doNothing() {
+        upsert_.updates.clear();
+        upsert_.action = detail::UpsertAction::Nothing;
+        return *this;
+    }
+
+    template<typename Col, SqlCompatible T>
+    QueryBuilder& value(const Col& column, T&& val) {
+        return value(column, SqlValue<Config>(std::forward<T>(val)));
+    }
+
+    template<typename Col>
+    QueryBuilder& value(const Col& column, const SqlValue<Config>& val) {
+        if (!columns_.values.hasRoom()) {
+            auto error = QueryError(QueryError::Code::TooManyColumns,
+                                    detail::keepMessage(std::format("Too many values: limit is {}", Config::MaxColumns)));
+            recordError(error);
+            if constexpr(Config::ThrowOnError) {
+                throw error;
+            }
+            return *this;
+        }
+
+        if constexpr (std::is_convertible_v<Col, std::string_view>) {
+            columns_.values.push_back({static_cast<std::string_view>(column), val});
+        } else {
+            static_assert(std::is_convertible_v<Col, std::string_view>,
+                          "Column type not supported for value");
+        }
+        return *this;
+    }
+
+    // Update methods
+    template<typename T>
+    QueryBuilder& update(const T& table) {
+        core_.type = QueryType::Update;
+        if constexpr (std::is_convertible_v<T, std::string_view>) {
+            clauses_.touch(detail::ClauseCache::Head);
+            core_.table = static_cast<std::string_view>(table);
+        } else {
+            static_assert(std::is_convertible_v<T, std::string_view>,
+                          "Table type not supported for update");
+        }
+        return *this;
+    }
+
+    template<typename Col, SqlCompatible T>
+    QueryBuilder& set(const Col& column, T&& val) {
+        return set(column, SqlValue<Config>(std::forward<T>(val)));
+    }
+
+    template<typename Col>
+    QueryBuilder& set(const Col& column, const SqlValue<Config>& val) {
+        if (!columns_.values.hasRoom()) {
+            auto error = QueryError(QueryError::Code::TooManyColumns,
+                                    detail::keepMessage(std::format("Too many values: limit is {}", Config::MaxColumns)));
+            recordError(error);
+            if constexpr(Config::ThrowOnError) {
+                throw error;
+            }
+            return *this;
+        }
+
+        if constexpr (std::is_convertible_v<Col, std::string_view>) {
+            columns_.values.push_back({static_cast<std::string_view>(column), val});
+        } else {
+            static_assert(std::is_convertible_v<Col, std::string_view>,
+                          "Column type not supported for set");
+        }
+        return *this;
+    }
+
+    // Delete methods
+    template<typename T>
+    QueryBuilder& deleteFrom(const T& table) {
+        core_.type = QueryType::Delete;
+        if constexpr (std::is_convertible_v<T, std::string_view>) {
+            clauses_.touch(detail::ClauseCache::Head);
+            core_.table = static_cast<std::string_view>(table);
+        } else {
+            static_assert(std::is_convertible_v<T, std::string_view>,
+                          "Table type not supported for deleteFrom");
+        }
+        return *this;
+    }
+
+    // Truncate methods
+    template<typename T>
+    QueryBuilder& truncate(const T& table) {
+        core_.type = QueryType::Truncate;
+        if constexpr (std::is_convertible_v<T, std::string_view>) {
+            clauses_.touch(detail::ClauseCache::Head);
+            core_.table = static_cast<std::string_view>(table);
+        } else {
+            static_assert(std::is_convertible_v<T, std::string_view>,
+                          "Table type not supported for truncate");
+        }
+        return *this;
+    }
+
+    // Join methods with bounds checking
+    template<typename T>
+    QueryBuilder& innerJoin(const T& table, std::string_view condition) {
+        static_assert((QueryType::Select == QueryType::Select), "JOIN can only be used with SELECT queries");
+        if (!filters_.joins.hasRoom()) {
+            auto error = QueryError(QueryError::Code::TooManyJoins,
+                                    detail::keepMessage(std::format("Too many joins: limit is {}", Config::MaxJoins)));
+            recordError(error);
+            if constexpr(Config::ThrowOnError) {
+                throw error;
+            }
+            return *this;
+        }
+
+        if constexpr (std::is_convertible_v<T, std::string_view>) {
+            clauses_.touch(detail::ClauseCache::Head);
+            filters_.joins.push_back(Join<Config>{
+                Join<Config>::Type::Inner,
+                static_cast<std::string_view>(table),
+                arena_.keep(condition)
+            });
+        } else if constexpr (std::is_same_v<std::remove_cvref_t<T>, AliasedTable<Config>>) {
+            clauses_.touch(detail::ClauseCache::Head);
+            filters_.joins.push_back(Join<Config>{
+                Join<Config>::Type::Inner,
+                arena_.store({table.tableName(), " ", table.alias()}),
+                arena_.keep(condition)
+            });
+        } else {
+            static_assert(std::is_convertible_v<T, std::string_view> ||
+                              std::is_same_v<std::remove_cvref_t<T>, AliasedTable<Config>>,
+                          "Table type not supported for innerJoin");
+        }
+        return *this;
+    }
+
+    template<typename T>
+    QueryBuilder& innerJoin(const T& table, const Condition<Config>& condition) {
+        const size_t joins = filters_.joins.size();
+        innerJoin(table, arena_.render([&](std::string& out) { condition.toString(out); }));
+        keepJoinCondition(joins, condition);
+        return *this;
+    }
+
+    template<typename T>
+    QueryBuilder& leftJoin(const T& table, std::string_view condition) {
+        static_assert((QueryType::Select == QueryType::Select), "JOIN can only be used with SELECT queries");
+        if (!filters_.joins.hasRoom()) {
+            auto error = QueryError(QueryError::Code::TooManyJoins,
+                                    detail::keepMessage(std::format("Too many joins: limit is {}", Config::MaxJoins)));
+            recordError(error);
+            if constexpr(Config::ThrowOnError) {
+                throw error;
+            }
+            return *this;
+        }
+
+        if constexpr (std::is_convertible_v<T, std::string_view>) {
+            clauses_.touch(detail::ClauseCache::Head);
+            filters_.joins.push_back(Join<Config>{
+                Join<Config>::Type::Left,
+                static_cast<std::string_view>(table),
+                arena_.keep(condition)
+            });
+        } else if constexpr (std::is_same_v<std::remove_cvref_t<T>, AliasedTable<Config>>) {
+            clauses_.touch(detail::ClauseCache::Head);
+            filters_.joins.push_back(Join<Config>{
+                Join<Config>::Type::Left,
+                arena_.store({table.tableName(), " ", table.alias()}),
+                arena_.keep(condition)
+            });
+        } else {
+            static_assert(std::is_convertible_v<T, std::string_view> ||
+                              std::is_same_v<std::remove_cvref_t<T>, AliasedTable<Config>>,
+                          "Table type not supported for leftJoin");
+        }
+        return *this;
+    }
+
+    template<typename T>
+    QueryBuilder& leftJoin(const T& table, const Condition<Config>& condition) {
+        const size_t joins = filters_.joins.size();
+        leftJoin(table, arena_.render([&](std::string& out) { condition.toString(out); }));
+        keepJoinCondition(joins, condition);
+        return *this;
+    }
+
+    template<typename T>
+    QueryBuilder& rightJoin(const T& table, std::string_view condition) {
+        static_assert((QueryType::Select == QueryType::Select), "JOIN can only be used with SELECT queries");
+        if (!filters_.joins.hasRoom()) {
+            auto error = QueryError(QueryError::Code::TooManyJoins,
+                                    detail::keepMessage(std::format("Too many joins: limit is {}", Config::MaxJoins)));
+            recordError(error);
+            if constexpr(Config::ThrowOnError) {
+                throw error;
+            }
+            return *this;
+        }
+
+        if constexpr (std::is_convertible_v<T, std::string_view>) {
+            clauses_.touch(detail::ClauseCache::Head);
+            filters_.joins.push_back(Join<Config>{
+                Join<Config>::Type::Right,
+                static_cast<std::string_view>(table),
+                arena_.keep(condition)
+            });
+        } else if constexpr (std::is_same_v<std::remove_cvref_t<T>, AliasedTable<Config>>) {
+            clauses_.touch(detail::ClauseCache::Head);
+            filters_.joins.push_back(Join<Config>{
+                Join<Config>::Type::Right,
+                arena_.store({table.tableName(), " ", table.alias()}),
+                arena_.keep(condition)
+            });
+        } else {
+            static_assert(std::is_convertible_v<T, std::string_view> ||
+                              std::is_same_v<std::remove_cvref_t<T>, AliasedTable<Config>>,
+                          "Table type not supported for rightJoin");
+        }
+        return *this;
+    }
+
+    template<typename T>
+    QueryBuilder& rightJoin(const T& table, const Condition<Config>& condition) {
+        const size_t joins = filters_.joins.size();
+        rightJoin(table, arena_.render([&](std::string& out) { condition.toString(out); }));
+        keepJoinCondition(joins, condition);
+        return *this;
+    }
+
+    template<typename T>
+    QueryBuilder& fullJoin(const T& table, std::string_view condition) {
+        static_assert((QueryType::Select == QueryType::Select), "JOIN can only be used with SELECT queries");
+        if (!filters_.joins.hasRoom()) {
+            auto error = QueryError(QueryError::Code::TooManyJoins,
+                                    detail::keepMessage(std::format("Too many joins: limit is {}", Config::MaxJoins)));
+            recordError(error);
+            if constexpr(Config::ThrowOnError) {
+                throw error;
+            }
+            return *this;
+        }
+
+        if constexpr (std::is_convertible_v<T, std::string_view>) {
+            clauses_.touch(detail::ClauseCache::Head);
+            filters_.joins.push_back(Join<Config>{
+                Join<Config>::Type::Full,
+                static_cast<std::string_view>(table),
+                arena_.keep(condition)
+            });
+        } else if constexpr (std::is_same_v<std::remove_cvref_t<T>, AliasedTable<Config>>) {
+            clauses_.touch(detail::ClauseCache::Head);
+            filters_.joins.push_back(Join<Config>{
+                Join<Config>::Type::Full,
+                arena_.store({table.tableName(), " ", table.alias()}),
+                arena_.keep(condition)
+            });
+        } else {
+            static_assert(std::is_convertible_v<T, std::string_view> ||
+                              std::is_same_v<std::remove_cvref_t<T>, AliasedTable<Config>>,
+                          "Table type not supported for fullJoin");
+        }
+        return *this;
+    }
+
+    template<typename T>
+    QueryBuilder& fullJoin(const T& table, const Condition<Config>& condition) {
+        const size_t joins = filters_.joins.size();
+        fullJoin(table, arena_.render([&](std::string& out) { condition.toString(out); }));
+        keepJoinCondition(joins, condition);
+        return *this;
+    }
+
+    // Where variations
+    template<typename Col, typename T>
+    QueryBuilder& whereIn(const Col& column, std::span<const T> values) {
+        if (!filters_.where_conditions.hasRoom()) {
+            auto error = QueryError(QueryError::Code::TooManyConditions,
+                                    detail::keepMessage(std::format("Too many conditions: limit is {}", Config::MaxConditions)));
+            recordError(error);
+            if constexpr(Config::ThrowOnError) {
+                throw error;
+            }
+            return *this;
+        }
+
+        if constexpr (std::is_convertible_v<Col, std::string_view>) {
+            auto condition = Condition<Config>::in(static_cast<std::string_view>(column), values);
+            clauses_.touch(detail::ClauseCache::Where);
+            filters_.where_conditions.push_back(std::move(condition));
+        } else {
+            static_assert(std::is_convertible_v<Col, std::string_view>,
+                          "Column type not supported for whereIn");
+        }
+        return *this;
+    }
+
+    template<typename Col, typename T>
+    QueryBuilder& whereNotIn(const Col& column, std::span<const T> values) {
+        if (!filters_.where_conditions.hasRoom()) {
+            auto error = QueryError(QueryError::Code::TooManyConditions,
+                                    detail::keepMessage(std::format("Too many conditions: limit is {}", Config::MaxConditions)));
+            recordError(error);
+            if constexpr(Config::ThrowOnError) {
+                throw error;
+            }
+            return *this;
+        }
+
+        if constexpr (std::is_convertible_v<Col, std::string_view>) {
+            auto condition = Condition<Config>::notIn(static_cast<std::string_view>(column), values);
+            clauses_.touch(detail::ClauseCache::Where);
+            filters_.where_conditions.push_back(std::move(condition));
+        } else {
+            static_assert(std::is_convertible_v<Col, std::string_view>,
+                          "Column type not supported for whereNotIn");
+        }
+        return *this;
+    }
+
+    // IN over a span of any length with an explicit strategy, see Condition::inList()
+    template<typename Col, typename T>
+    QueryBuilder& whereIn(const Col& column, std::span<const T> values, InStrategy strategy) {
+        return whereInList(column, values, strategy, false);
+    }
+
+    template<typename Col, typename T>
+    QueryBuilder& whereNotIn(const Col& column, std::span<const T> values, InStrategy strategy) {
+        return whereInList(column, values, strategy, true);
+    }
+
+    // Split an IN filter over several queries of at most `chunkSize` values,
+    // for backends with a bound on parameters or statement size. Calls
+    // `fn(const QueryBuilder&)` once per chunk with this query plus
+    // `column IN (chunk)` and returns the number of queries.
+    template<typename Col, typename T, typename Fn>
+    Result<size_t> forEachInChunk(const Col& column, std::span<const T> values, size_t chunkSize, Fn&& fn,
+                                  InStrategy strategy = InStrategy::Bind) const {
+        static_assert(std::is_convertible_v<Col, std::string_view>,
+                      "Column type not supported for forEachInChunk");
+        if (chunkSize == 0) {
+            return fail<size_t>(QueryError::Code::InvalidOperation, "Chunk size must be positive");
+        }
+        if (!filters_.where_conditions.hasRoom()) {
+            return fail<size_t>(QueryError::Code::TooManyConditions, "Too many conditions for chunked IN");
+        }
+
+        const std::string_view name = static_cast<std::string_view>(column);
+        QueryBuilder chunked(*this);
+        chunked.filters_.where_conditions.push_back(Condition<Config>());
+
+        size_t queries = 0;
+        for (size_t offset = 0; offset < values.size(); offset += chunkSize) {
+            const auto chunk = values.subspan(offset, std::min(chunkSize, values.size() - offset));
+            chunked.clauses_.touch(detail::ClauseCache::Where);
+            chunked.filters_.where_conditions.back() = Condition<Config>::inList(name, chunk, strategy);
+            fn(static_cast<const QueryBuilder&>(chunked));
+            ++queries;
+        }
+        return queries;
+    }
+
+    // Same, in chunks as large as the dialect's max_parameters allows next
+    // to the query's own parameters. Only InStrategy::Bind takes a parameter
+    // per value; the list is not split for the other strategies.
+    template<typename Col, typename T, typename Fn>
+        requires std::invocable<Fn&, const QueryBuilder&>
+    Result<size_t> forEachInChunk(const Col& column, std::span<const T> values, Fn&& fn,
+                                  InStrategy strategy = InStrategy::Bind) const {
+        auto used = bindCount();
+        if (used.hasError()) {
+            return used.error();
+        }
+        size_t chunkSize = std::max<size_t>(values.size(), 1);
+        if (strategy == InStrategy::Bind) {
+            if (used.value() >= DialectOf<Config>::max_parameters) {
+                return fail<size_t>(QueryError::Code::InvalidOperation, "No bind parameters left for the IN list");
+            }
+            chunkSize = DialectOf<Config>::max_parameters - used.value();
+        }
+        return forEachInChunk(column, values, chunkSize, std::forward<Fn>(fn), strategy);
+    }
+
+    template<typename Col, typename T, typename U>
+    QueryBuilder& whereBetween(const Col& column, T&& start, U&& end) {
+        if (!filters_.where_conditions.hasRoom()) {
+            auto error = QueryError(QueryError::Code::TooManyConditions,
+                                    detail::keepMessage(std::format("Too many conditions: limit is {}", Config::MaxConditions)));
+            recordError(error);
+            if constexpr(Config::ThrowOnError) {
+                throw error;
+            }
+            return *this;
+        }
+
+        if constexpr (std::is_convertible_v<Col, std::string_view>) {
+            using Op = typename ConditionBase<Config>::Op;
+            clauses_.touch(detail::ClauseCache::Where);
+            filters_.where_conditions.push_back(Condition<Config>(
+                static_cast<std::string_view>(column),
+                Op::Between,
+                SqlValue<Config>(std::forward<T>(start)),
+                SqlValue<Config>(std::forward<U>(end))
+                ));
+        } else {
+            static_assert(std::is_convertible_v<Col, std::string_view>,
+                          "Column type not supported for whereBetween");
+        }
+        return *this;
+    }
+
+    template<typename Col>
+    QueryBuilder& whereLike(const Col& column, std::string_view pattern) {
+        if (!filters_.where_conditions.hasRoom()) {
+            auto error = QueryError(QueryError::Code::TooManyConditions,
+                                    detail::keepMessage(std::format("Too many conditions: limit is {}", Config::MaxConditions)));
+            recordError(error);
+            if constexpr(Config::ThrowOnError) {
+                throw error;
+            }
+            return *this;
+        }
+
+        if constexpr (std::is_convertible_v<Col, std::string_view>) {
+            using Op = typename ConditionBase<Config>::Op;
+            clauses_.touch(detail::ClauseCache::Where);
+            filters_.where_conditions.push_back(Condition<Config>(
+                static_cast<std::string_view>(column),
+                Op::Like,
+                SqlValue<Config>(pattern)
+                ));
+        } else {
+            static_assert(std::is_convertible_v<Col, std::string_view>,
+                          "Column type not supported for whereLike");
+        }
+        return *this;
+    }
+
+    template<typename Col>
+    QueryBuilder& whereNull(const Col& column) {
+        if (!filters_.where_conditions.hasRoom()) {
+            auto error = QueryError(QueryError::Code::TooManyConditions,
+                                    detail::keepMessage(std::format("Too many conditions: limit is {}", Config::MaxConditions)));
+            recordError(error);
+            if constexpr(Config::ThrowOnError) {
+                throw error;
+            }
+            return *this;
+        }
+
+        if constexpr (std::is_convertible_v<Col, std::string_view>) {
+            clauses_.touch(detail::ClauseCache::Where);
+            filters_.where_conditions.push_back(Condition<Config>::isNull(
+                static_cast<std::string_view>(column)
+                ));
+        } else {
+            static_assert(std::is_convertible_v<Col, std::string_view>,
+                          "Column type not supported for whereNull");
+        }
+        return *this;
+    }
+
+    template<typename Col>
+    QueryBuilder& whereNotNull(const Col& column) {
+        if (!filters_.where_conditions.hasRoom()) {
+            auto error = QueryError(QueryError::Code::TooManyConditions,
+                                    detail::keepMessage(std::format("Too many conditions: limit is {}", Config::MaxConditions)));
+            recordError(error);
+            if constexpr(Config::ThrowOnError) {
+                throw error;
+            }
+            return *this;
+        }
+
+        if constexpr (std::is_convertible_v<Col, std::string_view>) {
+            clauses_.touch(detail::ClauseCache::Where);
+            filters_.where_conditions.push_back(Condition<Config>::isNotNull(
+                static_cast<std::string_view>(column)
+                ));
+        } else {
+            static_assert(std::is_convertible_v<Col, std::string_view>,
+                          "Column type not supported for whereNotNull");
+        }
+        return *this;
+    }
+
+    QueryBuilder& whereExists(std::string_view subquery) {
+        if (!filters_.where_conditions.hasRoom()) {
+            auto error = QueryError(QueryError::Code::TooManyConditions,
+                                    detail::keepMessage(std::format("Too many conditions: limit is {}", Config::MaxConditions)));
+            recordError(error);
+            if constexpr(Config::ThrowOnError) {
+                throw error;
+            }
+            return *this;
+        }
+
+        clauses_.touch(detail::ClauseCache::Where);
+        filters_.where_conditions.push_back(Condition<Config>::rawView(arena_.store({"EXISTS (", subquery, ")"})));
+        return *this;
+    }
+
+    // Subqueries from builders are rendered straight into this query's output,
+    // and their placeholders and bind slots become part of its compiled
+    // statement. The builder keeps a copy of the subquery (moved if passed
+    // as an rvalue); with std::cref() it references it instead, and the
+    // subquery must outlive this builder.
+    QueryBuilder& whereExists(const QueryBuilder& subquery) {
+        return whereExists(std::cref(keepSubquery(std::make_shared<const QueryBuilder>(subquery))));
+    }
+
+    QueryBuilder& whereExists(QueryBuilder&& subquery) {
+        return whereExists(std::cref(keepSubquery(std::make_shared<const QueryBuilder>(std::move(subquery)))));
+    }
+
+    QueryBuilder& whereExists(std::reference_wrapper<const QueryBuilder> subquery) {
+        return where(Condition<Config>::exists(subquery.get()));
+    }
+
+    template<typename Col>
+    QueryBuilder& whereIn(const Col& column, const QueryBuilder& subquery) {
+        return whereIn(column, std::cref(keepSubquery(std::make_shared<const QueryBuilder>(subquery))));
+    }
+
+    template<typename Col>
+    QueryBuilder& whereIn(const Col& column, QueryBuilder&& subquery) {
+        return whereIn(column, std::cref(keepSubquery(std::make_shared<const QueryBuilder>(std::move(subquery)))));
+    }
+
+    template<typename Col>
+    QueryBuilder& whereIn(const Col& column, std::reference_wrapper<const QueryBuilder> subquery) {
+        static_assert(std::is_convertible_v<Col, std::string_view>, "Column type not supported for whereIn");
+        return where(Condition<Config>::inSubquery(static_cast<std::string_view>(column), subquery.get()));
+    }
+
+    template<typename Col>
+    QueryBuilder& whereNotIn(const Col& column, const QueryBuilder& subquery) {
+        return whereNotIn(column, std::cref(keepSubquery(std::make_shared<const QueryBuilder>(subquery))));
+    }
+
+    template<typename Col>
+    QueryBuilder& whereNotIn(const Col& column, QueryBuilder&& subquery) {
+        return whereNotIn(column, std::cref(keepSubquery(std::make_shared<const QueryBuilder>(std::move(subquery)))));
+    }
+
+    template<typename Col>
+    QueryBuilder& whereNotIn(const Col& column, std::reference_wrapper<const QueryBuilder> subquery) {
+        static_assert(std::is_convertible_v<Col, std::string_view>, "Column type not supported for whereNotIn");
+        return where(Condition<Config>::notInSubquery(static_cast<std::string_view>(column), subquery.get()));
+    }
+
+    QueryBuilder& whereRaw(std::string_view rawCondition) {
+        if (!filters_.where_conditions.hasRoom()) {
+            auto error = QueryError(QueryError::Code::TooManyConditions,
+                                    detail::keepMessage(std::format("Too many conditions: limit is {}", Config::MaxConditions)));
+            recordError(error);
+            if constexpr(Config::ThrowOnError) {
+                throw error;
+            }
+            return *this;
+        }
+
+        clauses_.touch(detail::ClauseCache::Where);
+        filters_.where_conditions.push_back(Condition<Config>::rawView(arena_.keep(rawCondition)));
+        return *this;
+    }
+
+    template<typename Col>
+    QueryBuilder& groupBy(const Col& column) {
+        static_assert((QueryType::Select == QueryType::Select), "GROUP BY can only be used with SELECT queries");
+        if (!ordering_.group_by.hasRoom()) {
+            auto error = QueryError(QueryError::Code::TooManyGroupBy,
+                                    detail::keepMessage(std::format("Too many group by clauses: limit is {}", Config::MaxGroupBy)));
+            recordError(error);
+            if constexpr(Config::ThrowOnError) {
+                throw error;
+            }
+            return *this;
+        }
+
+        if constexpr (std::is_convertible_v<Col, std::string_view>) {
+            clauses_.touch(detail::ClauseCache::Group);
+            ordering_.group_by.push_back(static_cast<std::string_view>(column));
+        } else {
+            static_assert(std::is_convertible_v<Col, std::string_view>,
+                          "Column type not supported for groupBy");
+        }
+        return *this;
+    }
+
+    QueryBuilder& having(std::string_view condition) {
+        static_assert((QueryType::Select == QueryType::Select), "HAVING can only be used with SELECT queries");
+        clauses_.touch(detail::ClauseCache::Group);
+        ordering_.having = arena_.keep(condition);
+        return *this;
+    }
+
+    // Swap the `index`-th WHERE condition, leaving the others in place
+    QueryBuilder& replaceWhere(size_t index, Condition<Config> condition) {
+        if (index >= filters_.where_conditions.size()) {
+            auto error = QueryError(QueryError::Code::InvalidOperation, "WHERE condition index out of range");
+            recordError(error);
+            if constexpr(Config::ThrowOnError) {
+                throw error;
+            }
+            return *this;
+        }
+
+        clauses_.touch(detail::ClauseCache::Where);
+        nested_.in_where |= condition.hasSubquery();
+        filters_.where_conditions[index] = std::move(condition);
+        return *this;
+    }
+
+    // Keep the rendered text of each SELECT clause between builds and only
+    // render again the clauses changed since the last build; LIMIT and
+    // OFFSET are always rendered. For a builder reused across pages, where
+    // only limit()/offset() or one replaceWhere() change per build.
+    // Values are cached as rendered, so text a condition views must not
+    // change behind the builder's back, and builds of one builder must not
+    // run concurrently. compile() and dialects that number placeholders
+    // do not use the cache.
+    QueryBuilder& cacheClauses(bool enable = true) {
+        clauses_.enable(enable);
+        return *this;
+    }
+
+    // Keyset pagination: the next `pageSize` rows after `lastRow`, the
+    // ORDER BY values of the last row of the previous page, in ORDER BY
+    // order. Adds (a, b) > (x, y) when every key sorts the same way and the
+    // dialect has row values, else a > x OR (a = x AND b > y), so the
+    // database seeks through an index on the keys instead of skipping
+    // OFFSET rows. The keys must be unique together (end with the primary
+    // key) and not NULL. Strings in `lastRow` are referenced, as everywhere.
+    // Clears offset(); calling it again replaces the previous seek.
+    QueryBuilder& seekAfter(std::span<const SqlValue<Config>> lastRow, int32_t pageSize) {
+        const size_t keys = ordering_.order_by.size();
+        if (keys == 0 || lastRow.size() != keys) {
+            auto error = QueryError(QueryError::Code::InvalidOperation,
+                                    "seekAfter needs one value per ORDER BY key");
+            recordError(error);
+            if constexpr(Config::ThrowOnError) {
+                throw error;
+            }
+            return *this;
+        }
+
+        auto condition = seekCondition(lastRow);
+        if (ordering_.seek < filters_.where_conditions.size()) {
+            replaceWhere(ordering_.seek, std::move(condition));
+        } else {
+            const size_t index = filters_.where_conditions.size();
+            where(std::move(condition));
+            if (filters_.where_conditions.size() > index) {
+                ordering_.seek = index;
+            }
+        }
+        ordering_.offset = -1;
+        return limit(pageSize);
+    }
+
+    // Same, from a cursor returned by nextCursor()
+    QueryBuilder& seekAfter(std::string_view cursor, int32_t pageSize) {
+        // Decoded text is shorter than the token, so one block holds it all.
+        // Replaced with the seek, not accumulated in the clause arena.
+        auto text = std::make_shared<StringArena>(cursor.size());
+        auto row = PageCursor<Config>::decode(cursor, *text);
+        if (!row) {
+            recordError(row.error());
+            if constexpr(Config::ThrowOnError) {
+                throw row.error();
+            }
+            return *this;
+        }
+        seekAfter(std::span<const SqlValue<Config>>(row.value()), pageSize);
+        ordering_.seek_text = std::move(text);
+        return *this;
+    }
+
+    // Cursor for the page after the one ending with `lastRow`
+    [[nodiscard]] Result<std::string> nextCursor(std::span<const SqlValue<Config>> lastRow) const {
+        if (lastRow.size() != ordering_.order_by.size()) {
+            return QueryError(QueryError::Code::InvalidOperation,
+                              "nextCursor needs one value per ORDER BY key");
+        }
+        return PageCursor<Config>::encode(lastRow);
+    }
+
+    // `identifier` quoted for the dialect ("order" or `order`), for names
+    // that are keywords or need quoting. Kept in the builder's arena, so
+    // the result can be passed to select(), from(), orderBy() and so on.
+    [[nodiscard]] std::string_view quoted(std::string_view identifier) {
+        return arena_.render([identifier](std::string& out) {
+            detail::appendQuotedIdentifier<DialectOf<Config>>(out, identifier);
+        });
+    }
+
+    // Build with error handling
+    [[nodiscard]] Result<std::string> buildResult() const {
+        return buildWith(nullptr);
+    }
+
+    // The built text as a handle into `pool`. It is rendered into a buffer
+    // reused by the thread, so text already in the pool is not copied.
+    // Entries are never removed: intern shapes, see SqlPool.
+    [[nodiscard]] Result<InternedSql> buildInterned(SqlPool& pool = SqlPool::global()) const {
+        thread_local std::string buffer;
+        buffer.clear();
+        auto written = buildInto(buffer);
+        if (written.hasError()) {
+            return written.error();
+        }
+        return pool.intern(buffer);
+    }
+
+    // The query in the dialect's EXPLAIN form, e.g. EXPLAIN QUERY PLAN on
+    // SQLite, for pasting into a console. Parse the output with parsePlan().
+    [[nodiscard]] Result<std::string> explain(ExplainMode mode = ExplainMode::Plan) const {
+        auto compiled = compileResult();
+        if (compiled.hasError()) {
+            return compiled.error();
+        }
+        auto wrapped = compiled.value().explain(mode);
+        if (wrapped.hasError()) {
+            return wrapped.error();
+        }
+        return Result<std::string>(wrapped.sql());
+    }
+
+    // Exact length of the built query in bytes, from a rendering pass that
+    // only counts. Use it to size a sink or arena up front.
+    [[nodiscard]] Result<size_t> measure() const {
+        detail::CountingSink counter;
+        return renderTo(counter, nullptr);
+    }
+
+    // Number of parameters compileParameterized() binds: every placeholder
+    // and literal, in all clauses, subqueries and CTEs. Counted by a pass
+    // that writes no text.
+    [[nodiscard]] Result<size_t> bindCount() const {
+        BindCollector binds;
+        binds.bind_literals = true;
+        detail::CountingSink counter;
+        auto result = renderTo(counter, &binds);
+        if (result.hasError()) {
+            return result.error();
+        }
+        return binds.slots.size();
+    }
+
+    // Append the query to a caller-owned sink and return the number of
+    // characters written. Reusing one buffer, or an arena-backed
+    // std::pmr::string reset per request, avoids steady-state allocations;
+    // reserve measure() beforehand to write with a single allocation.
+    // On error the sink is restored to its previous length.
+    template<SqlSink Out>
+    Result<size_t> buildInto(Out& out) const {
+        return renderTo(out, nullptr);
+    }
+
+    // Build once into a reusable statement with a bind-slot table
+    [[nodiscard]] Result<CompiledQuery<Config>> compileResult() const {
+        return compileWith(false);
+    }
+
+    [[nodiscard]] CompiledQuery<Config> compile() const {
+        return unwrapCompiled(compileResult());
+    }
+
+    // Compile with every literal value lifted into a "?" slot as well, so the
+    // statement depends only on the query's shape. bindValues() yields the
+    // matching values, in slot order.
+    [[nodiscard]] Result<CompiledQuery<Config>> compileParameterizedResult() const {
+        return compileWith(true);
+    }
+
+    [[nodiscard]] CompiledQuery<Config> compileParameterized() const {
+        return unwrapCompiled(compileParameterizedResult());
+    }
+
+    // Values for the slots of compileParameterized(), in slot order.
+    // Placeholders are passed through as placeholder values.
+    void bindValues(std::vector<SqlValue<Config>>& out) const {
+        for (const auto& cte : nested_.ctes) {
+            cte.query->bindValues(out);
+        }
+        if (core_.type == QueryType::Select) {
+            if (nested_.from) {
+                nested_.from->bindValues(out);
+            }
+            for (const auto& condition : filters_.join_conditions) {
+                condition.collectValues(out);
+            }
+        }
+
+        switch (core_.type) {
+        case QueryType::Insert:
+        case QueryType::InsertOrReplace:
+        case QueryType::Update:
+            for (size_t i = 0; i < columns_.values.size(); ++i) {
+                out.push_back(columns_.values[i].second);
+            }
+            break;
+        default:
+            break;
+        }
+        if (core_.type == QueryType::Insert) {
+            for (const auto& update : upsert_.updates) {
+                if (update.excluded.empty()) out.push_back(update.value);
+            }
+        }
+
+        if (core_.type != QueryType::Insert && core_.type != QueryType::InsertOrReplace &&
+            core_.type != QueryType::Truncate) {
+            for (size_t i = 0; i < filters_.where_conditions.size(); ++i) {
+                filters_.where_conditions[i].collectValues(out);
+            }
+        }
+    }
+
+    // Hash of the query's shape: everything that affects the parameterized
+    // SQL text, but none of the literal values
+    [[nodiscard]] uint64_t fingerprint() const {
+        detail::ShapeHash hash;
+        hash.add(static_cast<uint64_t>(core_.type));
+        hash.add(core_.table);
+        hash.add(core_.index);
+        hash.add(static_cast<uint64_t>(core_.distinct));
+
+        hash.add(nested_.ctes.size());
+        for (const auto& cte : nested_.ctes) {
+            hash.add(cte.name);
+            hash.add(cte.query->fingerprint());
+        }
+        hash.add(core_.type == QueryType::Select && nested_.from ? nested_.from->fingerprint() : 0);
+
+        hash.add(columns_.select_columns.size());
+        for (size_t i = 0; i < columns_.select_columns.size(); ++i) {
+            const auto& column = columns_.select_columns[i];
+            hash.add(column.column());
+            hash.add(static_cast<uint64_t>(column.function()));
+            hash.add(column.alias());
+        }
+
+        hash.add(columns_.values.size());
+        for (size_t i = 0; i < columns_.values.size(); ++i) {
+            hash.add(columns_.values[i].first);
+            columns_.values[i].second.hashShape(hash);
+        }
+
+        hash.add(static_cast<uint64_t>(upsert_.action));
+        hash.add(upsert_.keys.size());
+        for (auto key : upsert_.keys) {
+            hash.add(key);
+        }
+        hash.add(upsert_.updates.size());
+        for (const auto& update : upsert_.updates) {
+            hash.add(update.column);
+            hash.add(update.excluded);
+            update.value.hashShape(hash);
+        }
+
+        hash.add(filters_.joins.size());
+        for (size_t i = 0; i < filters_.joins.size(); ++i) {
+            filters_.joins[i].hashShape(hash);
+        }
+        for (const auto& condition : filters_.join_conditions) {
+            condition.hashShape(hash);
+        }
+
+        hash.add(filters_.where_conditions.size());
+        for (size_t i = 0; i < filters_.where_conditions.size(); ++i) {
+            filters_.where_conditions[i].hashShape(hash);
+        }
+
+        hash.add(ordering_.order_by.size());
+        for (size_t i = 0; i < ordering_.order_by.size(); ++i) {
+            hash.add(ordering_.order_by[i].first);
+            hash.add(static_cast<uint64_t>(ordering_.order_by[i].second));
+        }
+
+        hash.add(ordering_.group_by.size());
+        for (size_t i = 0; i < ordering_.group_by.size(); ++i) {
+            hash.add(ordering_.group_by[i]);
+        }
+
+        hash.add(ordering_.having);
+        hash.add(static_cast<uint64_t>(static_cast<int64_t>(ordering_.limit)));
+        hash.add(static_cast<uint64_t>(static_cast<int64_t>(ordering_.offset)));
+        return hash.value();
+    }
+
+#ifdef SQLQUERYBUILDER_USE_QT
+    [[nodiscard]] QString build() const {
+        QString query;
+        QStringSink sink(query);
+        sink.reserve(estimateSize());
+        auto result = buildInto(sink);
+        if (result.hasError()) {
+            if constexpr(Config::ThrowOnError) {
+                throw result.error();
+            }
+            return QString("/* ERROR: %1 */").arg(QString::fromUtf8(result.error().message.data(),
+                                                                    static_cast<int>(result.error().message.size())));
+        }
+        return query;
+    }
+#else
+    [[nodiscard]] std::string build() const {
+        auto result = buildResult();
+        if (result.hasError()) {
+            if constexpr(Config::ThrowOnError) {
+                throw result.error();
+            }
+            return "/* ERROR: " + std::string(result.error().message) + " */";
+        }
+        return result.value();
+    }
+#endif
+
+private:
+    template<typename Col, typename T>
+    QueryBuilder& whereInList(const Col& column, std::span<const T> values, InStrategy strategy, bool negate) {
+        if (!filters_.where_conditions.hasRoom()) {
+            auto error = QueryError(QueryError::Code::TooManyConditions,
+                                    detail::keepMessage(std::format("Too many conditions: limit is {}", Config::MaxConditions)));
+            recordError(error);
+            if constexpr(Config::ThrowOnError) {
+                throw error;
+            }
+            return *this;
+        }
+
+        if constexpr (std::is_convertible_v<Col, std::string_view>) {
+            const auto name = static_cast<std::string_view>(column);
+            clauses_.touch(detail::ClauseCache::Where);
+            filters_.where_conditions.push_back(negate ? Condition<Config>::notInList(name, values, strategy)
+                                                       : Condition<Config>::inList(name, values, strategy));
+        } else {
+            static_assert(std::is_convertible_v<Col, std::string_view>,
+                          "Column type not supported for whereIn");
+        }
+        return *this;
+    }
+
+    template<typename T>
+    Result<T> fail(QueryError::Code code, std::string_view message) const {
+        QueryError error(code, message);
+        recordError(error);
+        if constexpr(Config::ThrowOnError) {
+            throw error;
+        }
+        return error;
+    }
+
+    [[nodiscard]] Result<CompiledQuery<Config>> compileWith(bool bindLiterals) const {
+        BindCollector binds;
+        binds.bind_literals = bindLiterals;
+        auto result = buildWith(&binds);
+        if (result.hasError()) {
+            return result.error();
+        }
+        if (binds.slots.size() > DialectOf<Config>::max_parameters) {
+            QueryError error(QueryError::Code::InvalidOperation,
+                             detail::keepMessage(std::format("Statement has {} bind parameters; the dialect allows {}",
+                                                             binds.slots.size(), DialectOf<Config>::max_parameters)));
+            recordError(error);
+            return error;
+        }
+        return CompiledQuery<Config>(std::move(result).value(), std::move(binds.slots));
+    }
+
+    static CompiledQuery<Config> unwrapCompiled(Result<CompiledQuery<Config>> result) {
+        if (result.hasError()) {
+            if constexpr(Config::ThrowOnError) {
+                throw result.error();
+            }
+            return CompiledQuery<Config>(result.error());
+        }
+        return std::move(result).value();
+    }
+
+    [[nodiscard]] Result<std::string> buildWith(BindCollector* binds) const {
+        std::string query;
+        const size_t reserved = estimateSize();
+        query.reserve(reserved);
+        auto result = renderTo(query, binds, reserved);
+        if (result.hasError()) {
+            return result.error();
+        }
+        return Result<std::string>(std::move(query));
+    }
+
+    template<SqlSink Out>
+    Result<size_t> renderTo(Out& query, BindCollector* binds, size_t reserved = 0) const {
+        if constexpr(is_observed<Config> && !std::is_same_v<Out, detail::CountingSink>) {
+            const auto began = std::chrono::steady_clock::now();
+            const size_t start = query.size();
+            auto result = renderUnobserved(query, binds);
+            observeBuild(query, start, reserved, began, result);
+            return result;
+        } else {
+            return renderUnobserved(query, binds);
+        }
+    }
+
+    template<SqlSink Out>
+    Result<size_t> renderUnobserved(Out& query, BindCollector* binds) const {
+        // Numbered placeholders need a count across the statement even when
+        // no slots are wanted
+        BindCollector numbering;
+        if constexpr(DialectOf<Config>::positional == PlaceholderStyle::Dollar) {
+            if (!binds) binds = &numbering;
+        }
+
+        const size_t start = query.size();
+        try {
+            if constexpr(DialectOf<Config>::index_hint == IndexHintSyntax::PlannerComment) {
+                appendPlannerHints(query);
+            }
+            renderStatement(query, binds);
+
+            if constexpr(requires { query.overflowed(); }) {
+                if (query.overflowed()) {
+                    query.resize(start);
+                    QueryError error(QueryError::Code::BufferOverflow, "Query does not fit in the output buffer");
+                    recordError(error);
+                    return error;
+                }
+            }
+
+            return query.size() - start;
+        } catch (const QueryError& error) {
+            query.resize(start);
+            recordError(error);
+            return error;
+        } catch (const std::exception& e) {
+            query.resize(start);
+            QueryError error(QueryError::Code::InvalidCondition, e.what());
+            recordError(error);
+            return error;
+        }
+    }
+
+    // The statement with its CTEs; throws on error. Subqueries render through
+    // here, into the enclosing query's output and bind slots.
+    template<SqlSink Out>
+    void renderStatement(Out& query, BindCollector* binds) const {
+        if (core_.table.empty() && core_.type != QueryType::Select) {
+            throw QueryError(QueryError::Code::EmptyTable, "Table name is required");
+        }
+
+        if (!nested_.ctes.empty()) {
+            query += keywords::WITH;
+            query += " ";
+            for (size_t i = 0; i < nested_.ctes.size(); ++i) {
+                if (i > 0) query += ", ";
+                query += nested_.ctes[i].name;
+                query += " ";
+                query += keywords::AS;
+                query += " (";
+                nested_.ctes[i].query->renderStatement(query, binds);
+                query += ")";
+            }
+            query += " ";
+        }
+
+        if (upsert_.action != detail::UpsertAction::None && core_.type != QueryType::Insert) {
+            throw QueryError(QueryError::Code::InvalidOperation, "onConflict() only applies to a plain INSERT");
+        }
+        if (!core_.index.empty() && core_.type != QueryType::Select) {
+            throw QueryError(QueryError::Code::InvalidOperation, "useIndex() only applies to SELECT");
+        }
+
+        switch (core_.type) {
+        case QueryType::Select:
+            buildSelect(query, binds);
+            break;
+        case QueryType::Insert:
+            buildInsert(query, false, binds);
+            break;
+        case QueryType::InsertOrReplace:
+            buildInsert(query, true, binds);
+            break;
+        case QueryType::Update:
+            buildUpdate(query, binds);
+            break;
+        case QueryType::Delete:
+            buildDelete(query, binds);
+            break;
+        case QueryType::Truncate:
+            buildTruncate(query);
+            break;
+        }
+    }
+
+    template<SqlSink Out>
+    void buildSelect(Out& query, BindCollector* binds) const {
+        if (clauses_.enabled() && !binds) {
+            using Clause = detail::ClauseCache::Clause;
+            // Referenced builders can change behind this one, so render them every time
+            if (nested_.from) clauses_.touch(Clause::Head);
+            if (nested_.in_where) clauses_.touch(Clause::Where);
+            query += clauses_.get(Clause::Head, [this](std::string& text) { appendSelectHead(text, nullptr); });
+            query += clauses_.get(Clause::Where, [this](std::string& text) { appendSelectWhere(text, nullptr); });
+            query += clauses_.get(Clause::Group, [this](std::string& text) { appendGroupBy(text); });
+            query += clauses_.get(Clause::Order, [this](std::string& text) { appendOrderBy(text); });
+        } else {
+            appendSelectHead(query, binds);
+            appendSelectWhere(query, binds);
+            appendGroupBy(query);
+            appendOrderBy(query);
+        }
+        appendLimit(query);
+    }
+
+    template<SqlSink Out>
+    void appendSelectHead(Out& query, BindCollector* binds) const {
+        query += keywords::SELECT;
+        query += " ";
+
+        if (core_.distinct) {
+            query += keywords::DISTINCT;
+            query += " ";
+        }
+
+        if (columns_.select_columns.size() == 0) {
+            query += keywords::ALL;
+        } else {
+            bool first = true;
+            for (size_t i = 0; i < columns_.select_columns.size(); ++i) {
+                if (!first) query += ", ";
+                columns_.select_columns[i].toSql(query);
+                first = false;
+            }
+        }
+
+        query += " ";
+        query += keywords::FROM;
+        query += " ";
+        if (nested_.from) {
+            query += "(";
+            nested_.from->renderStatement(query, binds);
+            query += ") ";
+        }
+        query += core_.table;
+        detail::appendIndexHint<DialectOf<Config>>(query, core_.index);
+
+        // Joins
+        for (size_t i = 0; i < filters_.joins.size(); ++i) {
+            query += " ";
+            filters_.joins[i].toString(query, joinCondition(filters_.joins[i]), binds);
+        }
+    }
+
+    // pg_hint_plan comment with the index hints of the whole statement,
+    // naming each table by its alias when it has one. The extension only
+    // reads the comment ahead of the outermost statement, so nested
+    // builders add their hints to it instead of a comment of their own.
+    template<SqlSink Out>
+    void appendPlannerHints(Out& query) const {
+        bool open = false;
+        forEachIndexHint([&query, &open](std::string_view table, std::string_view index) {
+            query += open ? "" : "/*+ ";
+            open = true;
+            query += "IndexScan(";
+            query += table.substr(table.find_last_of(' ') + 1);
+            query += " ";
+            query += index;
+            query += ") ";
+        });
+        if (open) {
+            query += "*/ ";
+        }
+    }
+
+    // Call `fn(table, index)` for each useIndex() hint of this statement
+    // and the builders nested in it, in SQL order
+    template<typename Fn>
+    void forEachIndexHint(Fn&& fn) const {
+        const auto nested = [&fn](const QueryBuilder& query) { query.forEachIndexHint(fn); };
+        for (const auto& cte : nested_.ctes) {
+            nested(*cte.query);
+        }
+        if (nested_.from) {
+            nested(*nested_.from);
+        }
+        if (!core_.index.empty()) {
+            fn(core_.table, core_.index);
+        }
+        for (size_t i = 0; i < filters_.joins.size(); ++i) {
+            if (!filters_.joins[i].index().empty()) {
+                fn(filters_.joins[i].table(), filters_.joins[i].index());
+            }
+        }
+        for (const auto& condition : filters_.join_conditions) {
+            condition.forEachSubquery(nested);
+        }
+        for (size_t i = 0; i < filters_.where_conditions.size(); ++i) {
+            filters_.where_conditions[i].forEachSubquery(nested);
+        }
+    }
+
+    template<SqlSink Out>
+    void appendSelectWhere(Out& query, BindCollector* binds) const {
+        appendWhereList(query, binds);
+    }
+
+    // WHERE clause: the conditions joined with AND, a top-level OR in
+    // parentheses so that it does not absorb its neighbours
+    template<SqlSink Out>
+    void appendWhereList(Out& query, BindCollector* binds) const {
+        const size_t count = filters_.where_conditions.size();
+        if (count == 0) {
+            return;
+        }
+        query += " ";
+        query += keywords::WHERE;
+        query += " ";
+        for (size_t i = 0; i < count; ++i) {
+            if (i > 0) {
+                query += " ";
+                query += keywords::AND;
+                query += " ";
+            }
+            const auto& condition = filters_.where_conditions[i];
+            const bool group = count > 1 && condition.isDisjunction();
+            if (group) query += "(";
+            condition.toString(query, binds);
+            if (group) query += ")";
+        }
+    }
+
+    template<SqlSink Out>
+    void appendGroupBy(Out& query) const {
+        if (ordering_.group_by.size() > 0) {
+            query += " ";
+            query += keywords::GROUP_BY;
+            query += " ";
+            bool first = true;
+            for (size_t i = 0; i < ordering_.group_by.size(); ++i) {
+                if (!first) query += ", ";
+                query += ordering_.group_by[i];
+                first = false;
+            }
+
+            if (!ordering_.having.empty()) {
+                query += " ";
+                query += keywords::HAVING;
+                query += " ";
+                query += ordering_.having;
+            }
+        }
+    }
+
+    template<SqlSink Out>
+    void appendOrderBy(Out& query) const {
+        if (ordering_.order_by.size() > 0) {
+            query += " ";
+            query += keywords::ORDER_BY;
+            query += " ";
+            bool first = true;
+            for (size_t i = 0; i < ordering_.order_by.size(); ++i) {
+                if (!first) query += ", ";
+                query += ordering_.order_by[i].first;
+                query += " ";
+                query += (ordering_.order_by[i].second ? keywords::ASC : keywords::DESC);
+                first = false;
+            }
+        }
+    }
+
+    template<SqlSink Out>
+    void appendLimit(Out& query) const {
+        if (ordering_.limit >= 0) {
+            query += " ";
+            query += keywords::LIMIT;
+            query += " ";
+            detail::appendInteger(query, ordering_.limit);
+        }
+
+        if (ordering_.offset >= 0) {
+            if constexpr(!DialectOf<Config>::offset_without_limit.empty()) {
+                if (ordering_.limit < 0) {
+                    query += " ";
+                    query += DialectOf<Config>::offset_without_limit;
+                }
+            }
+            query += " ";
+            query += keywords::OFFSET;
+            query += " ";
+            detail::appendInteger(query, ordering_.offset);
+        }
+    }
+
+    template<SqlSink Out>
+    void buildInsert(Out& query, bool orReplace, BindCollector* binds) const {
+        if (columns_.values.size() == 0) {
+            throw QueryError(QueryError::Code::InvalidCondition, "No values specified for INSERT");
+        }
+
+        query += orReplace ? DialectOf<Config>::insert_or_replace : keywords::INSERT;
+        query += " ";
+        query += keywords::INTO;
+        query += " ";
+        query += core_.table;
+        query += " (";
+
+        bool first = true;
+        for (size_t i = 0; i < columns_.values.size(); ++i) {
+            if (!first) query += ", ";
+            query += columns_.values[i].first;
+            first = false;
+        }
+
+        query += ") ";
+        query += keywords::VALUES;
+        query += " (";
+
+        first = true;
+        for (size_t i = 0; i < columns_.values.size(); ++i) {
+            if (!first) query += ", ";
+            columns_.values[i].second.appendSql(query, binds);
+            first = false;
+        }
+
+        query += ")";
+
+        if (upsert_.action != detail::UpsertAction::None) {
+            appendUpsert(query, binds);
+        }
+    }
+
+    template<SqlSink Out>
+    void appendUpsert(Out& query, BindCollector* binds) const {
+        if (detail::upsertMissingKeys<DialectOf<Config>>(upsert_.action, upsert_.keys)) {
+            throw QueryError(QueryError::Code::InvalidOperation, "ON CONFLICT DO UPDATE needs conflict columns");
+        }
+        detail::appendUpsertHead<DialectOf<Config>>(query, upsert_.keys, upsert_.action, columns_.values[0].first);
+        for (size_t i = 0; i < upsert_.updates.size(); ++i) {
+            const auto& update = upsert_.updates[i];
+            if (i > 0) query += ", ";
+            query += update.column;
+            query += " = ";
+            if (update.excluded.empty()) {
+                update.value.appendSql(query, binds);
+            } else {
+                detail::appendExcluded<DialectOf<Config>>(query, update.excluded);
+            }
+        }
+    }
+
+    template<SqlSink Out>
+    void buildUpdate(Out& query, BindCollector* binds) const {
+        if (columns_.values.size() == 0) {
+            throw QueryError(QueryError::Code::InvalidCondition, "No values specified for UPDATE");
+        }
+
+        query += keywords::UPDATE;
+        query += " ";
+        query += core_.table;
+        query += " ";
+        query += keywords::SET;
+        query += " ";
+
+        bool first = true;
+        for (size_t i = 0; i < columns_.values.size(); ++i) {
+            if (!first) query += ", ";
+            query += columns_.values[i].first;
+            query += " = ";
+            columns_.values[i].second.appendSql(query, binds);
+            first = false;
+        }
+
+        appendWhereList(query, binds);
+    }
+
+    template<SqlSink Out>
+    void buildDelete(Out& query, BindCollector* binds) const {
+        query += keywords::DELETE;
+        query += " ";
+        query += keywords::FROM;
+        query += " ";
+        query += core_.table;
+
+        appendWhereList(query, binds);
+    }
+
+    template<SqlSink Out>
+    void buildTruncate(Out& query) const {
+        query += DialectOf<Config>::truncate;
+        query += " ";
+        query += core_.table;
+    }
+};
 
-template<typename T, typename Config>
-Condition<Config> TypedColumn<T, Config>::like(std::string_view pattern) const {
-    using Op = typename ConditionBase<Config>::Op;
-    return Condition<Config>(name_, Op::Like, SqlValue<Config>(pattern));
-}
+// Thread-safe cache of parameterized statements keyed by query shape
+// (QueryBuilder::fingerprint()). Lookups are spread over independently
+// locked shards; each shard evicts its least recently used entries once it
+// exceeds its share of the entry and byte limits. Shapes are identified by
+// their 64-bit hash alone.
+template<typename Config = DefaultConfig>
+class QueryCache {
+public:
+    using Entry = std::shared_ptr<const CompiledQuery<Config>>;
+
+    struct Stats {
+        size_t hits{0};
+        size_t misses{0};
+        size_t evictions{0};
+        size_t entries{0};
+        size_t bytes{0};
+    };
 
-template<typename T, typename Config>
-Condition<Config> TypedColumn<T, Config>::notLike(std::string_view pattern) const {
-    using Op = typename ConditionBase<Config>::Op;
-    return Condition<Config>(name_, Op::NotLike, SqlValue<Config>(pattern));
-}
+private:
+    struct Shard {
+        mutable std::mutex mutex;
+        std::list<std::pair<uint64_t, Entry>> lru;  // Most recently used first
+        std::unordered_map<uint64_t, typename std::list<std::pair<uint64_t, Entry>>::iterator> index;
+        size_t bytes{0};
+        size_t hits{0};
+        size_t misses{0};
+        size_t evictions{0};
+    };
 
-template<typename T, typename Config>
-template<SqlCompatible T1, SqlCompatible T2>
-Condition<Config> TypedColumn<T, Config>::between(T1&& start, T2&& end) const {
-    using Op = typename ConditionBase<Config>::Op;
-    return Condition<Config>(
-        name_,
-        Op::Between,
-        SqlValue<Config>(std::forward<T1>(start)),
-        SqlValue<Config>(std::forward<T2>(end))
-        );
-}
+    std::unique_ptr<Shard[]> shards_;
+    size_t shard_count_;
+    size_t max_entries_;  // Per shard, 0 for no limit
+    size_t max_bytes_;    // Per shard, 0 for no limit
+    SqlPool* pool_{nullptr};  // See internStatements()
 
-template<typename T, typename Config>
-template<typename U>
-Condition<Config> TypedColumn<T, Config>::in(std::span<const U> values) const {
-    return Condition<Config>::in(name_, values);
-}
+public:
+    // `maxEntries` and `maxBytes` apply to the whole cache, 0 for no limit
+    explicit QueryCache(size_t maxEntries = 1024, size_t maxBytes = 0, size_t shardCount = 16)
+        : shards_(std::make_unique<Shard[]>(shardCount > 0 ? shardCount : 1)),
+        shard_count_(shardCount > 0 ? shardCount : 1),
+        max_entries_(maxEntries > 0 ? (maxEntries + shard_count_ - 1) / shard_count_ : 0),
+        max_bytes_(maxBytes > 0 ? (maxBytes + shard_count_ - 1) / shard_count_ : 0) {}
+
+    QueryCache(const QueryCache&) = delete;
+    QueryCache& operator=(const QueryCache&) = delete;
+
+    // Intern the text of statements compiled from now on into `pool`, or
+    // stop with nullptr. Cached statements then share their text with every
+    // other cache using the pool and are keyed by handle in
+    // PreparedStatements. Evicting an entry does not free pooled text. Set
+    // before the cache is shared between threads.
+    void internStatements(SqlPool* pool = &SqlPool::global()) { pool_ = pool; }
+
+    // Statement for the builder's shape, compiled on a miss. Its slots take
+    // builder.bindValues(). Build errors are returned and not cached.
+    [[nodiscard]] Result<Entry> get(const QueryBuilder<Config>& builder) {
+        const uint64_t key = builder.fingerprint();
+        Shard& shard = shards_[key % shard_count_];
+
+        {
+            std::lock_guard lock(shard.mutex);
+            if (auto it = shard.index.find(key); it != shard.index.end()) {
+                shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+                ++shard.hits;
+                return it->second->second;
+            }
+            ++shard.misses;
+        }
 
-template<typename T, typename Config>
-template<typename U>
-Condition<Config> TypedColumn<T, Config>::notIn(std::span<const U> values) const {
-    return Condition<Config>::notIn(name_, values);
-}
+        // Compile outside the lock; a racing thread may insert the same shape
+        auto compiled = builder.compileParameterizedResult();
+        if (compiled.hasError()) {
+            return compiled.error();
+        }
+        CompiledQuery<Config> statement = std::move(compiled).value();
+        if (pool_) {
+            statement.intern(*pool_);
+        }
+        auto entry = std::make_shared<const CompiledQuery<Config>>(std::move(statement));
 
-// Operator overloads for TypedColumn
-template<typename T, typename Config, SqlCompatible U>
-inline Condition<Config> operator==(const TypedColumn<T, Config>& col, U&& val) {
-    return col.eq(std::forward<U>(val));
-}
+        std::lock_guard lock(shard.mutex);
+        if (auto it = shard.index.find(key); it != shard.index.end()) {
+            return it->second->second;
+        }
+        shard.lru.emplace_front(key, entry);
+        shard.index.emplace(key, shard.lru.begin());
+        shard.bytes += entryBytes(*entry);
+        evict(shard);
+        return Entry(std::move(entry));
+    }
 
-template<typename T, typename U, typename ConfigT, typename ConfigU>
-inline Condition<ConfigT> operator==(const TypedColumn<T, ConfigT>& col1, const TypedColumn<U, ConfigU>& col2) {
-    return col1.eq(col2);
-}
+    // Final SQL text for the builder, reusing the cached statement for its shape
+    [[nodiscard]] Result<std::string> render(const QueryBuilder<Config>& builder) {
+        auto entry = get(builder);
+        if (entry.hasError()) {
+            return entry.error();
+        }
+        std::vector<SqlValue<Config>> values;
+        values.reserve(entry.value()->slotCount());
+        builder.bindValues(values);
+        return entry.value()->render(values);
+    }
 
-template<typename T, typename Config, SqlCompatible U>
-inline Condition<Config> operator!=(const TypedColumn<T, Config>& col, U&& val) {
-    return col.ne(std::forward<U>(val));
-}
+    [[nodiscard]] Stats stats() const {
+        Stats total;
+        for (size_t i = 0; i < shard_count_; ++i) {
+            std::lock_guard lock(shards_[i].mutex);
+            total.hits += shards_[i].hits;
+            total.misses += shards_[i].misses;
+            total.evictions += shards_[i].evictions;
+            total.entries += shards_[i].index.size();
+            total.bytes += shards_[i].bytes;
+        }
+        return total;
+    }
 
-template<typename T, typename U, typename ConfigT, typename ConfigU>
-inline Condition<ConfigT> operator!=(const TypedColumn<T, ConfigT>& col1, const TypedColumn<U, ConfigU>& col2) {
-    return col1.ne(col2);
-}
+    void clear() {
+        for (size_t i = 0; i < shard_count_; ++i) {
+            std::lock_guard lock(shards_[i].mutex);
+            shards_[i].lru.clear();
+            shards_[i].index.clear();
+            shards_[i].bytes = 0;
+        }
+    }
 
-template<typename T, typename Config, SqlCompatible U>
-inline Condition<Config> operator<(const TypedColumn<T, Config>& col, U&& val) {
-    return col.lt(std::forward<U>(val));
-}
+private:
+    static size_t entryBytes(const CompiledQuery<Config>& compiled) {
+        size_t bytes = compiled.sql().size() + sizeof(CompiledQuery<Config>);
+        for (const auto& slot : compiled.slots()) {
+            bytes += sizeof(BindSlot) + slot.name.size();
+        }
+        return bytes;
+    }
 
-template<typename T, typename U, typename ConfigT, typename ConfigU>
-inline Condition<ConfigT> operator<(const TypedColumn<T, ConfigT>& col1, const TypedColumn<U, ConfigU>& col2) {
-    return col1.lt(col2);
-}
+    void evict(Shard& shard) {
+        // Never evict the entry just inserted at the front
+        while (shard.lru.size() > 1 &&
+               ((max_entries_ > 0 && shard.lru.size() > max_entries_) ||
+                (max_bytes_ > 0 && shard.bytes > max_bytes_))) {
+            const auto& victim = shard.lru.back();
+            shard.bytes -= entryBytes(*victim.second);
+            shard.index.erase(victim.first);
+            shard.lru.pop_back();
+            ++shard.evictions;
+        }
+    }
+};
 
-template<typename T, typename Config, SqlCompatible U>
-inline Condition<Config> operator<=(const TypedColumn<T, Config>& col, U&& val) {
-    return col.le(std::forward<U>(val));
-}
+//=====================
+// Routing
+//=====================
 
-template<typename T, typename U, typename ConfigT, typename ConfigU>
-inline Condition<ConfigT> operator<=(const TypedColumn<T, ConfigT>& col1, const TypedColumn<U, ConfigU>& col2) {
-    return col1.le(col2);
-}
+// Server a statement runs on: writes on the primary, reads on a replica
+enum class RouteTarget : uint8_t { Primary, Replica };
+
+// Where to run one statement, from ShardRouter::route(). Results are not
+// merged here: when several shards answer, the hints say what the caller
+// has to do to the combined rows.
+struct Route {
+    RouteTarget target{RouteTarget::Primary};
+    std::vector<size_t> shards;  // Ascending, never empty
+    bool keyed{false};           // Picked by the shard key; otherwise every shard
+
+    bool ordered{false};   // ORDER BY: merge the shard results in order
+    // GROUP BY or aggregates: combine the partial results. AVG cannot be
+    // combined as is; select SUM and COUNT instead and divide after merging.
+    bool grouped{false};
+    bool distinct{false};  // SELECT DISTINCT: drop rows repeated across shards
+    int32_t limit{-1};     // LIMIT and OFFSET, to apply again to the combined rows
+    int32_t offset{-1};
+
+    [[nodiscard]] bool fanOut() const { return shards.size() > 1; }
+};
 
-template<typename T, typename Config, SqlCompatible U>
-inline Condition<Config> operator>(const TypedColumn<T, Config>& col, U&& val) {
-    return col.gt(std::forward<U>(val));
-}
+// Routes statements over shards that split the rows by the value of one
+// key column (e.g. tenant_id), from the builder's metadata rather than its
+// SQL: reads go to replicas and writes to the primary, on the shards of the
+// key values the statement restricts the column to (see
+// QueryBuilder::keyValues()), or on all of them. Routing fails for writes
+// it cannot place: an INSERT has to set the key to a value with a shard,
+// and an UPDATE cannot SET the key, which would leave the row on the shard
+// of its old key. Immutable, so it can be shared between threads.
+template<typename Config>
+class ShardRouter {
+public:
+    // Shard of a routing key (see SqlValue::routingKey()) out of `shardCount`
+    using ShardFunction = size_t (*)(uint64_t key, size_t shardCount);
 
-template<typename T, typename U, typename ConfigT, typename ConfigU>
-inline Condition<ConfigT> operator>(const TypedColumn<T, ConfigT>& col1, const TypedColumn<U, ConfigU>& col2) {
-    return col1.gt(col2);
-}
+    // Value of a placeholder on the key column, by its token (":tenant").
+    // Keys bound to "?" are not known until execution, so they fan out.
+    using Parameter = std::pair<std::string_view, SqlValue<Config>>;
 
-template<typename T, typename Config, SqlCompatible U>
-inline Condition<Config> operator>=(const TypedColumn<T, Config>& col, U&& val) {
-    return col.ge(std::forward<U>(val));
-}
+    struct ShardQuery {
+        size_t shard;
+        QueryBuilder<Config> query;
+    };
 
-template<typename T, typename U, typename ConfigT, typename ConfigU>
-inline Condition<ConfigT> operator>=(const TypedColumn<T, ConfigT>& col1, const TypedColumn<U, ConfigU>& col2) {
-    return col1.ge(col2);
-}
+private:
+    using Builder = QueryBuilder<Config>;
 
-// Operator overloads for Column
-template<typename Config>
-inline Condition<Config> operator==(const Column<Config>& col, const SqlValue<Config>& val) {
-    return col.eq(val);
-}
+    std::string_view key_;
+    size_t shard_count_;
+    ShardFunction shard_of_;
 
-template<typename Config, SqlCompatible T>
-inline Condition<Config> operator==(const Column<Config>& col, T&& val) {
-    return col.eq(std::forward<T>(val));
-}
+    static size_t modulo(uint64_t key, size_t shardCount) {
+        return static_cast<size_t>(key % shardCount);
+    }
 
-template<typename Config>
-inline Condition<Config> operator==(const Column<Config>& col, const std::string& val) {
-    return col.eq(std::string_view(val));
-}
+    static const SqlValue<Config>* find(const Placeholder<Config>& placeholder, std::span<const Parameter> parameters) {
+        for (const auto& [token, value] : parameters) {
+            if (token.size() == placeholder.id().size() + 1 && token[0] == placeholder.prefix() &&
+                token.substr(1) == placeholder.id()) {
+                return &value;
+            }
+        }
+        return nullptr;
+    }
 
-template<typename Config>
-inline Condition<Config> operator!=(const Column<Config>& col, const SqlValue<Config>& val) {
-    return col.ne(val);
-}
+    // Shards of `values`, ascending; false when one of them cannot be placed
+    bool shardsOf(std::span<const SqlValue<Config>> values, std::span<const Parameter> parameters,
+                  std::vector<size_t>& shards) const {
+        for (const auto& value : values) {
+            const auto shard = shardOf(value, parameters);
+            if (!shard) {
+                shards.clear();
+                return false;
+            }
+            shards.push_back(*shard);
+        }
+        std::ranges::sort(shards);
+        shards.erase(std::ranges::unique(shards).begin(), shards.end());
+        return true;
+    }
 
-template<typename Config, SqlCompatible T>
-inline Condition<Config> operator!=(const Column<Config>& col, T&& val) {
-    return col.ne(std::forward<T>(val));
-}
+public:
+    // `shardOf` defaults to the key modulo the shard count
+    ShardRouter(std::string_view keyColumn, size_t shardCount, ShardFunction shardOf = &modulo)
+        : key_(keyColumn), shard_count_(shardCount > 0 ? shardCount : 1), shard_of_(shardOf) {}
 
-template<typename Config>
-inline Condition<Config> operator<(const Column<Config>& col, const SqlValue<Config>& val) {
-    return col.lt(val);
-}
+    template<typename T>
+    ShardRouter(const TypedColumn<T, Config>& keyColumn, size_t shardCount, ShardFunction shardOf = &modulo)
+        : ShardRouter(keyColumn.name(), shardCount, shardOf) {}
+
+    [[nodiscard]] std::string_view keyColumn() const { return key_; }
+    [[nodiscard]] size_t shardCount() const { return shard_count_; }
+
+    // Shard of the rows whose key is `value`. nullopt for values without a
+    // routing key and placeholders missing from `parameters`.
+    [[nodiscard]] std::optional<size_t> shardOf(const SqlValue<Config>& value,
+                                                std::span<const Parameter> parameters = {}) const {
+        const SqlValue<Config>* resolved = &value;
+        if (const auto placeholder = value.placeholder()) {
+            resolved = find(*placeholder, parameters);
+            if (!resolved) {
+                return std::nullopt;
+            }
+        }
+        const auto key = resolved->routingKey();
+        if (!key) {
+            return std::nullopt;
+        }
+        return shard_of_(*key, shard_count_) % shard_count_;
+    }
 
-template<typename Config, SqlCompatible T>
-inline Condition<Config> operator<(const Column<Config>& col, T&& val) {
-    return col.lt(std::forward<T>(val));
-}
+    [[nodiscard]] Result<Route> route(const Builder& builder, std::span<const Parameter> parameters = {}) const {
+        Route route;
+        route.target = builder.isReadOnly() ? RouteTarget::Replica : RouteTarget::Primary;
+
+        const auto type = builder.core_.type;
+        if (type == Builder::QueryType::Update) {
+            const auto& set = builder.columns_.values;
+            for (size_t i = 0; i < set.size(); ++i) {
+                if (detail::sameColumn(set[i].first, key_)) {
+                    return QueryError(QueryError::Code::InvalidOperation,
+                                      "UPDATE sets the shard key: move the row with a DELETE and an INSERT");
+                }
+            }
+        }
 
-template<typename Config>
-inline Condition<Config> operator<=(const Column<Config>& col, const SqlValue<Config>& val) {
-    return col.le(val);
-}
+        std::vector<SqlValue<Config>> values;
+        const size_t source = builder.keyCondition(key_, values);
+        route.keyed = source != Builder::NoKey && shardsOf(values, parameters, route.shards);
+        if (type == Builder::QueryType::Insert || type == Builder::QueryType::InsertOrReplace) {
+            // Every shard would get a copy of the row, or none would get it
+            if (source == Builder::NoKey) {
+                return QueryError(QueryError::Code::InvalidOperation, "INSERT does not set the shard key");
+            }
+            if (!route.keyed) {
+                return QueryError(QueryError::Code::InvalidOperation,
+                                  "INSERT sets the shard key to a value that cannot be routed: pass its placeholder in the parameters");
+            }
+        }
+        if (!route.keyed) {
+            route.shards.resize(shard_count_);
+            std::iota(route.shards.begin(), route.shards.end(), size_t{0});
+        }
 
-template<typename Config, SqlCompatible T>
-inline Condition<Config> operator<=(const Column<Config>& col, T&& val) {
-    return col.le(std::forward<T>(val));
-}
+        if (builder.core_.type == Builder::QueryType::Select) {
+            const auto& columns = builder.columns_.select_columns;
+            route.ordered = builder.ordering_.order_by.size() > 0;
+            route.grouped = builder.ordering_.group_by.size() > 0;
+            for (size_t i = 0; i < columns.size() && !route.grouped; ++i) {
+                route.grouped = columns[i].function() != SqlFunction::None;
+            }
+            route.distinct = builder.core_.distinct;
+            route.limit = builder.ordering_.limit;
+            route.offset = builder.ordering_.offset;
+        }
+        return route;
+    }
 
-template<typename Config>
-inline Condition<Config> operator>(const Column<Config>& col, const SqlValue<Config>& val) {
-    return col.gt(val);
-}
+    // One statement per shard of route(builder). On a fan out, a key
+    // restricted by IN keeps only the values of each shard, and LIMIT n
+    // OFFSET m becomes LIMIT n + m, since which rows to skip is only known
+    // once the results are combined. Grouped statements lose LIMIT and
+    // OFFSET on the shards, which only return partial groups.
+    [[nodiscard]] Result<std::vector<ShardQuery>> split(const Builder& builder,
+                                                        std::span<const Parameter> parameters = {}) const {
+        auto routed = route(builder, parameters);
+        if (routed.hasError()) {
+            return routed.error();
+        }
+        const Route& target = routed.value();
+
+        std::vector<SqlValue<Config>> values;
+        const size_t source = builder.keyCondition(key_, values);
+        const auto& where = builder.filters_.where_conditions;
+        const bool narrow = target.keyed && target.fanOut() && source < where.size() &&
+                            where[source].getType() == Condition<Config>::Type::In;
+        const bool partial = target.fanOut() && target.grouped && (target.limit >= 0 || target.offset >= 0);
+        const bool window = target.fanOut() && !target.grouped && target.limit >= 0 && target.offset > 0;
+
+        std::vector<ShardQuery> queries;
+        queries.reserve(target.shards.size());
+        for (const size_t shard : target.shards) {
+            ShardQuery& entry = queries.emplace_back(ShardQuery{shard, builder});
+            if (narrow) {
+                std::vector<SqlValue<Config>> share;
+                for (const auto& value : values) {
+                    if (shardOf(value, parameters) == shard) {
+                        share.push_back(value);
+                    }
+                }
+                entry.query.replaceWhere(source, where[source].withValues(std::move(share)));
+            }
+            if (partial) {
+                entry.query.limit(-1).offset(-1);
+            } else if (window) {
+                entry.query.limit(target.limit + target.offset).offset(-1);
+            }
+        }
+        return queries;
+    }
+};
 
-template<typename Config, SqlCompatible T>
-inline Condition<Config> operator>(const Column<Config>& col, T&& val) {
-    return col.gt(std::forward<T>(val));
-}
+//=====================
+// Batch Building
+//=====================
 
-template<typename Config>
-inline Condition<Config> operator>=(const Column<Config>& col, const SqlValue<Config>& val) {
-    return col.ge(val);
-}
+struct BatchBuildOptions {
+    size_t threads{0};              // Worker threads, 0 for hardware_concurrency()
+    size_t chunk_size{256};         // Statements rendered by a worker at a time
+    size_t max_chunks_in_flight{0}; // Rendered but not yet emitted, 0 for 4 per thread
+    std::string_view separator{";\n"}; // Between statements when appending to a SqlSink
+};
 
-template<typename Config, SqlCompatible T>
-inline Condition<Config> operator>=(const Column<Config>& col, T&& val) {
-    return col.ge(std::forward<T>(val));
-}
-// new
-template<typename T, typename Config>
-inline Condition<Config> operator==(const TypedColumn<T, Config>& col, const SqlValue<Config>& val) {
-    return col.eq(val);
-}
+namespace detail {
+// Shared state of one buildBatch() call. Chunks are handed out in order and
+// rendered into a ring of reused buffers; the caller emits them in order and
+// workers never run more than the ring size ahead of it.
+struct BatchBuildState {
+    struct Chunk {
+        std::string text;
+        std::vector<size_t> ends;   // End offset of each statement in `text`
+        QueryError error;
+        size_t error_index{0};
+        std::exception_ptr exception;
+        bool ready{false};
+    };
 
-template<typename T, typename Config>
-inline Condition<Config> operator!=(const TypedColumn<T, Config>& col, const SqlValue<Config>& val) {
-    return col.ne(val);
-}
+    std::mutex mutex;
+    std::condition_variable chunk_ready;
+    std::condition_variable chunk_free;
+    std::vector<Chunk> ring;
+    size_t next_chunk{0};
+    size_t emitted_chunks{0};
+    bool stop{false};
+    std::vector<std::thread> workers;
+
+    explicit BatchBuildState(size_t ringSize) : ring(ringSize) {}
+
+    BatchBuildState(const BatchBuildState&) = delete;
+    BatchBuildState& operator=(const BatchBuildState&) = delete;
+
+    // Also reached when the caller's sink throws: release and join the workers
+    ~BatchBuildState() {
+        {
+            std::lock_guard lock(mutex);
+            stop = true;
+        }
+        chunk_free.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+};
 
-template<typename T, typename Config>
-inline Condition<Config> operator<(const TypedColumn<T, Config>& col, const SqlValue<Config>& val) {
-    return col.lt(val);
+template<typename Generate>
+void renderBatchChunk(BatchBuildState::Chunk& chunk, Generate& generate, size_t first, size_t last) {
+    chunk.text.clear();
+    chunk.ends.clear();
+    chunk.error = QueryError();
+    chunk.exception = nullptr;
+    try {
+        for (size_t i = first; i < last; ++i) {
+            auto result = generate(i).buildInto(chunk.text);
+            if (result.hasError()) {
+                chunk.error = result.error();
+                chunk.error_index = i;
+                return;
+            }
+            chunk.ends.push_back(chunk.text.size());
+        }
+    } catch (...) {
+        chunk.exception = std::current_exception();
+    }
 }
+} // namespace detail
+
+// Render `count` statements across a pool of worker threads and hand them to
+// `sink` in index order. `generate(i)` returns the i-th builder (or a const
+// reference to it) and is called concurrently from the workers, so building
+// the query there is parallelized as well.
+//
+// `sink` is either a SqlSink, which receives the statements joined by
+// `options.separator`, or a callable taking (size_t index, std::string_view sql).
+// Sinks are only called from the calling thread.
+//
+// Returns the number of statements emitted. On the first failing builder its
+// error is returned and the statements before it have already been emitted;
+// exceptions thrown by `generate` are rethrown the same way.
+template<typename Generate, typename Sink>
+Result<size_t> buildBatch(size_t count, Generate&& generate, Sink&& sink, const BatchBuildOptions& options = {}) {
+    constexpr bool joined = SqlSink<std::remove_reference_t<Sink>>;
+    size_t emitted = 0;
+
+    auto emit = [&](const detail::BatchBuildState::Chunk& chunk) {
+        size_t begin = 0;
+        for (size_t end : chunk.ends) {
+            const std::string_view statement(chunk.text.data() + begin, end - begin);
+            if constexpr (joined) {
+                if (emitted > 0) sink += options.separator;
+                sink += statement;
+            } else {
+                sink(emitted, statement);
+            }
+            begin = end;
+            ++emitted;
+        }
+    };
 
-template<typename T, typename Config>
-inline Condition<Config> operator<=(const TypedColumn<T, Config>& col, const SqlValue<Config>& val) {
-    return col.le(val);
-}
+    const size_t chunkSize = options.chunk_size > 0 ? options.chunk_size : 1;
+    const size_t chunkCount = (count + chunkSize - 1) / chunkSize;
+    size_t threads = options.threads > 0 ? options.threads : std::thread::hardware_concurrency();
+    threads = std::min(threads, chunkCount);
+
+    // Not worth a thread: render on the caller, one chunk at a time
+    if (threads <= 1) {
+        detail::BatchBuildState::Chunk chunk;
+        for (size_t first = 0; first < count; first += chunkSize) {
+            detail::renderBatchChunk(chunk, generate, first, std::min(first + chunkSize, count));
+            emit(chunk);
+            if (chunk.exception) {
+                std::rethrow_exception(chunk.exception);
+            }
+            if (chunk.error) {
+                return chunk.error;
+            }
+        }
+        return emitted;
+    }
 
-template<typename T, typename Config>
-inline Condition<Config> operator>(const TypedColumn<T, Config>& col, const SqlValue<Config>& val) {
-    return col.gt(val);
-}
+    const size_t inFlight = options.max_chunks_in_flight > 0 ? options.max_chunks_in_flight : threads * 4;
+    detail::BatchBuildState state(inFlight);
+
+    auto work = [&state, &generate, count, chunkSize, chunkCount]() {
+        for (;;) {
+            size_t index;
+            {
+                std::unique_lock lock(state.mutex);
+                state.chunk_free.wait(lock, [&] {
+                    return state.stop || state.next_chunk >= chunkCount ||
+                           state.next_chunk < state.emitted_chunks + state.ring.size();
+                });
+                if (state.stop || state.next_chunk >= chunkCount) {
+                    return;
+                }
+                index = state.next_chunk++;
+            }
 
-template<typename T, typename Config>
-inline Condition<Config> operator>=(const TypedColumn<T, Config>& col, const SqlValue<Config>& val) {
-    return col.ge(val);
-}
+            // The ring slot is free: its previous chunk has been emitted
+            auto& chunk = state.ring[index % state.ring.size()];
+            const size_t first = index * chunkSize;
+            detail::renderBatchChunk(chunk, generate, first, std::min(first + chunkSize, count));
 
-// Qt type operator overloads
-#ifdef SQLQUERYBUILDER_USE_QT
-template<typename Config>
-inline Condition<Config> operator==(const Column<Config>& col, const QString& val) {
-    return col.eq(std::string_view(val.toStdString()));
-}
+            {
+                std::lock_guard lock(state.mutex);
+                chunk.ready = true;
+            }
+            state.chunk_ready.notify_one();
+        }
+    };
 
-template<typename Config>
-inline Condition<Config> operator!=(const Column<Config>& col, const QString& val) {
-    return col.ne(std::string_view(val.toStdString()));
-}
+    state.workers.reserve(threads);
+    for (size_t i = 0; i < threads; ++i) {
+        state.workers.emplace_back(work);
+    }
 
-template<typename Config>
-inline Condition<Config> operator<(const Column<Config>& col, const QDateTime& val) {
-    return col.lt(val);
-}
+    for (size_t index = 0; index < chunkCount; ++index) {
+        auto& chunk = state.ring[index % state.ring.size()];
+        {
+            std::unique_lock lock(state.mutex);
+            state.chunk_ready.wait(lock, [&] { return chunk.ready; });
+        }
 
-template<typename Config>
-inline Condition<Config> operator<=(const Column<Config>& col, const QDateTime& val) {
-    return col.le(val);
-}
+        emit(chunk);
+        if (chunk.exception) {
+            std::rethrow_exception(chunk.exception);
+        }
+        if (chunk.error) {
+            return chunk.error;
+        }
 
-template<typename Config>
-inline Condition<Config> operator>(const Column<Config>& col, const QDateTime& val) {
-    return col.gt(val);
+        {
+            std::lock_guard lock(state.mutex);
+            chunk.ready = false;
+            ++state.emitted_chunks;
+        }
+        state.chunk_free.notify_all();
+    }
+    return emitted;
 }
 
-template<typename Config>
-inline Condition<Config> operator>=(const Column<Config>& col, const QDateTime& val) {
-    return col.ge(val);
+// Render prepared builders; see the generator overload above
+template<typename Config, typename Sink>
+Result<size_t> buildBatch(std::span<const QueryBuilder<Config>> builders, Sink&& sink,
+                          const BatchBuildOptions& options = {}) {
+    return buildBatch(builders.size(),
+                      [builders](size_t index) -> const QueryBuilder<Config>& { return builders[index]; },
+                      std::forward<Sink>(sink), options);
 }
 
-inline std::ostream& operator<<(std::ostream& os, const QString& str) {
-    return os << str.toStdString();
+template<typename Config, typename Sink>
+Result<size_t> buildBatch(const std::vector<QueryBuilder<Config>>& builders, Sink&& sink,
+                          const BatchBuildOptions& options = {}) {
+    return buildBatch(std::span<const QueryBuilder<Config>>(builders), std::forward<Sink>(sink), options);
 }
-#endif
 
-// SQL function types
-enum class SqlFunction {
-    None,
-    Count,
-    Sum,
-    Avg,
-    Min,
-    Max,
-    GroupConcat
-};
+//=====================
+// Compile-time Queries
+//=====================
+
+// SQL text rendered during constant evaluation, together with the positions
+// of its bind parameters. Building past the capacity throws, which turns into
+// a compile error when the query is declared constexpr.
+template<size_t Capacity, size_t MaxSlots = 32>
+class StaticSql {
+public:
+    struct Slot {
+        size_t offset{0};
+        size_t length{0};
+    };
 
-// Column reference
-template<typename Config = DefaultConfig>
-class ColumnRef {
 private:
-    std::string_view column_;
-    SqlFunction function_ = SqlFunction::None;
-    std::string_view alias_; // Optional column alias
+    std::array<char, Capacity + 1> text_{};
+    size_t size_{0};
+    std::array<Slot, MaxSlots> slots_{};
+    size_t slot_count_{0};
 
 public:
-    ColumnRef() = default;
+    constexpr StaticSql() = default;
 
-    explicit ColumnRef(std::string_view column, SqlFunction function = SqlFunction::None, std::string_view alias = "")
-        : column_(column), function_(function), alias_(alias) {}
+    constexpr void append(std::string_view text) {
+        if (text.size() > Capacity - size_) {
+            throw QueryError(QueryError::Code::BufferOverflow, "Static query exceeds its capacity");
+        }
+        for (char c : text) {
+            text_[size_++] = c;
+        }
+    }
 
-    std::string_view column() const { return column_; }
-    SqlFunction function() const { return function_; }
-    std::string_view alias() const { return alias_; }
+    constexpr void push_back(char c) { append(std::string_view(&c, 1)); }
 
-    // Create an aliased column
-    ColumnRef as(std::string_view alias) const {
-        return ColumnRef(column_, function_, alias);
+    constexpr StaticSql& operator+=(std::string_view text) {
+        append(text);
+        return *this;
     }
 
-    void toSql(std::string& query) const {
-        switch (function_) {
-        case SqlFunction::Count:
-            query += "COUNT(";
-            query += column_;
-            query += ")";
-            break;
-        case SqlFunction::Sum:
-            query += "SUM(";
-            query += column_;
-            query += ")";
-            break;
-        case SqlFunction::Avg:
-            query += "AVG(";
-            query += column_;
-            query += ")";
-            break;
-        case SqlFunction::Min:
-            query += "MIN(";
-            query += column_;
-            query += ")";
-            break;
-        case SqlFunction::Max:
-            query += "MAX(";
-            query += column_;
-            query += ")";
-            break;
-        case SqlFunction::GroupConcat:
-            query += "GROUP_CONCAT(";
-            query += column_;
-            query += ")";
-            break;
-        case SqlFunction::None:
-        default:
-            query += column_;
-            break;
+    // Append a fragment, carrying its slots along
+    template<size_t OtherCapacity, size_t OtherSlots>
+    constexpr void append(const StaticSql<OtherCapacity, OtherSlots>& other) {
+        const size_t base = size_;
+        append(other.view());
+        for (size_t i = 0; i < other.slotCount(); ++i) {
+            markSlot(base + other.slot(i).offset, other.slot(i).length);
         }
+    }
 
-        if (!alias_.empty()) {
-            query += " AS ";
-            query += alias_;
+    // Append a placeholder token ("?", ":name") and record it as a slot
+    constexpr void appendSlot(std::string_view token) {
+        const size_t offset = size_;
+        append(token);
+        markSlot(offset, token.size());
+    }
+
+    constexpr void markSlot(size_t offset, size_t length) {
+        if (slot_count_ == MaxSlots) {
+            throw QueryError(QueryError::Code::InvalidOperation, "Too many parameters in static query");
         }
+        slots_[slot_count_++] = Slot{offset, length};
+    }
+
+    [[nodiscard]] constexpr std::string_view view() const { return {text_.data(), size_}; }
+    [[nodiscard]] constexpr const char* c_str() const { return text_.data(); }
+    [[nodiscard]] constexpr size_t size() const { return size_; }
+    [[nodiscard]] constexpr bool empty() const { return size_ == 0; }
+    [[nodiscard]] constexpr size_t slotCount() const { return slot_count_; }
+    [[nodiscard]] constexpr const Slot& slot(size_t index) const { return slots_[index]; }
+
+    [[nodiscard]] std::string sql() const { return std::string(view()); }
+
+    // Runtime statement with the same slot table QueryBuilder::compile() produces
+    template<typename Config = DefaultConfig>
+    [[nodiscard]] CompiledQuery<Config> compile() const {
+        std::vector<BindSlot> slots;
+        slots.reserve(slot_count_);
+        for (size_t i = 0; i < slot_count_; ++i) {
+            const std::string_view token = view().substr(slots_[i].offset, slots_[i].length);
+            PlaceholderStyle style = PlaceholderStyle::QuestionMark;
+            switch (token[0]) {
+            case ':': style = PlaceholderStyle::Colon; break;
+            case '@': style = PlaceholderStyle::At; break;
+            case '$': style = PlaceholderStyle::Dollar; break;
+            default: break;
+            }
+            slots.push_back(BindSlot{style == PlaceholderStyle::QuestionMark ? std::string() : std::string(token),
+                                     style, slots_[i].offset, slots_[i].length});
+        }
+        return CompiledQuery<Config>(std::string(view()), std::move(slots));
     }
 };
 
-// Join class
-template<typename Config>
-class Join {
+namespace detail {
+template<typename Out, std::integral T>
+constexpr void appendStaticInteger(Out& out, T value) {
+    uint64_t magnitude = static_cast<uint64_t>(value);
+    if constexpr (std::is_signed_v<T>) {
+        if (value < 0) {
+            out.push_back('-');
+            magnitude = 0 - magnitude;
+        }
+    }
+    char digits[20]{};
+    size_t count = 0;
+    do {
+        digits[count++] = static_cast<char>('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude != 0);
+    while (count > 0) {
+        out.push_back(digits[--count]);
+    }
+}
+
+template<typename T>
+inline constexpr bool is_static_numeric = std::is_arithmetic_v<T> || std::is_enum_v<T>;
+
+template<typename T>
+struct is_static_text : std::bool_constant<std::is_convertible_v<T, std::string_view>> {};
+
+#ifdef SQLQUERYBUILDER_USE_QT
+template<> struct is_static_text<QString> : std::true_type {};
+template<> struct is_static_text<QDateTime> : std::true_type {};
+#endif
+
+// Whether a value of type `Value` may be compared with or assigned to a
+// column of type `Column`; void stands for a bind parameter
+template<typename Column, typename Value>
+inline constexpr bool static_comparable = std::is_void_v<Value> ||
+    (is_static_numeric<Column> && is_static_numeric<Value>) ||
+    (is_static_text<Column>::value && is_static_text<Value>::value);
+} // namespace detail
+
+// Right-hand side of a compile-time condition or assignment: a bind
+// parameter or a literal. `T` is the literal's type (void for parameters)
+// and is checked against the column it is used with.
+template<typename T = void>
+class StaticOperand {
 public:
-    enum class Type : uint8_t { Inner, Left, Right, Full, Cross };
+    using value_type = T;
+    using Text = StaticSql<96, 1>;
 
 private:
-    Type type_;
-    std::string_view table_;
-    std::string_view condition_;
+    Text text_;
 
 public:
-    Join() = default;
-
-    Join(Type type, std::string_view table, std::string_view condition)
-        : type_(type), table_(table), condition_(condition) {}
+    constexpr explicit StaticOperand(const Text& text) : text_(text) {}
 
-    void toString(std::string& query) const {
-        const char* type_str = "";
-        switch (type_) {
-        case Type::Inner: type_str = "INNER JOIN"; break;
-        case Type::Left:  type_str = "LEFT JOIN"; break;
-        case Type::Right: type_str = "RIGHT JOIN"; break;
-        case Type::Full:  type_str = "FULL JOIN"; break;
-        case Type::Cross: type_str = "CROSS JOIN"; break;
-        }
+    [[nodiscard]] constexpr const Text& text() const { return text_; }
+};
 
-        query += type_str;
-        query += " ";
-        query += table_;
-        query += " ON ";
-        query += condition_;
+// Bind parameter: "?" when unnamed; names without a prefix get ':' as with Placeholder
+[[nodiscard]] constexpr StaticOperand<> param(std::string_view name = "") {
+    StaticOperand<>::Text text;
+    if (name.empty() || name == "?") {
+        text.appendSlot("?");
+    } else if (name[0] == ':' || name[0] == '@' || name[0] == '$') {
+        text.appendSlot(name);
+    } else {
+        text.push_back(':');
+        text.append(name);
+        text.markSlot(0, text.size());
     }
+    return StaticOperand<>(text);
+}
 
-    [[nodiscard]] std::string toString() const {
-        std::string result;
-        result.reserve(table_.size() + condition_.size() + 20);
-        toString(result);
-        return result;
+// Literal rendered at compile time, formatted like SqlValue
+template<typename T>
+    requires detail::is_static_numeric<T>
+[[nodiscard]] constexpr StaticOperand<T> lit(T value) {
+    static_assert(!std::is_floating_point_v<T>,
+                  "Floating-point literals are not rendered at compile time; bind them with sql::param()");
+    typename StaticOperand<T>::Text text;
+    if constexpr (std::is_same_v<T, bool>) {
+        text.append(value ? keywords::TRUE_VALUE : keywords::FALSE_VALUE);
+    } else if constexpr (std::is_enum_v<T>) {
+        detail::appendStaticInteger(text, static_cast<std::underlying_type_t<T>>(value));
+    } else if constexpr (std::is_integral_v<T>) {
+        detail::appendStaticInteger(text, value);
     }
-};
+    return StaticOperand<T>(text);
+}
 
-// Placeholder class to represent a SQL parameter placeholder
-template <typename Config>
-class Placeholder {
-private:
-    std::string name_;
-    enum class Style {
-        QuestionMark,  // ?
-        Dollar,        // $1, $2, etc.
-        Colon,         // :name
-        At             // @name
-    };
-    Style style_;
+[[nodiscard]] constexpr StaticOperand<std::string_view> lit(std::string_view value) {
+    StaticOperand<std::string_view>::Text text;
+    text.push_back('\'');
+    for (char c : value) {
+        if (c == '\'') text.push_back('\'');
+        text.push_back(c);
+    }
+    text.push_back('\'');
+    return StaticOperand<std::string_view>(text);
+}
 
+// WHERE condition of a static query, rendered as it is composed in the same
+// format as Condition. It remembers the tables its columns belong to so that
+// StaticQuery::build() can check them against FROM and JOIN.
+class StaticCondition {
 public:
-    explicit Placeholder(std::string_view name = "")
-        : name_(name) {
-        if (name.empty()) {
-            style_ = Style::QuestionMark;
-        } else if (name[0] == ':') {
-            style_ = Style::Colon;
-        } else if (name[0] == '@') {
-            style_ = Style::At;
-        } else if (name[0] == '$') {
-            style_ = Style::Dollar;
-        } else {
-            style_ = Style::Colon;
-            name_ = ":" + std::string(name);
-        }
-    }
+    static constexpr size_t MaxTables = 8;
+    using Text = StaticSql<256, 16>;
 
-    [[nodiscard]] std::string toString() const {
-        switch (style_) {
-        case Style::QuestionMark:
-            return "?";
-        case Style::Dollar:
-        case Style::Colon:
-        case Style::At:
-            return name_;
-        default:
-            return "?";
+private:
+    Text text_;
+    std::array<std::string_view, MaxTables> tables_{};
+    size_t table_count_{0};
+
+    constexpr void addTable(std::string_view table) {
+        if (table.empty()) return;
+        for (size_t i = 0; i < table_count_; ++i) {
+            if (tables_[i] == table) return;
         }
+        if (table_count_ == MaxTables) {
+            throw QueryError(QueryError::Code::InvalidCondition, "Too many tables in static condition");
+        }
+        tables_[table_count_++] = table;
     }
 
-    [[nodiscard]] constexpr bool isPlaceholder() const { return true; }
-};
-
-// A class that holds a fluent where builder for complex conditions
-template<typename Config>
-class WhereBuilder {
-private:
-    using ConditionFn = std::function<void(WhereBuilder<Config>&)>;
-    Condition<Config> condition_;
+    static constexpr StaticCondition combine(const StaticCondition& left, const StaticCondition& right,
+                                             std::string_view op) {
+        StaticCondition result;
+        result.text_.append("(");
+        result.text_.append(left.text_);
+        result.text_.append(") ");
+        result.text_.append(op);
+        result.text_.append(" (");
+        result.text_.append(right.text_);
+        result.text_.append(")");
+        for (std::string_view table : left.tables()) result.addTable(table);
+        for (std::string_view table : right.tables()) result.addTable(table);
+        return result;
+    }
 
 public:
-    WhereBuilder() = default;
-
-    WhereBuilder& condition(const Condition<Config>& cond) {
-        condition_ = cond;
-        return *this;
+    constexpr StaticCondition() = default;
+
+    template<typename T, typename Config, typename V>
+    [[nodiscard]] static constexpr StaticCondition compare(const TypedColumn<T, Config>& column,
+                                                           std::string_view op,
+                                                           const StaticOperand<V>& rhs) {
+        static_assert(detail::static_comparable<T, V>, "Literal type does not match the column type");
+        StaticCondition result;
+        result.addTable(column.tableName());
+        result.text_.append(column.name());
+        result.text_.push_back(' ');
+        result.text_.append(op);
+        result.text_.push_back(' ');
+        result.text_.append(rhs.text());
+        return result;
     }
 
-    WhereBuilder& and_(const Condition<Config>& cond) {
-        if (condition_.isValid()) {
-            condition_ = condition_ && cond;
-        } else {
-            condition_ = cond;
-        }
-        return *this;
+    template<typename T, typename Config>
+    [[nodiscard]] static constexpr StaticCondition isNull(const TypedColumn<T, Config>& column) {
+        StaticCondition result;
+        result.addTable(column.tableName());
+        result.text_.append(column.name());
+        result.text_.append(" IS NULL");
+        return result;
     }
 
-    WhereBuilder& or_(const Condition<Config>& cond) {
-        if (condition_.isValid()) {
-            condition_ = condition_ || cond;
-        } else {
-            condition_ = cond;
-        }
-        return *this;
+    template<typename T, typename Config>
+    [[nodiscard]] static constexpr StaticCondition isNotNull(const TypedColumn<T, Config>& column) {
+        StaticCondition result;
+        result.addTable(column.tableName());
+        result.text_.append(column.name());
+        result.text_.append(" IS NOT NULL");
+        return result;
     }
 
-    WhereBuilder& and_(ConditionFn builder) {
-        WhereBuilder<Config> subBuilder;
-        builder(subBuilder);
-        return and_(subBuilder.build());
+    [[nodiscard]] constexpr const Text& text() const { return text_; }
+
+    [[nodiscard]] constexpr std::span<const std::string_view> tables() const {
+        return std::span<const std::string_view>(tables_.data(), table_count_);
     }
 
-    WhereBuilder& or_(ConditionFn builder) {
-        WhereBuilder<Config> subBuilder;
-        builder(subBuilder);
-        return or_(subBuilder.build());
+    constexpr StaticCondition operator&&(const StaticCondition& other) const {
+        return combine(*this, other, keywords::AND);
     }
 
-    Condition<Config> build() const {
-        return condition_;
+    constexpr StaticCondition operator||(const StaticCondition& other) const {
+        return combine(*this, other, keywords::OR);
     }
 
-    operator Condition<Config>() const {
-        return build();
+    constexpr StaticCondition operator!() const {
+        StaticCondition result;
+        result.text_.append("NOT (");
+        result.text_.append(text_);
+        result.text_.append(")");
+        for (std::string_view table : tables()) result.addTable(table);
+        return result;
     }
 };
 
+template<typename T, typename Config, typename V>
+constexpr StaticCondition operator==(const TypedColumn<T, Config>& column, const StaticOperand<V>& rhs) {
+    return StaticCondition::compare(column, "=", rhs);
+}
 
-template<typename Config = DefaultConfig>
-class QueryBuilder {
-public:
-    enum class QueryType : uint8_t { Select, Insert, InsertOrReplace, Update, Delete, Truncate };
+template<typename T, typename Config, typename V>
+constexpr StaticCondition operator!=(const TypedColumn<T, Config>& column, const StaticOperand<V>& rhs) {
+    return StaticCondition::compare(column, "!=", rhs);
+}
 
-private:
-    // Core frequently accessed fields
-    struct {
-        QueryType type{QueryType::Select};
-        std::string_view table;
-        bool distinct{false};
-    } core_;
+template<typename T, typename Config, typename V>
+constexpr StaticCondition operator<(const TypedColumn<T, Config>& column, const StaticOperand<V>& rhs) {
+    return StaticCondition::compare(column, "<", rhs);
+}
 
-    // Columns and values (high-frequency access)
-    struct {
-        std::array<ColumnRef<Config>, Config::MaxColumns> select_columns{};
-        size_t select_columns_count{0};
-        std::array<std::pair<std::string_view, SqlValue<Config>>, Config::MaxColumns> values{};
-        size_t values_count{0};
-    } columns_;
+template<typename T, typename Config, typename V>
+constexpr StaticCondition operator<=(const TypedColumn<T, Config>& column, const StaticOperand<V>& rhs) {
+    return StaticCondition::compare(column, "<=", rhs);
+}
 
-    // Conditions and joins (medium-frequency access)
-    struct {
-        std::array<Condition<Config>, Config::MaxConditions> where_conditions{};
-        size_t where_conditions_count{0};
-        std::array<Join<Config>, Config::MaxJoins> joins{};
-        size_t joins_count{0};
-    } filters_;
+template<typename T, typename Config, typename V>
+constexpr StaticCondition operator>(const TypedColumn<T, Config>& column, const StaticOperand<V>& rhs) {
+    return StaticCondition::compare(column, ">", rhs);
+}
 
-    // Ordering, grouping, and limits (low-frequency access)
-    struct {
-        std::array<std::pair<std::string_view, bool>, Config::MaxOrderBy> order_by{};
-        size_t order_by_count{0};
-        std::array<std::string_view, Config::MaxGroupBy> group_by{};
-        size_t group_by_count{0};
-        std::string_view having;
-        int32_t limit{-1};
-        int32_t offset{-1};
-    } ordering_;
+template<typename T, typename Config, typename V>
+constexpr StaticCondition operator>=(const TypedColumn<T, Config>& column, const StaticOperand<V>& rhs) {
+    return StaticCondition::compare(column, ">=", rhs);
+}
 
-    // Error handling
-    mutable std::optional<QueryError> last_error_;
+// Query builder evaluated at compile time, for statements whose shape and
+// literals are fixed. The SQL is produced in the same format as
+// QueryBuilder and ends up in read-only data:
+//
+//   constexpr auto query = sql::StaticQuery<>()
+//       .select(users.id, users.name)
+//       .from(users.table)
+//       .where(users.email == sql::param())
+//       .build();
+//   static_assert(query.view() == "SELECT id, name FROM users WHERE email = ?");
+//
+// Columns are checked against the FROM and JOIN tables, and literals against
+// the column types. Tables must be declared constexpr to be usable here.
+template<size_t Capacity = 512>
+class StaticQuery {
+public:
+    static constexpr size_t MaxColumns = 32;
+    static constexpr size_t MaxJoins = 4;
+    static constexpr size_t MaxConditions = 8;
+    static constexpr size_t MaxOrderBy = 8;
+    static constexpr size_t MaxGroupBy = 8;
 
-    [[nodiscard]] size_t estimateSize() const {
-        size_t size = 64; // Base size
-        size += core_.table.size();
-        size += columns_.select_columns_count * 20; // Average column name size + potential function/alias
-        size += filters_.where_conditions_count * 50; // Average condition size
-        size += filters_.joins_count * 60; // Average join size
-        size += ordering_.order_by_count * 25; // Column name + ASC/DESC
-        size += ordering_.group_by_count * 15; // Column name
-        size += ordering_.having.size();
-        if (ordering_.limit >= 0) size += 15;
-        if (ordering_.offset >= 0) size += 15;
-        return size;
-    }
+    using Sql = StaticSql<Capacity>;
+
+private:
+    enum class Kind : uint8_t { Select, Insert, Update, Delete };
 
-public:
-    QueryBuilder() = default;
+    struct ColumnItem {
+        std::string_view table;
+        std::string_view name;
+        std::string_view alias;
+        bool ascending{true};
+    };
 
-    QueryBuilder& reset() {
-        core_.type = QueryType::Select;
-        core_.table = "";
-        core_.distinct = false;
+    struct JoinItem {
+        std::string_view keyword;
+        std::string_view table;
+        ColumnItem left;
+        ColumnItem right;
+    };
 
-        columns_.select_columns_count = 0;
-        columns_.values_count = 0;
+    Kind kind_{Kind::Select};
+    bool distinct_{false};
+    std::string_view table_;
+    std::array<ColumnItem, MaxColumns> columns_{};
+    std::array<typename StaticOperand<>::Text, MaxColumns> values_{}; // INSERT values / UPDATE assignments
+    size_t column_count_{0};
+    std::array<JoinItem, MaxJoins> joins_{};
+    size_t join_count_{0};
+    std::array<StaticCondition, MaxConditions> where_{};
+    size_t where_count_{0};
+    std::array<ColumnItem, MaxGroupBy> group_by_{};
+    size_t group_by_count_{0};
+    std::array<ColumnItem, MaxOrderBy> order_by_{};
+    size_t order_by_count_{0};
+    int64_t limit_{-1};
+    int64_t offset_{-1};
+
+    static constexpr void require(bool ok, QueryError::Code code, std::string_view message) {
+        if (!ok) throw QueryError(code, message);
+    }
 
-        filters_.where_conditions_count = 0;
-        filters_.joins_count = 0;
+    template<typename T, typename Config>
+    static constexpr ColumnItem item(const TypedColumn<T, Config>& column) {
+        return ColumnItem{column.tableName(), column.name(), column.alias()};
+    }
 
-        ordering_.order_by_count = 0;
-        ordering_.group_by_count = 0;
-        ordering_.having = "";
-        ordering_.limit = -1;
-        ordering_.offset = -1;
+    static constexpr ColumnItem item(std::string_view expression) {
+        return ColumnItem{{}, expression, {}};
+    }
 
-        last_error_ = std::nullopt;
-        return *this;
+    constexpr void addColumn(const ColumnItem& column) {
+        require(column_count_ < MaxColumns, QueryError::Code::TooManyColumns, "Too many columns in static query");
+        columns_[column_count_++] = column;
     }
 
-    [[nodiscard]] std::optional<QueryError> lastError() const {
-        return last_error_;
+    constexpr bool knownTable(std::string_view table) const {
+        if (table.empty() || table == table_) return true;
+        for (size_t i = 0; i < join_count_; ++i) {
+            if (joins_[i].table == table) return true;
+        }
+        return false;
     }
 
-    template<typename... Cols>
-    QueryBuilder& select(Cols&&... cols) {
-        static_assert((QueryType::Select == QueryType::Select), "SELECT can only be used with SELECT queries");
-        core_.type = QueryType::Select;
-        const size_t additional = sizeof...(cols);
+    constexpr void checkColumn(const ColumnItem& column) const {
+        require(knownTable(column.table), QueryError::Code::InvalidColumn,
+                "Column belongs to a table that is not in FROM or JOIN");
+    }
 
-        if (columns_.select_columns_count + additional > Config::MaxColumns) {
-            auto error = QueryError(QueryError::Code::TooManyColumns,
-                                    std::format("Too many columns: limit is {}", Config::MaxColumns));
-            last_error_ = error;
-            if constexpr(Config::ThrowOnError) {
-                throw error;
+    constexpr void validate() const {
+        require(!table_.empty(), QueryError::Code::EmptyTable, "Table name not specified");
+        if (kind_ != Kind::Select) {
+            require(join_count_ == 0 && group_by_count_ == 0 && order_by_count_ == 0 && limit_ < 0 && offset_ < 0,
+                    QueryError::Code::InvalidOperation, "Clause is only valid for SELECT");
+        }
+        if (kind_ == Kind::Insert || kind_ == Kind::Update) {
+            require(column_count_ > 0, QueryError::Code::InvalidCondition, "No values specified");
+        }
+        require(kind_ != Kind::Insert || where_count_ == 0, QueryError::Code::InvalidOperation,
+                "WHERE is not valid for INSERT");
+        require(kind_ != Kind::Delete || column_count_ == 0, QueryError::Code::InvalidOperation,
+                "Columns are not valid for DELETE");
+
+        for (size_t i = 0; i < column_count_; ++i) checkColumn(columns_[i]);
+        for (size_t i = 0; i < join_count_; ++i) {
+            checkColumn(joins_[i].left);
+            checkColumn(joins_[i].right);
+        }
+        for (size_t i = 0; i < group_by_count_; ++i) checkColumn(group_by_[i]);
+        for (size_t i = 0; i < order_by_count_; ++i) checkColumn(order_by_[i]);
+        for (size_t i = 0; i < where_count_; ++i) {
+            for (std::string_view table : where_[i].tables()) {
+                require(knownTable(table), QueryError::Code::InvalidColumn,
+                        "Condition references a table that is not in FROM or JOIN");
             }
-            return *this;
         }
-
-        (addSelectColumn(std::forward<Cols>(cols)), ...);
-        return *this;
     }
 
-    template<typename T, size_t Extent>
-    QueryBuilder& select(std::span<const T, Extent> cols) {
-        static_assert((QueryType::Select == QueryType::Select), "SELECT can only be used with SELECT queries");
-        core_.type = QueryType::Select;
+    static constexpr void appendColumn(Sql& sql, const ColumnItem& column, bool qualified) {
+        if (qualified && !column.table.empty()) {
+            sql.append(column.table);
+            sql.push_back('.');
+        }
+        sql.append(column.name);
+    }
 
-        if (columns_.select_columns_count + cols.size() > Config::MaxColumns) {
-            auto error = QueryError(QueryError::Code::TooManyColumns,
-                                    std::format("Too many columns: limit is {}", Config::MaxColumns));
-            last_error_ = error;
-            if constexpr(Config::ThrowOnError) {
-                throw error;
+    constexpr void appendWhere(Sql& sql) const {
+        if (where_count_ == 0) return;
+        sql.push_back(' ');
+        sql.append(keywords::WHERE);
+        sql.push_back(' ');
+        for (size_t i = 0; i < where_count_; ++i) {
+            if (i > 0) {
+                sql.push_back(' ');
+                sql.append(keywords::AND);
+                sql.push_back(' ');
             }
-            return *this;
+            sql.append(where_[i].text());
         }
+    }
 
-        for (const auto& col : cols) {
-            if constexpr (std::is_convertible_v<T, std::string_view>) {
-                columns_.select_columns[columns_.select_columns_count++] = ColumnRef<Config>(static_cast<std::string_view>(col));
+    constexpr void buildSelect(Sql& sql) const {
+        sql.append(keywords::SELECT);
+        sql.push_back(' ');
+        if (distinct_) {
+            sql.append(keywords::DISTINCT);
+            sql.push_back(' ');
+        }
+
+        if (column_count_ == 0) {
+            sql.append(keywords::ALL);
+        }
+        for (size_t i = 0; i < column_count_; ++i) {
+            if (i > 0) sql.append(", ");
+            appendColumn(sql, columns_[i], false);
+            if (!columns_[i].alias.empty()) {
+                sql.append(" AS ");
+                sql.append(columns_[i].alias);
             }
         }
-        return *this;
-    }
 
-    template<typename T>
-    void addSelectColumn(const T& col) {
-        if constexpr (std::is_same_v<std::remove_cvref_t<T>, ColumnRef<Config>>) {
-            columns_.select_columns[columns_.select_columns_count++] = col;
-        } else if constexpr (std::is_convertible_v<T, std::string_view>) {
-            columns_.select_columns[columns_.select_columns_count++] = ColumnRef<Config>(static_cast<std::string_view>(col));
-        } else {
-            static_assert(std::is_convertible_v<T, std::string_view> ||
-                              std::is_same_v<std::remove_cvref_t<T>, ColumnRef<Config>>,
-                          "Column type not supported for select");
+        sql.push_back(' ');
+        sql.append(keywords::FROM);
+        sql.push_back(' ');
+        sql.append(table_);
+
+        for (size_t i = 0; i < join_count_; ++i) {
+            sql.push_back(' ');
+            sql.append(joins_[i].keyword);
+            sql.push_back(' ');
+            sql.append(joins_[i].table);
+            sql.append(" ON ");
+            appendColumn(sql, joins_[i].left, true);
+            sql.append(" = ");
+            appendColumn(sql, joins_[i].right, true);
         }
-    }
 
-    // Select from span
-    QueryBuilder& select(std::span<const std::string_view> cols) {
-        static_assert((QueryType::Select == QueryType::Select), "SELECT can only be used with SELECT queries");
-        core_.type = QueryType::Select;
+        appendWhere(sql);
 
-        if (columns_.select_columns_count + cols.size() > Config::MaxColumns) {
-            auto error = QueryError(QueryError::Code::TooManyColumns,
-                                    std::format("Too many columns: limit is {}", Config::MaxColumns));
-            last_error_ = error;
-            if constexpr(Config::ThrowOnError) {
-                throw error;
+        if (group_by_count_ > 0) {
+            sql.push_back(' ');
+            sql.append(keywords::GROUP_BY);
+            sql.push_back(' ');
+            for (size_t i = 0; i < group_by_count_; ++i) {
+                if (i > 0) sql.append(", ");
+                appendColumn(sql, group_by_[i], false);
             }
-            return *this;
         }
 
-        for (const auto& col : cols) {
-            columns_.select_columns[columns_.select_columns_count++] = ColumnRef<Config>(col);
+        if (order_by_count_ > 0) {
+            sql.push_back(' ');
+            sql.append(keywords::ORDER_BY);
+            sql.push_back(' ');
+            for (size_t i = 0; i < order_by_count_; ++i) {
+                if (i > 0) sql.append(", ");
+                appendColumn(sql, order_by_[i], false);
+                sql.push_back(' ');
+                sql.append(order_by_[i].ascending ? keywords::ASC : keywords::DESC);
+            }
+        }
+
+        if (limit_ >= 0) {
+            sql.push_back(' ');
+            sql.append(keywords::LIMIT);
+            sql.push_back(' ');
+            detail::appendStaticInteger(sql, limit_);
+        }
+
+        if (offset_ >= 0) {
+            sql.push_back(' ');
+            sql.append(keywords::OFFSET);
+            sql.push_back(' ');
+            detail::appendStaticInteger(sql, offset_);
         }
-        return *this;
     }
 
-    // Select from array
-    template<size_t N>
-    QueryBuilder& select(const std::array<std::string_view, N>& cols) {
-        return select(std::span<const std::string_view>(cols));
+    constexpr void buildInsert(Sql& sql) const {
+        sql.append(keywords::INSERT);
+        sql.push_back(' ');
+        sql.append(keywords::INTO);
+        sql.push_back(' ');
+        sql.append(table_);
+        sql.append(" (");
+        for (size_t i = 0; i < column_count_; ++i) {
+            if (i > 0) sql.append(", ");
+            appendColumn(sql, columns_[i], false);
+        }
+        sql.append(") ");
+        sql.append(keywords::VALUES);
+        sql.append(" (");
+        for (size_t i = 0; i < column_count_; ++i) {
+            if (i > 0) sql.append(", ");
+            sql.append(values_[i]);
+        }
+        sql.push_back(')');
     }
 
-    // From method
-    template<typename T>
-    QueryBuilder& from(const T& table) {
-        if constexpr (std::is_convertible_v<T, std::string_view>) {
-            core_.table = static_cast<std::string_view>(table);
-        } else if constexpr (std::is_same_v<std::remove_cvref_t<T>, AliasedTable<Config>>) {
-            core_.table = table.toString();
-        } else {
-            static_assert(std::is_convertible_v<T, std::string_view> ||
-                              std::is_same_v<std::remove_cvref_t<T>, AliasedTable<Config>>,
-                          "Table type not supported for from");
+    constexpr void buildUpdate(Sql& sql) const {
+        sql.append(keywords::UPDATE);
+        sql.push_back(' ');
+        sql.append(table_);
+        sql.push_back(' ');
+        sql.append(keywords::SET);
+        sql.push_back(' ');
+        for (size_t i = 0; i < column_count_; ++i) {
+            if (i > 0) sql.append(", ");
+            appendColumn(sql, columns_[i], false);
+            sql.append(" = ");
+            sql.append(values_[i]);
         }
+        appendWhere(sql);
+    }
+
+    constexpr void buildDelete(Sql& sql) const {
+        sql.append(keywords::DELETE);
+        sql.push_back(' ');
+        sql.append(keywords::FROM);
+        sql.push_back(' ');
+        sql.append(table_);
+        appendWhere(sql);
+    }
+
+    template<typename Config, typename L, typename LC, typename R, typename RC>
+    constexpr StaticQuery& join(std::string_view keyword, const Table<Config>& table,
+                                const TypedColumn<L, LC>& left, const TypedColumn<R, RC>& right) {
+        static_assert(detail::static_comparable<L, R>, "Join columns have incompatible types");
+        require(join_count_ < MaxJoins, QueryError::Code::TooManyJoins, "Too many joins in static query");
+        joins_[join_count_++] = JoinItem{keyword, table.name(), item(left), item(right)};
         return *this;
     }
 
-    template<typename Fn>
-    QueryBuilder& where(Fn builderFn) {
-        WhereBuilder<Config> builder;
-        builderFn(builder);
-        return where(builder.build());
+public:
+    constexpr StaticQuery() = default;
+
+    template<typename... Cols>
+    constexpr StaticQuery& select(const Cols&... cols) {
+        kind_ = Kind::Select;
+        (addColumn(item(cols)), ...);
+        return *this;
     }
 
-    template<typename OtherConfig>
-    QueryBuilder& where(const Condition<OtherConfig>& condition) {
-        if (filters_.where_conditions_count >= Config::MaxConditions) {
-            auto error = QueryError(QueryError::Code::TooManyConditions,
-                                    std::format("Too many conditions: limit is {}", Config::MaxConditions));
-            last_error_ = error;
-            if constexpr(Config::ThrowOnError) {
-                throw error;
-            }
-            return *this;
-        }
+    constexpr StaticQuery& distinct() {
+        distinct_ = true;
+        return *this;
+    }
 
-        // Convert condition from OtherConfig to our Config
-        filters_.where_conditions[filters_.where_conditions_count++] = Condition<Config>(condition);
+    template<typename Config>
+    constexpr StaticQuery& from(const Table<Config>& table) {
+        table_ = table.name();
         return *this;
     }
 
-    template<SqlCompatible T>
-    QueryBuilder& whereOp(std::string_view column, typename ConditionBase<Config>::Op op, T&& value) {
-        if (filters_.where_conditions_count >= Config::MaxConditions) {
-            auto error = QueryError(QueryError::Code::TooManyConditions,
-                                    std::format("Too many conditions: limit is {}", Config::MaxConditions));
-            last_error_ = error;
-            if constexpr(Config::ThrowOnError) {
-                throw error;
-            }
-            return *this;
-        }
+    constexpr StaticQuery& from(std::string_view table) {
+        table_ = table;
+        return *this;
+    }
 
-        filters_.where_conditions[filters_.where_conditions_count++] = Condition<Config>(
-            column, op, SqlValue<Config>(std::forward<T>(value))
-            );
+    template<typename Config, typename L, typename LC, typename R, typename RC>
+    constexpr StaticQuery& innerJoin(const Table<Config>& table, const TypedColumn<L, LC>& left,
+                                     const TypedColumn<R, RC>& right) {
+        return join(keywords::INNER_JOIN, table, left, right);
+    }
+
+    template<typename Config, typename L, typename LC, typename R, typename RC>
+    constexpr StaticQuery& leftJoin(const Table<Config>& table, const TypedColumn<L, LC>& left,
+                                    const TypedColumn<R, RC>& right) {
+        return join(keywords::LEFT_JOIN, table, left, right);
+    }
+
+    // Conditions from repeated calls are AND-ed, as with QueryBuilder
+    constexpr StaticQuery& where(const StaticCondition& condition) {
+        require(where_count_ < MaxConditions, QueryError::Code::TooManyConditions,
+                "Too many conditions in static query");
+        where_[where_count_++] = condition;
         return *this;
     }
 
-    // OrderBy with bounds checking and compile-time validation
-    template<typename T>
-    QueryBuilder& orderBy(const T& column, bool asc = true) {
-        static_assert((QueryType::Select == QueryType::Select), "ORDER BY can only be used with SELECT queries");
+    template<typename... Cols>
+    constexpr StaticQuery& groupBy(const Cols&... cols) {
+        require(group_by_count_ + sizeof...(cols) <= MaxGroupBy, QueryError::Code::TooManyGroupBy,
+                "Too many GROUP BY columns in static query");
+        ((group_by_[group_by_count_++] = item(cols)), ...);
+        return *this;
+    }
 
-        if (ordering_.order_by_count >= Config::MaxOrderBy) {
-            auto error = QueryError(QueryError::Code::TooManyOrderBy,
-                                    std::format("Too many order by clauses: limit is {}", Config::MaxOrderBy));
-            last_error_ = error;
-            if constexpr(Config::ThrowOnError) {
-                throw error;
-            }
-            return *this;
-        }
+    template<typename Col>
+    constexpr StaticQuery& orderBy(const Col& column, bool ascending = true) {
+        require(order_by_count_ < MaxOrderBy, QueryError::Code::TooManyOrderBy,
+                "Too many ORDER BY columns in static query");
+        ColumnItem entry = item(column);
+        entry.ascending = ascending;
+        order_by_[order_by_count_++] = entry;
+        return *this;
+    }
 
-        if constexpr (std::is_convertible_v<T, std::string_view>) {
-            ordering_.order_by[ordering_.order_by_count++] = {static_cast<std::string_view>(column), asc};
-        } else {
-            static_assert(std::is_convertible_v<T, std::string_view>,
-                          "Column type not supported for orderBy");
-        }
+    constexpr StaticQuery& limit(int64_t count) {
+        limit_ = count;
         return *this;
     }
 
-    QueryBuilder& limit(int32_t limit) {
-        static_assert((QueryType::Select == QueryType::Select), "LIMIT can only be used with SELECT queries");
-        ordering_.limit = limit;
+    constexpr StaticQuery& offset(int64_t count) {
+        offset_ = count;
         return *this;
     }
 
-    QueryBuilder& offset(int32_t offset) {
-        static_assert((QueryType::Select == QueryType::Select), "OFFSET can only be used with SELECT queries");
-        ordering_.offset = offset;
+    template<typename Config>
+    constexpr StaticQuery& insert(const Table<Config>& table) {
+        kind_ = Kind::Insert;
+        table_ = table.name();
         return *this;
     }
 
-    QueryBuilder& distinct() {
-        static_assert((QueryType::Select == QueryType::Select), "DISTINCT can only be used with SELECT queries");
-        core_.distinct = true;
+    template<typename Config>
+    constexpr StaticQuery& update(const Table<Config>& table) {
+        kind_ = Kind::Update;
+        table_ = table.name();
         return *this;
     }
 
-    // Insert with bounds checking
-    template<typename T>
-    QueryBuilder& insert(const T& table) {
-        core_.type = QueryType::Insert;
-        if constexpr (std::is_convertible_v<T, std::string_view>) {
-            core_.table = static_cast<std::string_view>(table);
-        } else {
-            static_assert(std::is_convertible_v<T, std::string_view>,
-                          "Table type not supported for insert");
-        }
+    template<typename Config>
+    constexpr StaticQuery& deleteFrom(const Table<Config>& table) {
+        kind_ = Kind::Delete;
+        table_ = table.name();
         return *this;
     }
 
-    // Insert OR REPLACE with bounds checking
-    template<typename T>
-    QueryBuilder& insertOrReplace(const T& table) {
-        core_.type = QueryType::InsertOrReplace;
-        if constexpr (std::is_convertible_v<T, std::string_view>) {
-            core_.table = static_cast<std::string_view>(table);
-        } else {
-            static_assert(std::is_convertible_v<T, std::string_view>,
-                          "Table type not supported for insertOrReplace");
-        }
+    template<typename T, typename Config, typename V>
+    constexpr StaticQuery& value(const TypedColumn<T, Config>& column, const StaticOperand<V>& operand) {
+        static_assert(detail::static_comparable<T, V>, "Value type does not match the column type");
+        addColumn(item(column));
+        values_[column_count_ - 1] = operand.text();
         return *this;
     }
 
-    template<typename Col, SqlCompatible T>
-    QueryBuilder& value(const Col& column, T&& val) {
-        if (columns_.values_count >= Config::MaxColumns) {
-            auto error = QueryError(QueryError::Code::TooManyColumns,
-                                    std::format("Too many values: limit is {}", Config::MaxColumns));
-            last_error_ = error;
-            if constexpr(Config::ThrowOnError) {
-                throw error;
-            }
-            return *this;
-        }
+    template<typename T, typename Config, typename V>
+    constexpr StaticQuery& set(const TypedColumn<T, Config>& column, const StaticOperand<V>& operand) {
+        return value(column, operand);
+    }
 
-        if constexpr (std::is_convertible_v<Col, std::string_view>) {
-            // Direct assignment of the pair at the current index
-            columns_.values[columns_.values_count].first = static_cast<std::string_view>(column);
-            columns_.values[columns_.values_count].second = SqlValue<Config>(std::forward<T>(val));
-            columns_.values_count++;
-        } else {
-            static_assert(std::is_convertible_v<Col, std::string_view>,
-                          "Column type not supported for value");
+    [[nodiscard]] constexpr Sql build() const {
+        validate();
+        Sql sql;
+        switch (kind_) {
+        case Kind::Select: buildSelect(sql); break;
+        case Kind::Insert: buildInsert(sql); break;
+        case Kind::Update: buildUpdate(sql); break;
+        case Kind::Delete: buildDelete(sql); break;
         }
-        return *this;
+        return sql;
     }
+};
 
-    // Update methods
-    template<typename T>
-    QueryBuilder& update(const T& table) {
-        core_.type = QueryType::Update;
-        if constexpr (std::is_convertible_v<T, std::string_view>) {
-            core_.table = static_cast<std::string_view>(table);
-        } else {
-            static_assert(std::is_convertible_v<T, std::string_view>,
-                          "Table type not supported for update");
+//=====================
+// Schema Registry
+//=====================
+
+// Tables declared with SQL_DEFINE_TABLE list their columns at compile time.
+// A column is named by a pointer to its member, such as &users_table::name,
+// so Columns<&users_table::id, &users_table::name> is a SELECT list whose
+// row type and result positions are fixed before the query runs: a result
+// column is read by its index, with no lookup by name per row.
+namespace detail {
+template<size_t I>
+struct SchemaSlot {};  // Position of a column in its table, see SQL_DEFINE_COLUMN
+
+template<auto Member>
+struct SchemaMember {
+    static_assert(sizeof(Member) == 0, "Schema columns are pointers to SQL_DEFINE_COLUMN members");
+};
+
+template<typename Table, typename Column, Column Table::*Member>
+struct SchemaMember<Member> {
+    using table_type = Table;
+    using column_type = std::remove_cv_t<Column>;
+    using value_type = typename column_type::value_type;
+
+    static constexpr column_type column = Table{}.*Member;
+};
+
+template<auto A, auto B>
+constexpr bool sameMember() {
+    if constexpr(std::is_same_v<decltype(A), decltype(B)>) {
+        return A == B;
+    } else {
+        return false;
+    }
+}
+
+template<auto Needle, auto... Members>
+constexpr size_t memberIndex() {
+    size_t index = 0;
+    bool found = false;
+    ((found = found || sameMember<Needle, Members>(), index += found ? 0 : 1), ...);
+    return index;
+}
+
+template<typename Table, typename... Tables>
+constexpr bool oneOfTables = (std::is_base_of_v<Table, Tables> || ...);
+
+inline QueryError unjoinedColumn(std::string_view table, std::string_view column) {
+    return QueryError(QueryError::Code::InvalidColumn,
+                      keepMessage(std::format("Column {}.{} is not from a table in FROM or JOIN", table, column)));
+}
+} // namespace detail
+
+// Result layout of a SELECT of schema columns, in the order given
+template<auto... Members>
+struct Columns {
+    static_assert(sizeof...(Members) > 0, "A column list needs at least one column");
+
+    using Row = std::tuple<typename detail::SchemaMember<Members>::value_type...>;
+    using config_type =
+        typename std::tuple_element_t<0, std::tuple<detail::SchemaMember<Members>...>>::column_type::config_type;
+
+    static constexpr size_t size = sizeof...(Members);
+    static constexpr std::array<std::string_view, size> names{detail::SchemaMember<Members>::column.name()...};
+    static constexpr std::array<std::string_view, size> tables{detail::SchemaMember<Members>::column.tableName()...};
+
+    // Result column index of a selected member
+    template<auto Member>
+    static constexpr size_t indexOf = [] {
+        constexpr size_t index = detail::memberIndex<Member, Members...>();
+        static_assert(index < size, "Column is not part of this SELECT list");
+        return index;
+    }();
+
+    // Whether every column belongs to one of `Tables`, the FROM and joined
+    // tables of a query, for a static_assert at the call site
+    template<typename... Tables>
+    static constexpr bool within =
+        (detail::oneOfTables<typename detail::SchemaMember<Members>::table_type, Tables...> && ...);
+
+    // Field of a decoded row by column
+    template<auto Member>
+    [[nodiscard]] static constexpr decltype(auto) get(const Row& row) {
+        return std::get<indexOf<Member>>(row);
+    }
+
+    template<auto Member>
+    [[nodiscard]] static constexpr decltype(auto) get(Row& row) {
+        return std::get<indexOf<Member>>(row);
+    }
+
+    // Add the columns to the SELECT list of `query`, in layout order
+    template<typename Config>
+    static QueryBuilder<Config>& select(QueryBuilder<Config>& query) {
+        return query.select(detail::SchemaMember<Members>::column...);
+    }
+
+    // Error for the first column whose table `query` neither reads from nor
+    // joins, see QueryBuilder::hasTable()
+    template<typename Config>
+    [[nodiscard]] static std::optional<QueryError> check(const QueryBuilder<Config>& query) {
+        for (size_t i = 0; i < size; ++i) {
+            if (!query.hasTable(tables[i])) {
+                return detail::unjoinedColumn(tables[i], names[i]);
+            }
         }
-        return *this;
+        return std::nullopt;
     }
+};
+
+// The columns of a table declared with SQL_DEFINE_TABLE
+template<typename Table>
+struct Schema {
+    static constexpr std::string_view name = Table::sql_table_name;
+    static constexpr size_t size = Table::sql_column_count;
+
+    template<size_t I>
+    static constexpr auto member = Table::sql_column(detail::SchemaSlot<I>{});
+
+private:
+    template<size_t... I>
+    static auto allColumns(std::index_sequence<I...>) -> Columns<member<I>...>;
+
+public:
+    // Every column in declaration order, as for SELECT *
+    using All = decltype(allColumns(std::make_index_sequence<size>{}));
+
+    template<auto Member>
+    static constexpr size_t indexOf = All::template indexOf<Member>;
+};
+
+#ifdef SQLQUERYBUILDER_USE_QTSQL
+//=====================
+// Qt SQL Integration
+//=====================
+
+// QSqlQuery objects prepared from compiled statements on one connection,
+// kept so that each statement text is prepared only once. Like the
+// QSqlDatabase it wraps, an instance belongs to the thread that opened the
+// connection.
+//
+// Slots are bound from SqlValue by position, or by name for ":name"
+// placeholders, which Qt binds by name.
+template<typename Config = DefaultConfig>
+class PreparedStatements {
+public:
+    struct Stats {
+        size_t hits{0};
+        size_t misses{0};
+        size_t statements{0};
+    };
+
+private:
+    // Statement text with its hash. An interned statement brings its hash
+    // along and matches by pointer, so neither is computed per lookup.
+    struct Key {
+        std::string_view text;
+        uint64_t hash{0};
+
+        bool operator==(const Key& other) const {
+            return hash == other.hash && text.size() == other.text.size() &&
+                   (text.data() == other.text.data() || text == other.text);
+        }
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const { return static_cast<size_t>(key.hash); }
+    };
+
+    struct Entry {
+        std::string owned;  // Text of a statement that is not interned
+        Key key;            // Views into owned or into the SqlPool
+        std::unique_ptr<QSqlQuery> query;
+    };
 
-    template<typename Col, SqlCompatible T>
-    QueryBuilder& set(const Col& column, T&& val) {
-        if (columns_.values_count >= Config::MaxColumns) {
-            auto error = QueryError(QueryError::Code::TooManyColumns,
-                                    std::format("Too many values: limit is {}", Config::MaxColumns));
-            last_error_ = error;
-            if constexpr(Config::ThrowOnError) {
-                throw error;
-            }
-            return *this;
+    QSqlDatabase database_;
+    size_t max_statements_;  // 0 for no limit
+    std::list<Entry> lru_;   // Most recently used first
+    std::unordered_map<Key, typename std::list<Entry>::iterator, KeyHash> index_;
+    size_t hits_{0};
+    size_t misses_{0};
+    bool audit_plans_{false};
+
+public:
+    explicit PreparedStatements(QSqlDatabase database, size_t maxStatements = 64)
+        : database_(std::move(database)), max_statements_(maxStatements) {}
+
+    PreparedStatements(const PreparedStatements&) = delete;
+    PreparedStatements& operator=(const PreparedStatements&) = delete;
+
+    [[nodiscard]] const QSqlDatabase& database() const { return database_; }
+
+    // Query prepared for the statement, preparing it on first use. The
+    // pointer stays valid until the statement is evicted or clear() is called.
+    [[nodiscard]] Result<QSqlQuery*> prepare(const CompiledQuery<Config>& compiled) {
+        if (compiled.hasError()) {
+            return compiled.error();
         }
 
-        if constexpr (std::is_convertible_v<Col, std::string_view>) {
-            // Direct assignment of the pair at the current index
-            columns_.values[columns_.values_count].first = static_cast<std::string_view>(column);
-            columns_.values[columns_.values_count].second = SqlValue<Config>(std::forward<T>(val));
-            columns_.values_count++;
-        } else {
-            static_assert(std::is_convertible_v<Col, std::string_view>,
-                          "Column type not supported for set");
+        const auto interned = compiled.interned();
+        const Key key = keyOf(compiled);
+        if (auto it = index_.find(key); it != index_.end()) {
+            lru_.splice(lru_.begin(), lru_, it->second);
+            ++hits_;
+            return it->second->query.get();
+        }
+        ++misses_;
+
+        auto query = std::make_unique<QSqlQuery>(database_);
+        const bool prepared = interned
+            ? query->prepare(interned->qstring())
+            : query->prepare(QString::fromUtf8(compiled.sql().data(), static_cast<int>(compiled.sql().size())));
+        if (!prepared) {
+            return QueryError(QueryError::Code::DatabaseError, "Failed to prepare statement");
         }
-        return *this;
-    }
 
-    // Delete methods
-    template<typename T>
-    QueryBuilder& deleteFrom(const T& table) {
-        core_.type = QueryType::Delete;
-        if constexpr (std::is_convertible_v<T, std::string_view>) {
-            core_.table = static_cast<std::string_view>(table);
+        Entry& entry = lru_.emplace_front();
+        entry.query = std::move(query);
+        if (interned) {
+            entry.key = key;
         } else {
-            static_assert(std::is_convertible_v<T, std::string_view>,
-                          "Table type not supported for deleteFrom");
+            entry.owned = compiled.sql();
+            entry.key = Key{entry.owned, key.hash};
         }
-        return *this;
+        index_.emplace(entry.key, lru_.begin());
+        while (max_statements_ > 0 && lru_.size() > max_statements_) {
+            index_.erase(lru_.back().key);
+            lru_.pop_back();
+        }
+        return lru_.front().query.get();
     }
 
-    // Truncate methods
-    template<typename T>
-    QueryBuilder& truncate(const T& table) {
-        core_.type = QueryType::Truncate;
-        if constexpr (std::is_convertible_v<T, std::string_view>) {
-            core_.table = static_cast<std::string_view>(table);
-        } else {
-            static_assert(std::is_convertible_v<T, std::string_view>,
-                          "Table type not supported for truncate");
-        }
-        return *this;
+    // Bind one value per slot and execute. On a database error the query is
+    // still available from prepare() for lastError().
+    [[nodiscard]] Result<QSqlQuery*> exec(const CompiledQuery<Config>& compiled,
+                                          std::span<const SqlValue<Config>> values) {
+        return run(compiled, values, false);
     }
 
-    // Join methods with bounds checking
-    template<typename T>
-    QueryBuilder& innerJoin(const T& table, std::string_view condition) {
-        static_assert((QueryType::Select == QueryType::Select), "JOIN can only be used with SELECT queries");
-        if (filters_.joins_count >= Config::MaxJoins) {
-            auto error = QueryError(QueryError::Code::TooManyJoins,
-                                    std::format("Too many joins: limit is {}", Config::MaxJoins));
-            last_error_ = error;
-            if constexpr(Config::ThrowOnError) {
-                throw error;
-            }
-            return *this;
-        }
+    // Execute the builder with its literals bound as parameters. With a
+    // cache, the statement is only compiled once per query shape.
+    [[nodiscard]] Result<QSqlQuery*> exec(const QueryBuilder<Config>& builder,
+                                          QueryCache<Config>* cache = nullptr) {
+        return run(builder, cache, false);
+    }
 
-        if constexpr (std::is_convertible_v<T, std::string_view>) {
-            filters_.joins[filters_.joins_count++] = Join<Config>{
-                Join<Config>::Type::Inner,
-                static_cast<std::string_view>(table),
-                condition
-            };
-        } else if constexpr (std::is_same_v<std::remove_cvref_t<T>, AliasedTable<Config>>) {
-            filters_.joins[filters_.joins_count++] = Join<Config>{
-                Join<Config>::Type::Inner,
-                table.toString(),
-                condition
-            };
-        } else {
-            static_assert(std::is_convertible_v<T, std::string_view> ||
-                              std::is_same_v<std::remove_cvref_t<T>, AliasedTable<Config>>,
-                          "Table type not supported for innerJoin");
-        }
-        return *this;
+    // Like exec(), in forward-only mode: rows can only be read once, in
+    // order, which lets the driver skip caching the result set. For large
+    // results read with next(), such as typed row streams.
+    [[nodiscard]] Result<QSqlQuery*> stream(const CompiledQuery<Config>& compiled,
+                                            std::span<const SqlValue<Config>> values) {
+        return run(compiled, values, true);
     }
 
-    template<typename T, typename L, typename R>
-    QueryBuilder& innerJoin(const T& table, const Condition<Config>& condition) {
-        return innerJoin(table, condition.toString());
+    [[nodiscard]] Result<QSqlQuery*> stream(const QueryBuilder<Config>& builder,
+                                            QueryCache<Config>* cache = nullptr) {
+        return run(builder, cache, true);
     }
 
-    template<typename T>
-    QueryBuilder& leftJoin(const T& table, std::string_view condition) {
-        static_assert((QueryType::Select == QueryType::Select), "JOIN can only be used with SELECT queries");
-        if (filters_.joins_count >= Config::MaxJoins) {
-            auto error = QueryError(QueryError::Code::TooManyJoins,
-                                    std::format("Too many joins: limit is {}", Config::MaxJoins));
-            last_error_ = error;
-            if constexpr(Config::ThrowOnError) {
-                throw error;
+    // Execute the statement once per row, with one QVariantList per slot
+    // holding that slot's value for every row
+    [[nodiscard]] Result<QSqlQuery*> execBatch(const CompiledQuery<Config>& compiled,
+                                               std::span<const QVariantList> columns,
+                                               QSqlQuery::BatchExecutionMode mode = QSqlQuery::ValuesAsRows) {
+        if (columns.size() != compiled.slotCount()) {
+            return QueryError(QueryError::Code::InvalidOperation,
+                              "Batch column count does not match placeholder count");
+        }
+        for (const auto& column : columns) {
+            if (column.size() != columns.front().size()) {
+                return QueryError(QueryError::Code::InvalidOperation, "Batch columns differ in length");
             }
-            return *this;
         }
 
-        if constexpr (std::is_convertible_v<T, std::string_view>) {
-            filters_.joins[filters_.joins_count++] = Join<Config>{
-                Join<Config>::Type::Left,
-                static_cast<std::string_view>(table),
-                condition
-            };
-        } else if constexpr (std::is_same_v<std::remove_cvref_t<T>, AliasedTable<Config>>) {
-            filters_.joins[filters_.joins_count++] = Join<Config>{
-                Join<Config>::Type::Left,
-                table.toString(),
-                condition
-            };
-        } else {
-            static_assert(std::is_convertible_v<T, std::string_view> ||
-                              std::is_same_v<std::remove_cvref_t<T>, AliasedTable<Config>>,
-                          "Table type not supported for leftJoin");
+        auto prepared = prepare(compiled);
+        if (prepared.hasError()) {
+            return prepared;
         }
-        return *this;
-    }
 
-    template<typename T>
-    QueryBuilder& leftJoin(const T& table, const Condition<Config>& condition) {
-        return leftJoin(table, condition.toString());
+        QSqlQuery* query = prepared.value();
+        for (size_t i = 0; i < columns.size(); ++i) {
+            bind(*query, compiled.slots()[i], i, QVariant(columns[i]));
+        }
+        if (!query->execBatch(mode)) {
+            return QueryError(QueryError::Code::DatabaseError, "Failed to execute batch");
+        }
+        return query;
     }
 
-    template<typename T>
-    QueryBuilder& rightJoin(const T& table, std::string_view condition) {
-        static_assert((QueryType::Select == QueryType::Select), "JOIN can only be used with SELECT queries");
-        if (filters_.joins_count >= Config::MaxJoins) {
-            auto error = QueryError(QueryError::Code::TooManyJoins,
-                                    std::format("Too many joins: limit is {}", Config::MaxJoins));
-            last_error_ = error;
-            if constexpr(Config::ThrowOnError) {
-                throw error;
-            }
-            return *this;
+    // Run the statement's EXPLAIN with the same values and parse the plan,
+    // which is also reported to the Config::Observer. The EXPLAIN statement
+    // is prepared once and not kept. Analyze executes the statement.
+    [[nodiscard]] Result<QueryPlan> explain(const CompiledQuery<Config>& compiled,
+                                            std::span<const SqlValue<Config>> values,
+                                            ExplainMode mode = ExplainMode::Plan) {
+        if (values.size() != compiled.slotCount()) {
+            return QueryError(QueryError::Code::InvalidOperation,
+                              "Bind value count does not match placeholder count");
+        }
+        const auto wrapped = compiled.explain(mode);
+        if (wrapped.hasError()) {
+            return wrapped.error();
         }
 
-        if constexpr (std::is_convertible_v<T, std::string_view>) {
-            filters_.joins[filters_.joins_count++] = Join<Config>{
-                Join<Config>::Type::Right,
-                static_cast<std::string_view>(table),
-                condition
-            };
-        } else if constexpr (std::is_same_v<std::remove_cvref_t<T>, AliasedTable<Config>>) {
-            filters_.joins[filters_.joins_count++] = Join<Config>{
-                Join<Config>::Type::Right,
-                table.toString(),
-                condition
-            };
-        } else {
-            static_assert(std::is_convertible_v<T, std::string_view> ||
-                              std::is_same_v<std::remove_cvref_t<T>, AliasedTable<Config>>,
-                          "Table type not supported for rightJoin");
+        QSqlQuery query(database_);
+        query.setForwardOnly(true);
+        if (!query.prepare(QString::fromUtf8(wrapped.sql().data(), static_cast<int>(wrapped.sql().size())))) {
+            return QueryError(QueryError::Code::DatabaseError, "Failed to prepare EXPLAIN");
+        }
+        for (size_t i = 0; i < values.size(); ++i) {
+            bind(query, wrapped.slots()[i], i, values[i].toVariant());
+        }
+        if (!query.exec()) {
+            return QueryError(QueryError::Code::DatabaseError, "Failed to execute EXPLAIN");
         }
-        return *this;
-    }
 
-    template<typename T>
-    QueryBuilder& rightJoin(const T& table, const Condition<Config>& condition) {
-        return rightJoin(table, condition.toString());
+        // SQLite returns (id, parent, notused, detail); the others text
+        constexpr bool numbered = DialectOf<Config>::plan_format == PlanFormat::QueryPlanRows;
+        std::vector<std::string> text;
+        std::vector<PlanRow> rows;
+        while (query.next()) {
+            const QByteArray detail = query.value(numbered ? 3 : 0).toByteArray();
+            text.emplace_back(detail.constData(), static_cast<size_t>(detail.size()));
+            rows.push_back(PlanRow{numbered ? query.value(0).toLongLong() : 0,
+                                   numbered ? query.value(1).toLongLong() : 0, {}});
+        }
+        for (size_t i = 0; i < rows.size(); ++i) {
+            rows[i].detail = text[i];
+        }
+
+        auto plan = parsePlan<Config>(rows);
+        if constexpr(is_observed<Config>) {
+            ObserverOf<Config>::onPlan(PlanEvent{compiled.sql(), plan, mode});
+        }
+        return plan;
     }
 
-    template<typename T>
-    QueryBuilder& fullJoin(const T& table, std::string_view condition) {
-        static_assert((QueryType::Select == QueryType::Select), "JOIN can only be used with SELECT queries");
-        if (filters_.joins_count >= Config::MaxJoins) {
-            auto error = QueryError(QueryError::Code::TooManyJoins,
-                                    std::format("Too many joins: limit is {}", Config::MaxJoins));
-            last_error_ = error;
-            if constexpr(Config::ThrowOnError) {
-                throw error;
+    [[nodiscard]] Result<QueryPlan> explain(const QueryBuilder<Config>& builder, QueryCache<Config>* cache = nullptr,
+                                            ExplainMode mode = ExplainMode::Plan) {
+        std::vector<SqlValue<Config>> values;
+        builder.bindValues(values);
+
+        if (cache) {
+            auto entry = cache->get(builder);
+            if (entry.hasError()) {
+                return entry.error();
             }
-            return *this;
+            return explain(*entry.value(), values, mode);
         }
 
-        if constexpr (std::is_convertible_v<T, std::string_view>) {
-            filters_.joins[filters_.joins_count++] = Join<Config>{
-                Join<Config>::Type::Full,
-                static_cast<std::string_view>(table),
-                condition
-            };
-        } else if constexpr (std::is_same_v<std::remove_cvref_t<T>, AliasedTable<Config>>) {
-            filters_.joins[filters_.joins_count++] = Join<Config>{
-                Join<Config>::Type::Full,
-                table.toString(),
-                condition
-            };
-        } else {
-            static_assert(std::is_convertible_v<T, std::string_view> ||
-                              std::is_same_v<std::remove_cvref_t<T>, AliasedTable<Config>>,
-                          "Table type not supported for fullJoin");
+        auto compiled = builder.compileParameterizedResult();
+        if (compiled.hasError()) {
+            return compiled.error();
         }
-        return *this;
+        return explain(compiled.value(), values, mode);
     }
 
-    template<typename T>
-    QueryBuilder& fullJoin(const T& table, const Condition<Config>& condition) {
-        return fullJoin(table, condition.toString());
-    }
+    // With auditing on, each statement is explained with its first values
+    // when it is first prepared, so every query shape reaches onPlan() once
+    // per connection, e.g. to flag full table scans. Audit errors are
+    // ignored and do not affect the execution.
+    void auditPlans(bool enabled) { audit_plans_ = enabled; }
 
-    // Where variations
-    template<typename Col, typename T>
-    QueryBuilder& whereIn(const Col& column, std::span<const T> values) {
-        if (filters_.where_conditions_count >= Config::MaxConditions) {
-            auto error = QueryError(QueryError::Code::TooManyConditions,
-                                    std::format("Too many conditions: limit is {}", Config::MaxConditions));
-            last_error_ = error;
-            if constexpr(Config::ThrowOnError) {
-                throw error;
-            }
-            return *this;
-        }
+    [[nodiscard]] Stats stats() const { return Stats{hits_, misses_, lru_.size()}; }
 
-        if constexpr (std::is_convertible_v<Col, std::string_view>) {
-            auto condition = Condition<Config>::in(static_cast<std::string_view>(column), values);
-            filters_.where_conditions[filters_.where_conditions_count++] = std::move(condition);
-        } else {
-            static_assert(std::is_convertible_v<Col, std::string_view>,
-                          "Column type not supported for whereIn");
+    void clear() {
+        index_.clear();
+        lru_.clear();
+    }
+
+private:
+    static Key keyOf(const CompiledQuery<Config>& compiled) {
+        if (auto interned = compiled.interned()) {
+            return Key{interned->view(), interned->hash()};
         }
-        return *this;
+        return Key{compiled.sql(), detail::hashText(compiled.sql())};
     }
 
-    template<typename Col, typename T>
-    QueryBuilder& whereNotIn(const Col& column, std::span<const T> values) {
-        if (filters_.where_conditions_count >= Config::MaxConditions) {
-            auto error = QueryError(QueryError::Code::TooManyConditions,
-                                    std::format("Too many conditions: limit is {}", Config::MaxConditions));
-            last_error_ = error;
-            if constexpr(Config::ThrowOnError) {
-                throw error;
-            }
-            return *this;
+    [[nodiscard]] Result<QSqlQuery*> run(const CompiledQuery<Config>& compiled,
+                                         std::span<const SqlValue<Config>> values, bool forwardOnly) {
+        if (values.size() != compiled.slotCount()) {
+            return QueryError(QueryError::Code::InvalidOperation,
+                              "Bind value count does not match placeholder count");
         }
 
-        if constexpr (std::is_convertible_v<Col, std::string_view>) {
-            auto condition = Condition<Config>::notIn(static_cast<std::string_view>(column), values);
-            filters_.where_conditions[filters_.where_conditions_count++] = std::move(condition);
-        } else {
-            static_assert(std::is_convertible_v<Col, std::string_view>,
-                          "Column type not supported for whereNotIn");
+        if (audit_plans_ && !compiled.hasError() && !index_.contains(keyOf(compiled))) {
+            (void)explain(compiled, values);
         }
-        return *this;
-    }
 
-    template<typename Col, typename T, typename U>
-    QueryBuilder& whereBetween(const Col& column, T&& start, U&& end) {
-        if (filters_.where_conditions_count >= Config::MaxConditions) {
-            auto error = QueryError(QueryError::Code::TooManyConditions,
-                                    std::format("Too many conditions: limit is {}", Config::MaxConditions));
-            last_error_ = error;
-            if constexpr(Config::ThrowOnError) {
-                throw error;
-            }
-            return *this;
+        auto prepared = prepare(compiled);
+        if (prepared.hasError()) {
+            return prepared;
         }
 
-        if constexpr (std::is_convertible_v<Col, std::string_view>) {
-            using Op = typename ConditionBase<Config>::Op;
-            filters_.where_conditions[filters_.where_conditions_count++] = Condition<Config>(
-                static_cast<std::string_view>(column),
-                Op::Between,
-                SqlValue<Config>(std::forward<T>(start)),
-                SqlValue<Config>(std::forward<U>(end))
-                );
-        } else {
-            static_assert(std::is_convertible_v<Col, std::string_view>,
-                          "Column type not supported for whereBetween");
+        QSqlQuery* query = prepared.value();
+        if (query->isForwardOnly() != forwardOnly) {
+            // The mode of a prepared query only changes while it is inactive
+            query->finish();
+            query->setForwardOnly(forwardOnly);
         }
-        return *this;
+        for (size_t i = 0; i < values.size(); ++i) {
+            bind(*query, compiled.slots()[i], i, values[i].toVariant());
+        }
+        if (!query->exec()) {
+            return QueryError(QueryError::Code::DatabaseError, "Failed to execute statement");
+        }
+        return query;
     }
 
-    template<typename Col>
-    QueryBuilder& whereLike(const Col& column, std::string_view pattern) {
-        if (filters_.where_conditions_count >= Config::MaxConditions) {
-            auto error = QueryError(QueryError::Code::TooManyConditions,
-                                    std::format("Too many conditions: limit is {}", Config::MaxConditions));
-            last_error_ = error;
-            if constexpr(Config::ThrowOnError) {
-                throw error;
+    [[nodiscard]] Result<QSqlQuery*> run(const QueryBuilder<Config>& builder, QueryCache<Config>* cache,
+                                         bool forwardOnly) {
+        std::vector<SqlValue<Config>> values;
+        builder.bindValues(values);
+
+        if (cache) {
+            auto entry = cache->get(builder);
+            if (entry.hasError()) {
+                return entry.error();
             }
-            return *this;
+            return run(*entry.value(), values, forwardOnly);
         }
 
-        if constexpr (std::is_convertible_v<Col, std::string_view>) {
-            using Op = typename ConditionBase<Config>::Op;
-            filters_.where_conditions[filters_.where_conditions_count++] = Condition<Config>(
-                static_cast<std::string_view>(column),
-                Op::Like,
-                SqlValue<Config>(pattern)
-                );
-        } else {
-            static_assert(std::is_convertible_v<Col, std::string_view>,
-                          "Column type not supported for whereLike");
+        auto compiled = builder.compileParameterizedResult();
+        if (compiled.hasError()) {
+            return compiled.error();
         }
-        return *this;
+        return run(compiled.value(), values, forwardOnly);
     }
 
-    template<typename Col>
-    QueryBuilder& whereNull(const Col& column) {
-        if (filters_.where_conditions_count >= Config::MaxConditions) {
-            auto error = QueryError(QueryError::Code::TooManyConditions,
-                                    std::format("Too many conditions: limit is {}", Config::MaxConditions));
-            last_error_ = error;
-            if constexpr(Config::ThrowOnError) {
-                throw error;
-            }
-            return *this;
+    static void bind(QSqlQuery& query, const BindSlot& slot, size_t position, const QVariant& value) {
+        if (slot.style == PlaceholderStyle::Colon) {
+            query.bindValue(QString::fromUtf8(slot.name.data(), static_cast<int>(slot.name.size())), value);
+        } else {
+            query.bindValue(static_cast<int>(position), value);
         }
+    }
+};
 
-        if constexpr (std::is_convertible_v<Col, std::string_view>) {
-            filters_.where_conditions[filters_.where_conditions_count++] = Condition<Config>::isNull(
-                static_cast<std::string_view>(column)
-                );
+namespace detail {
+// One result cell into a field of type T. The conversion is chosen at
+// compile time per column, and strings are assigned into the existing
+// field so that its capacity is reused from row to row. NULL reads as T{}.
+template<typename T>
+void decodeCell(const QVariant& cell, T& out) {
+    if (cell.isNull()) {
+        out = T{};
+    } else if constexpr(std::is_same_v<T, bool>) {
+        out = cell.toBool();
+    } else if constexpr(std::is_integral_v<T> || std::is_enum_v<T>) {
+        out = static_cast<T>(cell.toLongLong());
+    } else if constexpr(std::is_floating_point_v<T>) {
+        out = static_cast<T>(cell.toDouble());
+    } else if constexpr(std::is_same_v<T, std::string>) {
+        const QByteArray utf8 = cell.toByteArray();
+        out.assign(utf8.constData(), static_cast<size_t>(utf8.size()));
+    } else if constexpr(std::is_same_v<T, QString>) {
+        out = cell.toString();
+    } else if constexpr(std::is_same_v<T, QDateTime>) {
+        out = cell.toDateTime();
+    } else {
+        static_assert(sizeof(T) == 0, "Column type has no result decoder");
+    }
+}
+
+template<typename... Ts, size_t... I>
+void decodeRow(const QSqlQuery& query, std::tuple<Ts...>& row, std::index_sequence<I...>) {
+    (decodeCell(query.value(static_cast<int>(I)), std::get<I>(row)), ...);
+}
+} // namespace detail
+
+// Rows of an executed query, read once and in order and decoded into typed
+// values: the column types Ts... of a TypedSelect, as a std::tuple or as a
+// Row built from them (an aggregate struct with fields in select order). The
+// stream reads the QSqlQuery it was given, which must stay alive and
+// unexecuted meanwhile.
+template<typename Row, typename... Ts>
+class RowStream {
+private:
+    using Values = std::tuple<Ts...>;
+    static constexpr bool IsTuple = std::is_same_v<Row, Values>;
+
+    QSqlQuery* query_;
+    Values values_;  // Decoding target when Row is not the tuple itself
+
+public:
+    explicit RowStream(QSqlQuery* query) : query_(query) {}
+
+    // The next row into `row`; false after the last row. Tuple rows are
+    // decoded in place, reusing their string capacity.
+    bool next(Row& row) {
+        if (!query_->next()) {
+            return false;
+        }
+        if constexpr(IsTuple) {
+            detail::decodeRow(*query_, row, std::index_sequence_for<Ts...>{});
         } else {
-            static_assert(std::is_convertible_v<Col, std::string_view>,
-                          "Column type not supported for whereNull");
+            detail::decodeRow(*query_, values_, std::index_sequence_for<Ts...>{});
+            row = std::make_from_tuple<Row>(std::move(values_));
         }
-        return *this;
+        return true;
     }
 
-    template<typename Col>
-    QueryBuilder& whereNotNull(const Col& column) {
-        if (filters_.where_conditions_count >= Config::MaxConditions) {
-            auto error = QueryError(QueryError::Code::TooManyConditions,
-                                    std::format("Too many conditions: limit is {}", Config::MaxConditions));
-            last_error_ = error;
-            if constexpr(Config::ThrowOnError) {
-                throw error;
+    // Single-pass iteration over the rows; the row is decoded into the same
+    // object at each step
+    class iterator {
+    private:
+        RowStream* stream_{nullptr};
+        Row row_{};
+
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = Row;
+        using difference_type = std::ptrdiff_t;
+
+        iterator() = default;
+        explicit iterator(RowStream* stream) : stream_(stream) { ++*this; }
+
+        const Row& operator*() const { return row_; }
+        const Row* operator->() const { return &row_; }
+
+        iterator& operator++() {
+            if (!stream_->next(row_)) {
+                stream_ = nullptr;
             }
             return *this;
         }
 
-        if constexpr (std::is_convertible_v<Col, std::string_view>) {
-            filters_.where_conditions[filters_.where_conditions_count++] = Condition<Config>::isNotNull(
-                static_cast<std::string_view>(column)
-                );
-        } else {
-            static_assert(std::is_convertible_v<Col, std::string_view>,
-                          "Column type not supported for whereNotNull");
-        }
-        return *this;
-    }
+        void operator++(int) { ++*this; }
 
-    QueryBuilder& whereExists(std::string_view subquery) {
-        if (filters_.where_conditions_count >= Config::MaxConditions) {
-            auto error = QueryError(QueryError::Code::TooManyConditions,
-                                    std::format("Too many conditions: limit is {}", Config::MaxConditions));
-            last_error_ = error;
-            if constexpr(Config::ThrowOnError) {
-                throw error;
+        bool operator==(std::default_sentinel_t) const { return stream_ == nullptr; }
+    };
+
+    [[nodiscard]] iterator begin() { return iterator(this); }
+    [[nodiscard]] std::default_sentinel_t end() const { return {}; }
+};
+
+// SELECT of typed columns whose results are fetched as typed rows. It is a
+// QueryBuilder, so FROM, WHERE, ORDER BY and so on are added as usual; keep
+// it in a variable, since those return the QueryBuilder:
+//
+//     TypedSelect listing(users.id, users.name);
+//     listing.from(users.table).where(users.active == true);
+//     auto rows = listing.fetch(statements);
+//     for (const auto& [id, name] : rows.value()) { ... }
+//
+// It is also built from a schema column list, TypedSelect(sql::Columns<...>{}),
+// whose indexOf<> and get<> then address the row fields. Before running, a
+// fetch checks that each column's table is the FROM table or a joined one.
+template<typename Config, typename... Ts>
+class TypedSelect : public QueryBuilder<Config> {
+public:
+    using Row = std::tuple<Ts...>;
+    using Columns = std::tuple<std::vector<Ts>...>;
+
+private:
+    std::array<std::string_view, sizeof...(Ts)> tables_;
+    std::array<std::string_view, sizeof...(Ts)> names_;
+
+    [[nodiscard]] std::optional<QueryError> checkTables() const {
+        for (size_t i = 0; i < tables_.size(); ++i) {
+            if (!this->hasTable(tables_[i])) {
+                return detail::unjoinedColumn(tables_[i], names_[i]);
             }
-            return *this;
         }
+        return std::nullopt;
+    }
 
-        std::string condition = "EXISTS (" + std::string(subquery) + ")";
-        filters_.where_conditions[filters_.where_conditions_count++] = Condition<Config>(condition);
-        return *this;
+public:
+    explicit TypedSelect(const TypedColumn<Ts, Config>&... columns)
+        : tables_{columns.tableName()...}, names_{columns.name()...} {
+        this->select(columns...);
     }
 
-    QueryBuilder& whereRaw(std::string_view rawCondition) {
-        if (filters_.where_conditions_count >= Config::MaxConditions) {
-            auto error = QueryError(QueryError::Code::TooManyConditions,
-                                    std::format("Too many conditions: limit is {}", Config::MaxConditions));
-            last_error_ = error;
-            if constexpr(Config::ThrowOnError) {
-                throw error;
-            }
-            return *this;
-        }
+    template<auto... Members>
+    explicit TypedSelect(sql::Columns<Members...>)
+        : TypedSelect(detail::SchemaMember<Members>::column...) {}
 
-        filters_.where_conditions[filters_.where_conditions_count++] = Condition<Config>(rawCondition);
-        return *this;
+    // Execute forward-only and stream the rows, as tuples or as `R`
+    template<typename R = Row>
+    [[nodiscard]] Result<RowStream<R, Ts...>> fetch(PreparedStatements<Config>& statements,
+                                                    QueryCache<Config>* cache = nullptr) const {
+        if (auto error = checkTables()) {
+            return *error;
+        }
+        auto query = statements.stream(*this, cache);
+        if (query.hasError()) {
+            return query.error();
+        }
+        return RowStream<R, Ts...>(query.value());
     }
 
-    template<typename Col>
-    QueryBuilder& groupBy(const Col& column) {
-        static_assert((QueryType::Select == QueryType::Select), "GROUP BY can only be used with SELECT queries");
-        if (ordering_.group_by_count >= Config::MaxGroupBy) {
-            auto error = QueryError(QueryError::Code::TooManyGroupBy,
-                                    std::format("Too many group by clauses: limit is {}", Config::MaxGroupBy));
-            last_error_ = error;
-            if constexpr(Config::ThrowOnError) {
-                throw error;
-            }
-            return *this;
+    // Execute and append every row to one vector per column, for columnar
+    // processing. Returns the number of rows read.
+    [[nodiscard]] Result<size_t> fetchColumns(PreparedStatements<Config>& statements, Columns& columns,
+                                              QueryCache<Config>* cache = nullptr,
+                                              size_t expectedRows = 0) const {
+        if (auto error = checkTables()) {
+            return *error;
+        }
+        auto query = statements.stream(*this, cache);
+        if (query.hasError()) {
+            return query.error();
+        }
+        if (expectedRows > 0) {
+            std::apply([expectedRows](auto&... column) {
+                (column.reserve(column.size() + expectedRows), ...);
+            }, columns);
         }
 
-        if constexpr (std::is_convertible_v<Col, std::string_view>) {
-            ordering_.group_by[ordering_.group_by_count++] = static_cast<std::string_view>(column);
-        } else {
-            static_assert(std::is_convertible_v<Col, std::string_view>,
-                          "Column type not supported for groupBy");
+        QSqlQuery& rows = *query.value();
+        size_t count = 0;
+        while (rows.next()) {
+            appendRow(rows, columns, std::index_sequence_for<Ts...>{});
+            ++count;
         }
-        return *this;
+        return count;
     }
 
-    QueryBuilder& having(std::string_view condition) {
-        static_assert((QueryType::Select == QueryType::Select), "HAVING can only be used with SELECT queries");
-        ordering_.having = condition;
-        return *this;
+private:
+    template<size_t... I>
+    static void appendRow(const QSqlQuery& rows, Columns& columns, std::index_sequence<I...>) {
+        (appendCell(rows.value(static_cast<int>(I)), std::get<I>(columns)), ...);
     }
 
-    // Build with error handling
-    [[nodiscard]] Result<std::string> buildResult() const {
-        if (core_.table.empty() && core_.type != QueryType::Select) {
-            QueryError error(QueryError::Code::EmptyTable, "Table name is required");
-            last_error_ = error;
-            return error;
+    template<typename T>
+    static void appendCell(const QVariant& cell, std::vector<T>& column) {
+        if constexpr(std::is_same_v<T, bool>) {
+            bool value = false;  // std::vector<bool> has no references to decode into
+            detail::decodeCell(cell, value);
+            column.push_back(value);
+        } else {
+            detail::decodeCell(cell, column.emplace_back());
         }
+    }
+};
 
-        try {
-            std::string query;
-            query.reserve(estimateSize());
+template<typename... Ts, typename Config>
+TypedSelect(const TypedColumn<Ts, Config>&...) -> TypedSelect<Config, Ts...>;
 
-            switch (core_.type) {
-            case QueryType::Select:
-                buildSelect(query);
-                break;
-            case QueryType::Insert:
-                buildInsert(query, false);
-                break;
-            case QueryType::InsertOrReplace:
-                buildInsert(query, true);
-                break;
-            case QueryType::Update:
-                buildUpdate(query);
-                break;
-            case QueryType::Delete:
-                buildDelete(query);
-                break;
-            case QueryType::Truncate:
-                buildTruncate(query);
-                break;
+template<auto... Members>
+TypedSelect(Columns<Members...>)
+    -> TypedSelect<typename Columns<Members...>::config_type, typename detail::SchemaMember<Members>::value_type...>;
+
+// Coroutine type for code that awaits a ConnectionPool. It is lazy: the body
+// starts when the task is awaited or passed to syncWait(), and when it
+// finishes it resumes its awaiter. Exceptions propagate to the awaiter.
+template<typename T = void>
+class Task;
+
+namespace detail {
+template<typename T>
+struct TaskResult {
+    std::optional<T> value;
+
+    template<typename U>
+    void return_value(U&& result) { value.emplace(std::forward<U>(result)); }
+    T take() { return std::move(*value); }
+};
+
+template<>
+struct TaskResult<void> {
+    void return_void() {}
+    void take() {}
+};
+} // namespace detail
+
+template<typename T>
+class Task {
+public:
+    struct promise_type;
+
+private:
+    using Handle = std::coroutine_handle<promise_type>;
+
+    struct FinalAwaiter {
+        bool await_ready() noexcept { return false; }
+        std::coroutine_handle<> await_suspend(Handle handle) noexcept {
+            auto& promise = handle.promise();
+            if (promise.done) {
+                // syncWait() may destroy the frame as soon as this is released
+                promise.done->release();
+                return std::noop_coroutine();
             }
+            return promise.continuation;
+        }
+        void await_resume() noexcept {}
+    };
 
-            return Result<std::string>(query);
-        } catch (const std::exception& e) {
-            QueryError error(QueryError::Code::InvalidCondition, e.what());
-            last_error_ = error;
-            return error;
+    Handle handle_;
+
+    explicit Task(Handle handle) : handle_(handle) {}
+
+    template<typename U>
+    friend U syncWait(Task<U> task);
+
+public:
+    struct promise_type : detail::TaskResult<T> {
+        std::coroutine_handle<> continuation{std::noop_coroutine()};
+        std::exception_ptr exception;
+        std::binary_semaphore* done{nullptr};  // Set by syncWait()
+
+        Task get_return_object() { return Task(Handle::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        FinalAwaiter final_suspend() noexcept { return {}; }
+        void unhandled_exception() { exception = std::current_exception(); }
+    };
+
+    Task(Task&& other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            if (handle_) handle_.destroy();
+            handle_ = std::exchange(other.handle_, {});
         }
+        return *this;
     }
 
-#ifdef SQLQUERYBUILDER_USE_QT
-    [[nodiscard]] QString build() const {
-        auto result = buildResult();
-        if (result.hasError()) {
-            if constexpr(Config::ThrowOnError) {
-                throw result.error();
-            }
-            return QString("/* ERROR: %1 */").arg(QString::fromUtf8(result.error().message.data(),
-                                                                    static_cast<int>(result.error().message.size())));
-        }
-        return QString::fromStdString(result.value());
+    ~Task() {
+        if (handle_) handle_.destroy();
     }
-#else
-    [[nodiscard]] std::string build() const {
-        auto result = buildResult();
-        if (result.hasError()) {
-            if constexpr(Config::ThrowOnError) {
-                throw result.error();
-            }
-            return "/* ERROR: " + std::string(result.error().message) + " */";
+
+    bool await_ready() const noexcept { return !handle_ || handle_.done(); }
+
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiter) noexcept {
+        handle_.promise().continuation = awaiter;
+        return handle_;
+    }
+
+    T await_resume() {
+        auto& promise = handle_.promise();
+        if (promise.exception) {
+            std::rethrow_exception(promise.exception);
         }
-        return result.value();
+        return promise.take();
     }
-#endif
+};
+
+// Run a task to completion, blocking the calling thread. Not for use on a
+// pool thread, whose connection would be idle meanwhile.
+template<typename T>
+T syncWait(Task<T> task) {
+    std::binary_semaphore done(0);
+    task.handle_.promise().done = &done;
+    task.handle_.resume();
+    done.acquire();
+    return task.await_resume();
+}
+
+// Rows and counters of a statement run on a pooled connection. Rows are read
+// on the connection's thread, so nothing here refers back to the connection.
+struct PooledResult {
+    std::vector<QVariantList> rows;
+    int rows_affected{-1};
+    QVariant last_insert_id;
+};
+
+// A fixed set of connections, each a clone of one QSqlDatabase opened and
+// used by its own thread, since Qt connections are thread-affine. Statements
+// are awaited from coroutines and queued to whichever connection is free:
+//
+//     Task<> report(ConnectionPool<>& pool, QueryCache<>& cache) {
+//         auto rows = co_await pool.execute(QueryBuilder().select("id").from("users"), &cache);
+//         ...
+//     }
+//
+// At most one statement runs per connection. The queue is intrusive: each
+// pending statement lives in the frame of the coroutine awaiting it, so
+// queueing allocates nothing and the queue is never longer than the number
+// of suspended callers. executeAll() pipelines independent statements,
+// keeping no more than a window of them queued at once.
+//
+// Awaiting coroutines resume on the pool thread that ran their statement;
+// hand heavy or blocking work off rather than doing it there. Destroy the
+// pool only once its coroutines are done; statements already queued are
+// still run.
+template<typename Config = DefaultConfig>
+class ConnectionPool {
+public:
+    // An independent statement for executeAll(). Both must outlive the await.
+    struct Statement {
+        const CompiledQuery<Config>* query;
+        std::span<const SqlValue<Config>> values;
+    };
+
+    struct Stats {
+        size_t executed{0};    // Statements run successfully
+        size_t failed{0};
+        size_t queued{0};      // Waiting for a connection right now
+        size_t peak_queued{0};
+    };
 
 private:
-    void buildSelect(std::string& query) const {
-        query += keywords::SELECT;
-        query += " ";
+    // A statement waiting for or running on a connection
+    struct Operation {
+        Operation* next{nullptr};
+        const CompiledQuery<Config>* query{nullptr};
+        std::span<const SqlValue<Config>> values;
+        Result<PooledResult> result{PooledResult{}};
+
+        // Called on the pool thread once `result` is set; the operation may
+        // be destroyed before this returns
+        virtual void complete() noexcept = 0;
+
+    protected:
+        ~Operation() = default;
+    };
 
-        if (core_.distinct) {
-            query += keywords::DISTINCT;
-            query += " ";
+public:
+    // Awaitable for one statement; co_await yields Result<PooledResult>
+    class ExecuteAwaitable : private Operation {
+    private:
+        friend class ConnectionPool;
+
+        ConnectionPool* pool_;
+        std::coroutine_handle<> awaiter_;
+        std::shared_ptr<const CompiledQuery<Config>> compiled_;  // When built from a builder
+        std::vector<SqlValue<Config>> bound_;
+
+        ExecuteAwaitable(ConnectionPool& pool, const CompiledQuery<Config>& compiled,
+                         std::span<const SqlValue<Config>> values) : pool_(&pool) {
+            this->query = &compiled;
+            this->values = values;
         }
 
-        if (columns_.select_columns_count == 0) {
-            query += keywords::ALL;
-        } else {
-            bool first = true;
-            for (size_t i = 0; i < columns_.select_columns_count; ++i) {
-                if (!first) query += ", ";
-                columns_.select_columns[i].toSql(query);
-                first = false;
+        ExecuteAwaitable(ConnectionPool& pool, const QueryBuilder<Config>& builder, QueryCache<Config>* cache)
+            : pool_(&pool) {
+            builder.bindValues(bound_);
+            if (cache) {
+                auto entry = cache->get(builder);
+                if (entry.hasError()) {
+                    fail(entry.error());
+                    return;
+                }
+                compiled_ = std::move(entry).value();
+            } else {
+                auto compiled = builder.compileParameterizedResult();
+                if (compiled.hasError()) {
+                    fail(compiled.error());
+                    return;
+                }
+                compiled_ = std::make_shared<const CompiledQuery<Config>>(std::move(compiled).value());
             }
+            this->query = compiled_.get();
+            this->values = bound_;
         }
 
-        query += " ";
-        query += keywords::FROM;
-        query += " ";
-        query += core_.table;
+        // Compile errors complete the await without suspending
+        void fail(const QueryError& error) {
+            this->result = error;
+            pool_ = nullptr;
+        }
 
-        // Joins
-        for (size_t i = 0; i < filters_.joins_count; ++i) {
-            query += " ";
-            filters_.joins[i].toString(query);
+        void complete() noexcept override { awaiter_.resume(); }
+
+    public:
+        ExecuteAwaitable(const ExecuteAwaitable&) = delete;
+        ExecuteAwaitable& operator=(const ExecuteAwaitable&) = delete;
+
+        bool await_ready() const noexcept { return pool_ == nullptr; }
+
+        void await_suspend(std::coroutine_handle<> awaiter) {
+            awaiter_ = awaiter;
+            pool_->push(*this);
         }
 
-        // Where
-        if (filters_.where_conditions_count > 0) {
-            query += " ";
-            query += keywords::WHERE;
-            query += " ";
-            bool first = true;
-            for (size_t i = 0; i < filters_.where_conditions_count; ++i) {
-                if (!first) {
-                    query += " ";
-                    query += keywords::AND;
-                    query += " ";
-                }
-                filters_.where_conditions[i].toString(query);
-                first = false;
+        Result<PooledResult> await_resume() { return std::move(this->result); }
+    };
+
+    // Awaitable for a batch of statements; co_await yields one result per
+    // statement, in order
+    class PipelineAwaitable {
+    private:
+        friend class ConnectionPool;
+
+        struct Step : Operation {
+            PipelineAwaitable* pipeline{nullptr};
+            void complete() noexcept override { pipeline->finished(); }
+        };
+
+        ConnectionPool* pool_;
+        std::vector<Step> steps_;
+        size_t window_;
+        std::atomic<size_t> next_{0};     // First step not yet queued
+        std::atomic<size_t> pending_{0};  // Steps not yet finished
+        std::coroutine_handle<> awaiter_;
+
+        PipelineAwaitable(ConnectionPool& pool, std::span<const Statement> statements, size_t window)
+            : pool_(&pool), steps_(statements.size()), window_(window) {
+            for (size_t i = 0; i < statements.size(); ++i) {
+                steps_[i].query = statements[i].query;
+                steps_[i].values = statements[i].values;
+                steps_[i].pipeline = this;
             }
         }
 
-        // Group By
-        if (ordering_.group_by_count > 0) {
-            query += " ";
-            query += keywords::GROUP_BY;
-            query += " ";
-            bool first = true;
-            for (size_t i = 0; i < ordering_.group_by_count; ++i) {
-                if (!first) query += ", ";
-                query += ordering_.group_by[i];
-                first = false;
+        // Queue the next step in place of the finished one, and resume the
+        // awaiter after the last
+        void finished() noexcept {
+            const size_t index = next_.fetch_add(1, std::memory_order_relaxed);
+            if (index < steps_.size()) {
+                pool_->push(steps_[index]);
             }
-
-            if (!ordering_.having.empty()) {
-                query += " ";
-                query += keywords::HAVING;
-                query += " ";
-                query += ordering_.having;
+            if (pending_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                awaiter_.resume();
             }
         }
 
-        // Order By
-        if (ordering_.order_by_count > 0) {
-            query += " ";
-            query += keywords::ORDER_BY;
-            query += " ";
-            bool first = true;
-            for (size_t i = 0; i < ordering_.order_by_count; ++i) {
-                if (!first) query += ", ";
-                query += ordering_.order_by[i].first;
-                query += " ";
-                query += (ordering_.order_by[i].second ? keywords::ASC : keywords::DESC);
-                first = false;
+    public:
+        PipelineAwaitable(const PipelineAwaitable&) = delete;
+        PipelineAwaitable& operator=(const PipelineAwaitable&) = delete;
+
+        bool await_ready() const noexcept { return steps_.empty(); }
+
+        bool await_suspend(std::coroutine_handle<> awaiter) {
+            awaiter_ = awaiter;
+            const size_t first = std::min(window_, steps_.size());
+            next_.store(first, std::memory_order_relaxed);
+            // One extra count keeps the steps from resuming the awaiter
+            // while the first window is still being queued
+            pending_.store(steps_.size() + 1, std::memory_order_relaxed);
+            for (size_t i = 0; i < first; ++i) {
+                pool_->push(steps_[i]);
             }
+            return pending_.fetch_sub(1, std::memory_order_acq_rel) != 1;
         }
 
-        if (ordering_.limit >= 0) {
-            query += " ";
-            query += keywords::LIMIT;
-            query += " ";
-            query += std::to_string(ordering_.limit);
+        std::vector<Result<PooledResult>> await_resume() {
+            std::vector<Result<PooledResult>> results;
+            results.reserve(steps_.size());
+            for (auto& step : steps_) {
+                results.push_back(std::move(step.result));
+            }
+            return results;
         }
+    };
 
-        if (ordering_.offset >= 0) {
-            query += " ";
-            query += keywords::OFFSET;
-            query += " ";
-            query += std::to_string(ordering_.offset);
+private:
+    mutable std::mutex mutex_;
+    std::condition_variable ready_;
+    Operation* head_{nullptr};
+    Operation* tail_{nullptr};
+    size_t queued_{0};
+    size_t peak_queued_{0};
+    bool stop_{false};
+    std::atomic<size_t> executed_{0};
+    std::atomic<size_t> failed_{0};
+    std::vector<std::thread> workers_;
+
+public:
+    // `connections` clones of the named connection, each with a
+    // PreparedStatements store of up to `maxStatements`
+    ConnectionPool(const QString& connectionName, size_t connections, size_t maxStatements = 64) {
+        static std::atomic<uint64_t> pools{0};
+        const uint64_t pool = pools.fetch_add(1, std::memory_order_relaxed);
+        connections = std::max<size_t>(connections, 1);
+
+        workers_.reserve(connections);
+        for (size_t i = 0; i < connections; ++i) {
+            QString name = QString::fromStdString(std::format("sqlquerybuilder_pool_{}_{}", pool, i));
+            workers_.emplace_back([this, connectionName, name = std::move(name), maxStatements] {
+                work(connectionName, name, maxStatements);
+            });
         }
     }
 
-    void buildInsert(std::string& query, bool orReplace) const {
-        if (columns_.values_count == 0) {
-            throw QueryError(QueryError::Code::InvalidCondition, "No values specified for INSERT");
-        }
+    ConnectionPool(const QSqlDatabase& database, size_t connections, size_t maxStatements = 64)
+        : ConnectionPool(database.connectionName(), connections, maxStatements) {}
 
-        query += keywords::INSERT;
+    ConnectionPool(const ConnectionPool&) = delete;
+    ConnectionPool& operator=(const ConnectionPool&) = delete;
 
-        if (orReplace) {
-            query += " OR REPLACE";
+    ~ConnectionPool() {
+        {
+            std::lock_guard lock(mutex_);
+            stop_ = true;
         }
-
-        query += " ";
-        query += keywords::INTO;
-        query += " ";
-        query += core_.table;
-        query += " (";
-
-        bool first = true;
-        for (size_t i = 0; i < columns_.values_count; ++i) {
-            if (!first) query += ", ";
-            query += columns_.values[i].first;
-            first = false;
+        ready_.notify_all();
+        for (auto& worker : workers_) {
+            worker.join();
         }
+    }
 
-        query += ") ";
-        query += keywords::VALUES;
-        query += " (";
+    // Run a compiled statement with one value per slot. The statement and
+    // values must outlive the await.
+    [[nodiscard]] ExecuteAwaitable execute(const CompiledQuery<Config>& compiled,
+                                           std::span<const SqlValue<Config>> values) {
+        return ExecuteAwaitable(*this, compiled, values);
+    }
 
-        first = true;
-        for (size_t i = 0; i < columns_.values_count; ++i) {
-            if (!first) query += ", ";
-            query += columns_.values[i].second.toSqlString();
-            first = false;
-        }
+    // Run the builder with its literals bound as parameters. It is compiled
+    // on the calling thread, through the cache if one is given.
+    [[nodiscard]] ExecuteAwaitable execute(const QueryBuilder<Config>& builder,
+                                           QueryCache<Config>* cache = nullptr) {
+        return ExecuteAwaitable(*this, builder, cache);
+    }
 
-        query += ")";
+    // Run independent statements concurrently, at most `maxInFlight` of them
+    // queued or running at a time (0 for one per connection)
+    [[nodiscard]] PipelineAwaitable executeAll(std::span<const Statement> statements, size_t maxInFlight = 0) {
+        return PipelineAwaitable(*this, statements, maxInFlight > 0 ? maxInFlight : workers_.size());
     }
 
-    void buildUpdate(std::string& query) const {
-        if (columns_.values_count == 0) {
-            throw QueryError(QueryError::Code::InvalidCondition, "No values specified for UPDATE");
-        }
+    [[nodiscard]] size_t connections() const { return workers_.size(); }
 
-        query += keywords::UPDATE;
-        query += " ";
-        query += core_.table;
-        query += " ";
-        query += keywords::SET;
-        query += " ";
+    [[nodiscard]] Stats stats() const {
+        std::lock_guard lock(mutex_);
+        return Stats{executed_.load(std::memory_order_relaxed), failed_.load(std::memory_order_relaxed),
+                     queued_, peak_queued_};
+    }
 
-        bool first = true;
-        for (size_t i = 0; i < columns_.values_count; ++i) {
-            if (!first) query += ", ";
-            query += columns_.values[i].first;
-            query += " = ";
-            query += columns_.values[i].second.toSqlString();
-            first = false;
+private:
+    void push(Operation& operation) {
+        {
+            std::lock_guard lock(mutex_);
+            operation.next = nullptr;
+            if (tail_) {
+                tail_->next = &operation;
+            } else {
+                head_ = &operation;
+            }
+            tail_ = &operation;
+            peak_queued_ = std::max(peak_queued_, ++queued_);
         }
+        ready_.notify_one();
+    }
 
-        if (filters_.where_conditions_count > 0) {
-            query += " ";
-            query += keywords::WHERE;
-            query += " ";
-            first = true;
-            for (size_t i = 0; i < filters_.where_conditions_count; ++i) {
-                if (!first) {
-                    query += " ";
-                    query += keywords::AND;
-                    query += " ";
-                }
-                filters_.where_conditions[i].toString(query);
-                first = false;
+    // Next queued operation, or nullptr once stopped and drained
+    Operation* pop() {
+        std::unique_lock lock(mutex_);
+        ready_.wait(lock, [this] { return head_ != nullptr || stop_; });
+        Operation* operation = head_;
+        if (operation) {
+            head_ = operation->next;
+            if (!head_) {
+                tail_ = nullptr;
             }
+            --queued_;
         }
+        return operation;
     }
 
-    void buildDelete(std::string& query) const {
-        query += keywords::DELETE;
-        query += " ";
-        query += keywords::FROM;
-        query += " ";
-        query += core_.table;
-
-        if (filters_.where_conditions_count > 0) {
-            query += " ";
-            query += keywords::WHERE;
-            query += " ";
-            bool first = true;
-            for (size_t i = 0; i < filters_.where_conditions_count; ++i) {
-                if (!first) {
-                    query += " ";
-                    query += keywords::AND;
-                    query += " ";
+    void work(const QString& source, const QString& name, size_t maxStatements) {
+        {
+            QSqlDatabase database = QSqlDatabase::cloneDatabase(source, name);
+            const bool open = database.open();
+            PreparedStatements<Config> statements(database, maxStatements);
+
+            while (Operation* operation = pop()) {
+                if (open) {
+                    run(statements, *operation);
+                } else {
+                    operation->result = QueryError(QueryError::Code::DatabaseError,
+                                                   "Failed to open pooled connection");
                 }
-                filters_.where_conditions[i].toString(query);
-                first = false;
+                (operation->result.hasError() ? failed_ : executed_).fetch_add(1, std::memory_order_relaxed);
+                operation->complete();
             }
         }
+        // Only once every QSqlDatabase and QSqlQuery of the clone is gone
+        QSqlDatabase::removeDatabase(name);
     }
 
-    void buildTruncate(std::string& query) const {
-        query += keywords::TRUNCATE;
-        query += " ";
-        query += core_.table;
+    static void run(PreparedStatements<Config>& statements, Operation& operation) {
+        auto executed = statements.stream(*operation.query, operation.values);
+        if (executed.hasError()) {
+            operation.result = executed.error();
+            return;
+        }
+
+        QSqlQuery& query = *executed.value();
+        PooledResult result;
+        const int columns = query.record().count();
+        while (query.next()) {
+            QVariantList& row = result.rows.emplace_back();
+            row.reserve(columns);
+            for (int i = 0; i < columns; ++i) {
+                row.push_back(query.value(i));
+            }
+        }
+        result.rows_affected = query.numRowsAffected();
+        result.last_insert_id = query.lastInsertId();
+        query.finish();  // Release the result set; the statement stays prepared
+        operation.result = std::move(result);
     }
 };
+#endif
 
 //=====================
 // SQL Aggregate Functions
@@ -2604,15 +9397,30 @@ inline Condition<Config> raw(std::string_view condition) {
     return Condition<Config>(condition);
 }
 
-// Macros for easy table definition
+// Macros for easy table definition. Besides the typed members, they register
+// each column with the table for sql::Schema, numbering the columns with
+// __COUNTER__, so no other use of __COUNTER__ may sit between them.
 #define SQL_DEFINE_TABLE(name) \
 struct name##_table { \
+        using sql_table_type = name##_table; \
+        static constexpr std::string_view sql_table_name = #name; \
+        static constexpr size_t sql_first_column = __COUNTER__ + 1; \
         const sql::Table<> table = sql::table(#name);
 
 #define SQL_DEFINE_COLUMN(name, type) \
-    const sql::TypedColumn<type> name = sql::column<type>(table, #name);
+    const sql::TypedColumn<type> name = sql::column<type>(table, #name); \
+    static constexpr auto sql_column(sql::detail::SchemaSlot<__COUNTER__ - sql_first_column>) { \
+        return &sql_table_type::name; \
+    }
 
-#define SQL_END_TABLE() };
+#define SQL_END_TABLE() \
+        static constexpr size_t sql_column_count = __COUNTER__ - sql_first_column; \
+    };
 
 } // namespace v1
 } // namespace sql
+
+namespace std {
+template<>
+struct hash<sql::InternedSql> : sql::InternedSql::Hash {};
+} // namespace std
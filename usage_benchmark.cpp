@@ -3,6 +3,10 @@
 #include <array>
 #include <string>
 #include <memory>
+#include <memory_resource>
+#include <optional>
+#include <unordered_map>
+#include <vector>
 
 // Define our custom configuration with larger limits for stress testing
 struct LargeConfig {
@@ -152,15 +156,15 @@ struct users_table_tiny : public users_table {
 };
 
 // Global table instances for benchmarks
-const users_table users;
+constexpr users_table users;
 const users_table_small users_small;
 const users_table_large users_large;
 const users_table_tiny users_tiny;
-const orders_table orders;
-const order_items_table order_items;
-const products_table products;
-const categories_table categories;
-const reviews_table reviews;
+constexpr orders_table orders;
+constexpr order_items_table order_items;
+constexpr products_table products;
+constexpr categories_table categories;
+constexpr reviews_table reviews;
 
 // Create a list of standard conditions for reuse
 std::string getActiveCond() { return (users.active == true).toString(); }
@@ -230,6 +234,28 @@ static void BM_ManyConditions(benchmark::State& state) {
 }
 BENCHMARK(BM_ManyConditions);
 
+// Copy of a filtered builder, then its build: both walk the condition
+// slots, so they follow the condition size, reported as "bytes"
+static void BM_CopyFilteredBuilder(benchmark::State& state) {
+    std::array<int64_t, 5> ids = {1, 2, 3, 4, 5};
+    sql::QueryBuilder<> builder;
+    builder.select(users.id, users.username)
+        .from(users.table)
+        .where(users.active == true)
+        .where(users.city == "New York")
+        .where(users.created_at >= "2023-01-01")
+        .whereIn(users.id, std::span<const int64_t>(ids))
+        .whereNotNull(users.email);
+
+    for (auto _ : state) {
+        auto copy = builder;
+        auto query = copy.build();
+        benchmark::DoNotOptimize(query);
+    }
+    state.counters["bytes"] = static_cast<double>(sizeof(sql::Condition<>));
+}
+BENCHMARK(BM_CopyFilteredBuilder);
+
 // Benchmark for INSERT with many values
 static void BM_Insert(benchmark::State& state) {
     for (auto _ : state) {
@@ -275,6 +301,99 @@ static void BM_InsertOrReplace(benchmark::State& state) {
 }
 BENCHMARK(BM_InsertOrReplace);
 
+// Bulk load: 1000 rows as single-row INSERTs vs. batched multi-row INSERTs
+static void BM_InsertRowByRow(benchmark::State& state) {
+    for (auto _ : state) {
+        for (int64_t i = 0; i < 1000; ++i) {
+            auto query = sql::QueryBuilder<>()
+            .insert(orders.table)
+                .value(orders.user_id, i)
+                .value(orders.order_number, "ORD-0001")
+                .value(orders.total_amount, 99.5)
+                .build();
+
+            benchmark::DoNotOptimize(query);
+        }
+    }
+}
+BENCHMARK(BM_InsertRowByRow);
+
+static void BM_InsertBatch(benchmark::State& state) {
+    auto batch = sql::QueryBuilder<>::insertBatch(orders.table,
+                                                 {orders.user_id, orders.order_number, orders.total_amount});
+
+    for (auto _ : state) {
+        int64_t i = 0;
+        auto statements = batch.write(
+            [&i](auto& row) {
+                if (i == 1000) return false;
+                row.value(i++).value("ORD-0001").value(99.5);
+                return true;
+            },
+            [](std::string_view statement) { benchmark::DoNotOptimize(statement.data()); });
+
+        benchmark::DoNotOptimize(statements);
+    }
+}
+BENCHMARK(BM_InsertBatch);
+
+// 1000 rows updated one UPDATE per row, for comparison with BM_UpdateBatch
+static void BM_UpdateRowByRow(benchmark::State& state) {
+    for (auto _ : state) {
+        for (int64_t i = 0; i < 1000; ++i) {
+            auto query = sql::QueryBuilder<>()
+                .update(orders.table)
+                .set(orders.order_date, "2024-01-02")
+                .set(orders.total_amount, 99.5)
+                .where(orders.id == i)
+                .build();
+
+            benchmark::DoNotOptimize(query);
+        }
+    }
+}
+BENCHMARK(BM_UpdateRowByRow);
+
+// The same 1000 rows as set-based updates: Arg 0 joins a VALUES list, Arg 1 renders CASE
+static void BM_UpdateBatch(benchmark::State& state) {
+    auto batch = sql::QueryBuilder<>::updateBatch(orders.table, {orders.id}, {orders.order_date, orders.total_amount});
+    batch.useCase(state.range(0) == 1);
+
+    for (auto _ : state) {
+        int64_t i = 0;
+        auto statements = batch.write(
+            [&i](auto& row) {
+                if (i == 1000) return false;
+                row.value(i++).value("2024-01-02").value(99.5);
+                return true;
+            },
+            [](std::string_view statement) { benchmark::DoNotOptimize(statement.data()); });
+
+        benchmark::DoNotOptimize(statements);
+    }
+}
+BENCHMARK(BM_UpdateBatch)->Arg(0)->Arg(1);
+
+// Multi-row upsert of 1000 rows
+static void BM_UpsertBatch(benchmark::State& state) {
+    auto batch = sql::QueryBuilder<>::insertBatch(orders.table, {orders.id, orders.order_date, orders.total_amount});
+    batch.onConflict({orders.id}).doUpdate({orders.order_date, orders.total_amount});
+
+    for (auto _ : state) {
+        int64_t i = 0;
+        auto statements = batch.write(
+            [&i](auto& row) {
+                if (i == 1000) return false;
+                row.value(i++).value("2024-01-02").value(99.5);
+                return true;
+            },
+            [](std::string_view statement) { benchmark::DoNotOptimize(statement.data()); });
+
+        benchmark::DoNotOptimize(statements);
+    }
+}
+BENCHMARK(BM_UpsertBatch);
+
 // Benchmark for UPDATE
 static void BM_Update(benchmark::State& state) {
     for (auto _ : state) {
@@ -330,6 +449,122 @@ static void BM_QueryReuse(benchmark::State& state) {
 }
 BENCHMARK(BM_QueryReuse);
 
+// One builder paged through with offset() and a changing lower bound on
+// created_at; Arg 1 keeps the rendered clauses so only the changed ones
+// are rendered again
+static void BM_PaginatedReuse(benchmark::State& state) {
+    sql::QueryBuilder<> builder;
+    builder.cacheClauses(state.range(0) != 0)
+        .select(users.id, users.username, users.email, orders.total_amount, orders.order_date)
+        .from(users.table)
+        .innerJoin(orders.table, users.id == orders.user_id)
+        .where(users.active == true)
+        .where(users.created_at >= "2024-01-01")
+        .orderBy(users.username)
+        .limit(50);
+
+    std::string query;
+    int32_t page = 0;
+    for (auto _ : state) {
+        builder.offset(page * 50);
+        if (page % 8 == 0) {
+            builder.replaceWhere(1, users.created_at >= (page % 16 == 0 ? "2024-01-01" : "2024-06-01"));
+        }
+        ++page;
+
+        query.clear();
+        auto result = builder.buildInto(query);
+        benchmark::DoNotOptimize(result);
+        benchmark::DoNotOptimize(query.data());
+    }
+}
+BENCHMARK(BM_PaginatedReuse)->Arg(0)->Arg(1);
+
+// The same listing paged with seekAfter() instead of offset(): the database
+// seeks to the page through the (created_at, id) index. Arg 0 passes the
+// last row's values; Arg 1 decodes them from a cursor, as a request handler
+// would, and encodes the cursor for the next page
+static void BM_KeysetPagination(benchmark::State& state) {
+    sql::QueryBuilder<> builder;
+    builder.cacheClauses()
+        .select(users.id, users.username, users.email)
+        .from(users.table)
+        .where(users.active == true)
+        .orderBy(users.created_at)
+        .orderBy(users.id);
+
+    std::array lastRow{sql::SqlValue<>("2024-03-01 12:00:00"), sql::SqlValue<>(int64_t{1042})};
+    std::string cursor = builder.nextCursor(lastRow).value();
+    std::string query;
+    for (auto _ : state) {
+        if (state.range(0) == 0) {
+            builder.seekAfter(lastRow, 50);
+        } else {
+            builder.seekAfter(cursor, 50);
+            auto next = builder.nextCursor(lastRow);
+            benchmark::DoNotOptimize(next);
+        }
+
+        query.clear();
+        auto result = builder.buildInto(query);
+        benchmark::DoNotOptimize(result);
+        benchmark::DoNotOptimize(query.data());
+    }
+}
+BENCHMARK(BM_KeysetPagination)->Arg(0)->Arg(1);
+
+// Reused builder with aliased tables and a join condition: the derived clause
+// text goes into the builder's arena, which is rewound by reset()
+static void BM_AliasedJoinReuse(benchmark::State& state) {
+    sql::QueryBuilder<> builder;
+
+    for (auto _ : state) {
+        builder.reset();
+        auto result = builder
+                          .select(users.id, users.username, orders.total_amount)
+                          .from(users.table.as("u"))
+                          .innerJoin(orders.table.as("o"), users.id == orders.user_id)
+                          .whereExists("SELECT 1 FROM order_items WHERE order_items.order_id = orders.id")
+                          .measure();
+
+        benchmark::DoNotOptimize(result);
+    }
+}
+BENCHMARK(BM_AliasedJoinReuse);
+
+// Three levels of IN subqueries. Arg 0 builds each level to a string and
+// splices it into the next as raw SQL; Arg 1 nests the builders, so the
+// whole report renders into one buffer
+static void BM_NestedSubqueries(benchmark::State& state) {
+    const bool nested = state.range(0) != 0;
+    sql::QueryBuilder<> products_in_category, ordered_items, buyers, report;
+
+    for (auto _ : state) {
+        products_in_category.reset().select(products.id).from(products.table).where(products.category_id == 7);
+        ordered_items.reset().select(order_items.order_id).from(order_items.table).where(order_items.quantity > 1);
+        buyers.reset().select(orders.user_id).from(orders.table).where(orders.status == OrderStatus::Shipped);
+        report.reset().select(users.id, users.username, users.email).from(users.table).where(users.active == true);
+
+        std::string levels[3];
+        if (nested) {
+            ordered_items.whereIn(order_items.product_id, std::cref(products_in_category));
+            buyers.whereIn(orders.id, std::cref(ordered_items));
+            report.whereIn(users.id, std::cref(buyers));
+        } else {
+            levels[0] = "product_id IN (" + products_in_category.build() + ")";
+            ordered_items.whereRaw(levels[0]);
+            levels[1] = "id IN (" + ordered_items.build() + ")";
+            buyers.whereRaw(levels[1]);
+            levels[2] = "id IN (" + buyers.build() + ")";
+            report.whereRaw(levels[2]);
+        }
+
+        auto query = report.build();
+        benchmark::DoNotOptimize(query);
+    }
+}
+BENCHMARK(BM_NestedSubqueries)->Arg(0)->Arg(1);
+
 // Benchmark with different config sizes
 static void BM_TinyConfig(benchmark::State& state) {
     for (auto _ : state) {
@@ -398,6 +633,52 @@ static void BM_LargeConfig(benchmark::State& state) {
 }
 BENCHMARK(BM_LargeConfig);
 
+// Inline small-vector storage: same query as BM_DefaultConfig
+static void BM_CompactConfig(benchmark::State& state) {
+    for (auto _ : state) {
+        auto query = sql::QueryBuilder<sql::CompactConfig>()
+        .select(users.id, users.username, users.email, users.created_at, users.updated_at)
+            .from(users.table)
+            .where(users.active == true)
+            .where(users.verified == true)
+            .where(users.created_at >= "2023-01-01")
+            .orderBy(users.username)
+            .orderBy(users.created_at, false)
+            .build();
+
+        benchmark::DoNotOptimize(query);
+    }
+}
+BENCHMARK(BM_CompactConfig);
+
+// Past the inline capacity and past DefaultConfig's limits
+static void BM_CompactConfigReportQuery(benchmark::State& state) {
+    std::array<int64_t, 64> ids{};
+    for (size_t i = 0; i < ids.size(); ++i) {
+        ids[i] = static_cast<int64_t>(i + 1);
+    }
+
+    for (auto _ : state) {
+        auto query = sql::QueryBuilder<sql::CompactConfig>()
+        .select(users.id, users.username, users.email, users.first_name, users.last_name,
+                users.phone, users.address, users.city, users.state, users.country)
+            .from(users.table)
+            .where(users.active == true)
+            .where(users.verified == true)
+            .where(users.created_at >= "2023-01-01")
+            .where(users.city == "New York")
+            .where(users.state == "NY")
+            .where(users.country == "USA")
+            .whereIn(users.id, std::span<const int64_t>(ids))
+            .orderBy(users.username)
+            .orderBy(users.created_at, false)
+            .build();
+
+        benchmark::DoNotOptimize(query);
+    }
+}
+BENCHMARK(BM_CompactConfigReportQuery);
+
 // Stack vs. Heap Allocation
 static void BM_StackAllocated(benchmark::State& state) {
     sql::QueryBuilder<SmallConfig> builder;
@@ -625,6 +906,142 @@ static void BM_WhereIn(benchmark::State& state) {
 }
 BENCHMARK(BM_WhereIn);
 
+// Large ID filters: literal list vs. per-value bind slots vs. one JSON
+// array parameter. "bytes" is the statement text the database has to parse.
+static std::vector<int64_t> makeIdList() {
+    std::vector<int64_t> ids(2000);
+    for (size_t i = 0; i < ids.size(); ++i) {
+        ids[i] = 1000000 + static_cast<int64_t>(i);
+    }
+    return ids;
+}
+
+static void whereInLargeList(benchmark::State& state, std::optional<sql::InStrategy> strategy) {
+    const auto ids = makeIdList();
+    const std::span<const int64_t> idsSpan(ids);
+    size_t bytes = 0;
+
+    for (auto _ : state) {
+        sql::QueryBuilder<> builder;
+        builder.select(users.id, users.username).from(users.table);
+        if (strategy) {
+            builder.whereIn(users.id, idsSpan, *strategy);
+        } else {
+            builder.whereIn(users.id, idsSpan);
+        }
+        auto query = builder.build();
+        bytes = query.size();
+        benchmark::DoNotOptimize(query);
+    }
+    state.counters["bytes"] = static_cast<double>(bytes);
+}
+
+static void BM_WhereInThousandsLiteral(benchmark::State& state) {
+    whereInLargeList(state, std::nullopt);
+}
+BENCHMARK(BM_WhereInThousandsLiteral);
+
+static void BM_WhereInThousandsInline(benchmark::State& state) {
+    whereInLargeList(state, sql::InStrategy::Inline);
+}
+BENCHMARK(BM_WhereInThousandsInline);
+
+static void BM_WhereInThousandsBind(benchmark::State& state) {
+    whereInLargeList(state, sql::InStrategy::Bind);
+}
+BENCHMARK(BM_WhereInThousandsBind);
+
+static void BM_WhereInThousandsJsonEach(benchmark::State& state) {
+    whereInLargeList(state, sql::InStrategy::JsonEach);
+}
+BENCHMARK(BM_WhereInThousandsJsonEach);
+
+// Output sizing: heuristic reservation (build) vs. an exact measure() pass
+// followed by a single allocation. Builders are prepared outside the loop
+// so only the rendering is timed.
+static sql::QueryBuilder<> makeComplexJoinQuery() {
+    static const std::string joinCond = getJoinCond();
+    static const std::string orderJoinCond = getOrderJoinCond();
+    static const std::string productJoinCond = getProductJoinCond();
+
+    sql::QueryBuilder<> query;
+    query.select(
+            users.id, users.username,
+            orders.order_number, orders.total_amount,
+            products.name, products.price,
+            order_items.quantity
+            )
+        .from(users.table)
+        .innerJoin(orders.table, joinCond)
+        .innerJoin(order_items.table, orderJoinCond)
+        .innerJoin(products.table, productJoinCond)
+        .where((users.active == true) &&
+               (orders.status == OrderStatus::Delivered) &&
+               (products.active == true))
+        .orderBy(orders.created_at, false);
+    return query;
+}
+
+static sql::QueryBuilder<LargeConfig> makeLargeInQuery() {
+    std::array<int64_t, 40> ids{};
+    for (size_t i = 0; i < ids.size(); ++i) {
+        ids[i] = 1000000 + static_cast<int64_t>(i);
+    }
+
+    sql::QueryBuilder<LargeConfig> query;
+    query.select(users.id, users.username)
+        .from(users.table)
+        .whereIn(users.id, std::span<const int64_t>(ids));
+    return query;
+}
+
+template<typename Builder>
+static void renderHeuristic(benchmark::State& state, const Builder& query) {
+    for (auto _ : state) {
+        auto sql = query.build();
+        benchmark::DoNotOptimize(sql);
+    }
+}
+
+template<typename Builder>
+static void renderExact(benchmark::State& state, const Builder& query) {
+    for (auto _ : state) {
+        std::string sql;
+        sql.reserve(query.measure().value());
+        query.buildInto(sql);
+        benchmark::DoNotOptimize(sql);
+    }
+}
+
+static void BM_ComplexJoinSizeHeuristic(benchmark::State& state) {
+    renderHeuristic(state, makeComplexJoinQuery());
+}
+BENCHMARK(BM_ComplexJoinSizeHeuristic);
+
+static void BM_ComplexJoinSizeExact(benchmark::State& state) {
+    renderExact(state, makeComplexJoinQuery());
+}
+BENCHMARK(BM_ComplexJoinSizeExact);
+
+static void BM_WhereInLargeSizeHeuristic(benchmark::State& state) {
+    renderHeuristic(state, makeLargeInQuery());
+}
+BENCHMARK(BM_WhereInLargeSizeHeuristic);
+
+static void BM_WhereInLargeSizeExact(benchmark::State& state) {
+    renderExact(state, makeLargeInQuery());
+}
+BENCHMARK(BM_WhereInLargeSizeExact);
+
+static void BM_Measure(benchmark::State& state) {
+    const auto query = makeComplexJoinQuery();
+    for (auto _ : state) {
+        auto size = query.measure();
+        benchmark::DoNotOptimize(size);
+    }
+}
+BENCHMARK(BM_Measure);
+
 static void BM_WhereLike(benchmark::State& state) {
     for (auto _ : state) {
         auto query = sql::QueryBuilder<>()
@@ -655,6 +1072,39 @@ static void BM_ComplexOperators(benchmark::State& state) {
 }
 BENCHMARK(BM_ComplexOperators);
 
+// Search-style filter trees with many predicates combined via WhereBuilder
+static void BM_WhereBuilderChain(benchmark::State& state) {
+    for (auto _ : state) {
+        auto query = sql::QueryBuilder<>()
+        .select(users.id, users.username)
+            .from(users.table)
+            .where([](sql::WhereBuilder<sql::DefaultConfig>& w) {
+                w.condition(users.active == true)
+                    .and_(users.verified == true)
+                    .and_(users.country == "USA")
+                    .and_(users.state == "NY")
+                    .and_(users.city == "New York")
+                    .and_(users.zip_code.isNotNull())
+                    .and_(users.created_at >= "2023-01-01")
+                    .and_(users.created_at <= "2023-12-31")
+                    .or_([](auto& inner) {
+                        inner.condition(users.status == UserStatus::Pending)
+                            .and_(users.email.like("%@example.com"))
+                            .and_(users.phone.isNotNull())
+                            .and_(users.first_name == "John")
+                            .and_(users.last_name == "Doe")
+                            .and_(users.address.isNotNull())
+                            .and_(users.updated_at >= "2023-06-01")
+                            .and_(users.verified == false);
+                    });
+            })
+            .build();
+
+        benchmark::DoNotOptimize(query);
+    }
+}
+BENCHMARK(BM_WhereBuilderChain);
+
 // Multiple joins with different join types
 static void BM_MultipleJoinTypes(benchmark::State& state) {
     std::string productsJoin = (categories.id == products.category_id).toString();
@@ -703,6 +1153,129 @@ static void BM_LoginQuery(benchmark::State& state) {
 }
 BENCHMARK(BM_LoginQuery);
 
+// Cost of a Config::Observer on the same query. Arg 0 uses the default
+// NullObserver, whose hooks compile out; Arg 1 aggregates every build into
+// BuildMetrics' per-thread counters and histograms
+struct ObservedConfig : sql::DefaultConfig {
+    using Observer = sql::BuildMetrics<ObservedConfig>;
+};
+
+template<typename Config>
+static void buildLoginQueryFor(const std::string& email, const std::string& password) {
+    auto query = sql::QueryBuilder<Config>()
+        .select("id", "username", "email")
+            .from("users")
+            .where(sql::col<Config>("email") == email)
+            .where(sql::col<Config>("password") == password)
+            .where(sql::col<Config>("active") == true)
+            .limit(1)
+            .build();
+    benchmark::DoNotOptimize(query);
+}
+
+static void BM_LoginQueryObserver(benchmark::State& state) {
+    std::string email = "user@example.com";
+    std::string password = "hashedpassword123";
+
+    for (auto _ : state) {
+        if (state.range(0) == 0) {
+            buildLoginQueryFor<sql::DefaultConfig>(email, password);
+        } else {
+            buildLoginQueryFor<ObservedConfig>(email, password);
+        }
+    }
+}
+BENCHMARK(BM_LoginQueryObserver)->Arg(0)->Arg(1);
+
+// Same query rendered into caller-owned output instead of a fresh string
+template<typename Sink>
+static void buildLoginQueryInto(Sink& sink, const std::string& email, const std::string& password) {
+    auto result = sql::QueryBuilder<>()
+        .select(users.id, users.username, users.email)
+            .from(users.table)
+            .where(users.email == email)
+            .where(users.password == password)
+            .where(users.active == true)
+            .limit(1)
+            .buildInto(sink);
+    benchmark::DoNotOptimize(result);
+}
+
+static void BM_LoginQueryIntoReusedString(benchmark::State& state) {
+    std::string email = "user@example.com";
+    std::string password = "hashedpassword123";
+    std::string query;
+
+    for (auto _ : state) {
+        query.clear();
+        buildLoginQueryInto(query, email, password);
+        benchmark::DoNotOptimize(query.data());
+    }
+}
+BENCHMARK(BM_LoginQueryIntoReusedString);
+
+static void BM_LoginQueryIntoArena(benchmark::State& state) {
+    std::string email = "user@example.com";
+    std::string password = "hashedpassword123";
+    std::array<std::byte, 4096> buffer;
+
+    for (auto _ : state) {
+        // Per-request arena, released wholesale at the end of the request
+        std::pmr::monotonic_buffer_resource arena(buffer.data(), buffer.size());
+        std::pmr::string query(&arena);
+        buildLoginQueryInto(query, email, password);
+        benchmark::DoNotOptimize(query.data());
+    }
+}
+BENCHMARK(BM_LoginQueryIntoArena);
+
+static void BM_LoginQueryIntoFixedBuffer(benchmark::State& state) {
+    std::string email = "user@example.com";
+    std::string password = "hashedpassword123";
+    sql::FixedBuffer<512> query;
+
+    for (auto _ : state) {
+        query.clear();
+        buildLoginQueryInto(query, email, password);
+        benchmark::DoNotOptimize(query.c_str());
+    }
+}
+BENCHMARK(BM_LoginQueryIntoFixedBuffer);
+
+// Same query with its shape fixed at compile time; values are bound later
+static void BM_LoginQueryStatic(benchmark::State& state) {
+    static constexpr auto query = sql::StaticQuery<>()
+        .select(users.id, users.username, users.email)
+            .from(users.table)
+            .where(users.email == sql::param())
+            .where(users.password == sql::param())
+            .where(users.active == sql::lit(true))
+            .limit(1)
+            .build();
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(query.view());
+    }
+}
+BENCHMARK(BM_LoginQueryStatic);
+
+// Runtime builder producing the same placeholder SQL, for comparison
+static void BM_LoginQueryRuntimePlaceholders(benchmark::State& state) {
+    for (auto _ : state) {
+        auto query = sql::QueryBuilder<>()
+        .select(users.id, users.username, users.email)
+            .from(users.table)
+            .where(users.email == sql::SqlValue<>(sql::Placeholder<>()))
+            .where(users.password == sql::SqlValue<>(sql::Placeholder<>()))
+            .where(users.active == true)
+            .limit(1)
+            .build();
+
+        benchmark::DoNotOptimize(query);
+    }
+}
+BENCHMARK(BM_LoginQueryRuntimePlaceholders);
+
 static void BM_ProductListingQuery(benchmark::State& state) {
     for (auto _ : state) {
         auto query = sql::QueryBuilder<>()
@@ -727,6 +1300,196 @@ static void BM_ProductListingQuery(benchmark::State& state) {
 }
 BENCHMARK(BM_ProductListingQuery);
 
+// Compiled statements: build once, only bind values per request
+static void BM_LoginQueryCompiled(benchmark::State& state) {
+    const auto compiled = sql::QueryBuilder<>()
+        .select(users.id, users.username, users.email)
+            .from(users.table)
+            .where(users.email == sql::ph(":email"))
+            .where(users.password == sql::ph(":password"))
+            .where(users.active == true)
+            .limit(1)
+            .compile();
+
+    std::string email = "user@example.com";
+    std::string password = "hashedpassword123";
+
+    for (auto _ : state) {
+        std::array<sql::SqlValue<>, 2> values{sql::SqlValue<>(email), sql::SqlValue<>(password)};
+        auto query = compiled.render(values);
+
+        benchmark::DoNotOptimize(query);
+    }
+}
+BENCHMARK(BM_LoginQueryCompiled);
+
+static void BM_ProductListingQueryCompiled(benchmark::State& state) {
+    const auto compiled = sql::QueryBuilder<>()
+        .select(
+            products.id,
+            products.name,
+            products.price,
+            products.description,
+            categories.name
+            )
+            .from(products.table)
+            .leftJoin(categories.table, (categories.id == products.category_id).toString())
+            .where(products.active == sql::ph())
+            .where(products.stock_quantity > sql::ph())
+            .orderBy(products.price)
+            .limit(20)
+            .offset(0)
+            .compile();
+
+    for (auto _ : state) {
+        std::array<sql::SqlValue<>, 2> values{sql::SqlValue<>(true), sql::SqlValue<>(0)};
+        auto query = compiled.render(values);
+
+        benchmark::DoNotOptimize(query);
+    }
+}
+BENCHMARK(BM_ProductListingQueryCompiled);
+
+static void BM_ProductListingQueryCached(benchmark::State& state) {
+    sql::QueryCache<> cache;
+
+    for (auto _ : state) {
+        sql::QueryBuilder<> query;
+        query.select(
+                 products.id,
+                 products.name,
+                 products.price,
+                 products.description,
+                 categories.name
+                 )
+            .from(products.table)
+            .leftJoin(categories.table, "categories.id = products.category_id")
+            .where(products.active == true)
+            .where(products.stock_quantity > 0)
+            .orderBy(products.price)
+            .limit(20)
+            .offset(0);
+
+        auto sql = cache.render(query);
+        benchmark::DoNotOptimize(sql);
+    }
+}
+BENCHMARK(BM_ProductListingQueryCached);
+
+static void BM_QueryCacheContended(benchmark::State& state) {
+    static sql::QueryCache<> cache;
+
+    for (auto _ : state) {
+        sql::QueryBuilder<> query;
+        query.select(users.id, users.username)
+            .from(users.table)
+            .where(users.email == sql::ph(":email"))
+            .limit(1 + state.thread_index() % 4);
+
+        auto compiled = cache.get(query);
+        benchmark::DoNotOptimize(compiled);
+    }
+}
+BENCHMARK(BM_QueryCacheContended)->Threads(1)->Threads(4)->Threads(8);
+
+// Statement map lookups, as in a driver cache or logger, for a ~2 KB
+// statement: keyed by its text, which hashes and compares every byte, and
+// by its interned handle
+static std::string wideStatement() {
+    std::vector<int64_t> ids(300);
+    for (size_t i = 0; i < ids.size(); ++i) ids[i] = static_cast<int64_t>(1000 + i);
+    sql::QueryBuilder<> query;
+    query.select(users.id, users.username)
+        .from(users.table)
+        .whereIn(users.id, std::span<const int64_t>(ids));
+    return query.build();
+}
+
+static void BM_StatementLookupByText(benchmark::State& state) {
+    const std::string text = wideStatement();
+    std::unordered_map<std::string, int> statements{{text, 1}};
+    for (int i = 0; i < 63; ++i) statements.emplace(std::to_string(i) + text, i);
+    const std::string probe = text;  // A separately built copy of the same SQL
+
+    for (auto _ : state) {
+        auto it = statements.find(probe);
+        benchmark::DoNotOptimize(it);
+    }
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_StatementLookupByText);
+
+static void BM_StatementLookupInterned(benchmark::State& state) {
+    const std::string text = wideStatement();
+    std::unordered_map<sql::InternedSql, int> statements{{sql::SqlPool::global().intern(text), 1}};
+    for (int i = 0; i < 63; ++i) statements.emplace(sql::SqlPool::global().intern(std::to_string(i) + text), i);
+    const sql::InternedSql probe = sql::SqlPool::global().intern(text);
+
+    for (auto _ : state) {
+        auto it = statements.find(probe);
+        benchmark::DoNotOptimize(it);
+    }
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_StatementLookupInterned);
+
+static void BM_InternHit(benchmark::State& state) {
+    const std::string text = wideStatement();
+    (void)sql::SqlPool::global().intern(text);
+
+    for (auto _ : state) {
+        auto handle = sql::SqlPool::global().intern(text);
+        benchmark::DoNotOptimize(handle);
+    }
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_InternHit);
+
+// ETL-style statement generation: one UPDATE per record, built on the workers
+static sql::QueryBuilder<> makeRecordUpdate(size_t index) {
+    sql::QueryBuilder<> query;
+    query.update(users.table)
+        .set(users.status, static_cast<int64_t>(index % 3))
+        .set(users.verified, true)
+        .where(users.id == static_cast<int64_t>(index));
+    return query;
+}
+
+static void BM_BuildRecordUpdatesSerial(benchmark::State& state) {
+    const size_t records = static_cast<size_t>(state.range(0));
+    std::string out;
+
+    for (auto _ : state) {
+        out.clear();
+        for (size_t i = 0; i < records; ++i) {
+            if (i > 0) out += ";\n";
+            auto result = makeRecordUpdate(i).buildInto(out);
+            benchmark::DoNotOptimize(result);
+        }
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * records);
+}
+BENCHMARK(BM_BuildRecordUpdatesSerial)->Arg(100000)->Unit(benchmark::kMillisecond);
+
+static void BM_BuildBatch(benchmark::State& state) {
+    const size_t records = static_cast<size_t>(state.range(0));
+    sql::BatchBuildOptions options;
+    options.threads = static_cast<size_t>(state.range(1));
+    std::string out;
+
+    for (auto _ : state) {
+        out.clear();
+        auto result = sql::buildBatch(records, makeRecordUpdate, out, options);
+        benchmark::DoNotOptimize(result);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * records);
+}
+BENCHMARK(BM_BuildBatch)
+    ->Args({100000, 1})->Args({100000, 2})->Args({100000, 4})->Args({100000, 8})
+    ->Unit(benchmark::kMillisecond)->UseRealTime();
+
 static void BM_OrderHistoryQuery(benchmark::State& state) {
     int64_t userId = 42;
 
@@ -762,6 +1525,7 @@ static void BM_TinyConfigMemoryFootprint(benchmark::State& state) {
         sql::QueryBuilder<TinyConfig> builder;
         benchmark::DoNotOptimize(builder);
     }
+    state.counters["bytes"] = static_cast<double>(sizeof(sql::QueryBuilder<TinyConfig>));
 }
 BENCHMARK(BM_TinyConfigMemoryFootprint);
 
@@ -770,6 +1534,7 @@ static void BM_SmallConfigMemoryFootprint(benchmark::State& state) {
         sql::QueryBuilder<SmallConfig> builder;
         benchmark::DoNotOptimize(builder);
     }
+    state.counters["bytes"] = static_cast<double>(sizeof(sql::QueryBuilder<SmallConfig>));
 }
 BENCHMARK(BM_SmallConfigMemoryFootprint);
 
@@ -778,6 +1543,7 @@ static void BM_DefaultConfigMemoryFootprint(benchmark::State& state) {
         sql::QueryBuilder<> builder;
         benchmark::DoNotOptimize(builder);
     }
+    state.counters["bytes"] = static_cast<double>(sizeof(sql::QueryBuilder<>));
 }
 BENCHMARK(BM_DefaultConfigMemoryFootprint);
 
@@ -786,7 +1552,17 @@ static void BM_LargeConfigMemoryFootprint(benchmark::State& state) {
         sql::QueryBuilder<LargeConfig> builder;
         benchmark::DoNotOptimize(builder);
     }
+    state.counters["bytes"] = static_cast<double>(sizeof(sql::QueryBuilder<LargeConfig>));
 }
 BENCHMARK(BM_LargeConfigMemoryFootprint);
 
+static void BM_CompactConfigMemoryFootprint(benchmark::State& state) {
+    for (auto _ : state) {
+        sql::QueryBuilder<sql::CompactConfig> builder;
+        benchmark::DoNotOptimize(builder);
+    }
+    state.counters["bytes"] = static_cast<double>(sizeof(sql::QueryBuilder<sql::CompactConfig>));
+}
+BENCHMARK(BM_CompactConfigMemoryFootprint);
+
 BENCHMARK_MAIN();